@@ -1,10 +0,0 @@
-#pragma once
-
-#include <functional>
-
-namespace babbysitter
-{
-  int update(float dt);
-
-  int sit(std::function<float(float, float)> baby_step);
-}
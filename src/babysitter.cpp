@@ -0,0 +1,86 @@
+//! --------------------------------------------------------------------------
+//! -------------------------- INCLUDES
+//! --------------------------------------------------------------------------
+
+#include "babysitter.h"
+
+#include "debug/stats.h"
+
+using namespace std;
+
+//! --------------------------------------------------------------------------
+//! -------------------------- WORKSPACE
+//! --------------------------------------------------------------------------
+
+namespace
+{
+  struct baby_t
+  {
+    babysitter::step_t step;
+    float progress;
+  };
+
+  static SlotMap<baby_t> babies;
+}
+
+//! --------------------------------------------------------------------------
+//! -------------------------- INTERFACE
+//! --------------------------------------------------------------------------
+
+namespace babysitter
+{
+  handle_t sit(step_t step)
+  {
+    baby_t baby = { step, 0.0f };
+    return babies.insert(baby);
+  }
+
+  bool abandon(handle_t baby)
+  {
+    return babies.erase(baby);
+  }
+
+  bool isSitting(handle_t baby)
+  {
+    return babies.contains(baby);
+  }
+
+  float progress(handle_t baby)
+  {
+    const baby_t* b = babies.get(baby);
+    return b ? b->progress : 1.0f;
+  }
+
+  int update(float dt)
+  {
+    // Backwards, so that letting a baby go (which moves the last one into
+    // its place) doesn't skip anyone. Babies sat during the update are
+    // added at the end: they start next time.
+    for(size_t i = babies.size(); i-- > 0; )
+    {
+      // A step may sit another baby, and the babies move when there's no
+      // more room for it: hold on to nothing from the slot map across the
+      // call, and find this one again through its handle afterwards
+      handle_t handle = babies.getHandle(i);
+      step_t step = move(babies[i].step);
+      float progress = step(babies[i].progress, dt);
+
+      baby_t* b = babies.get(handle);
+      if(!b)
+        continue;
+      b->progress = progress;
+      if(progress >= 1.0f)
+        babies.erase(handle);
+      else
+        b->step = move(step);
+    }
+
+    stats::set("babysitter.babies", babies.size());
+    return babies.size();
+  }
+
+  void clear()
+  {
+    babies.clear();
+  }
+}
@@ -2,9 +2,31 @@
 
 #include <functional>
 
-namespace babbysitter
+#include "memory/SlotMap.hpp"
+
+// Looks after small things that need stepping every frame until they're done
+// (tweens, fades, timers). Each baby is a function that takes its progress
+// and the time elapsed and returns its new progress; it's let go once that
+// reaches 1. Babies are kept in a slot map, so the handle sit() returns can
+// still be asked about (or used to abandon the baby) after it has gone.
+
+namespace babysitter
 {
+  typedef std::function<float(float progress, float dt)> step_t;
+
+  // start stepping 'step' from a progress of 0
+  handle_t sit(step_t step);
+
+  // stop early: false if the baby had already gone (don't call from a step)
+  bool abandon(handle_t baby);
+
+  // is it still being stepped? and how far along is it (1 once gone)?
+  bool isSitting(handle_t baby);
+  float progress(handle_t baby);
+
+  // step every baby, returning how many are left
   int update(float dt);
 
-  int sit(std::function<float(float, float)> step);
+  // let everyone go
+  void clear();
 }
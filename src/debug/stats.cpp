@@ -0,0 +1,138 @@
+#include "stats.h"
+
+#include <map>
+#include <deque>
+#include <string>
+#include <mutex>
+#include <cstring>
+
+#include "log.h"
+
+using namespace std;
+
+namespace stats
+{
+  namespace
+  {
+    enum kind_t { COUNTER, GAUGE, TIMER };
+
+    struct entry_t
+    {
+      kind_t kind;
+      double current;   // accumulating this frame
+      double last;      // value of the last complete frame
+      double total;     // summed over the reporting period
+      double peak;      // worst frame of the reporting period
+    };
+
+    struct name_less_t
+    {
+      bool operator()(const char* a, const char* b) const
+      {
+        return strcmp(a, b) < 0;
+      }
+    };
+
+    // ordered so that reports come out alphabetically; looked up by the
+    // caller's string so that nothing is allocated once an entry exists
+    static map<const char*, entry_t, name_less_t> entries;
+    static deque<string> names;         // the keys (deques don't move them)
+    static mutex entries_mutex;
+    static unsigned int frames = 0;
+
+    entry_t& find(const char* name, kind_t kind)
+    {
+      auto i = entries.find(name);
+      if(i == entries.end())
+      {
+        // The caller's string may not last: keep a copy
+        names.push_back(name);
+        i = entries.insert(make_pair(names.back().c_str(),
+                                     entry_t { kind, 0, 0, 0, 0 })).first;
+      }
+      return i->second;
+    }
+  }
+
+  void count(const char* name, double amount)
+  {
+    lock_guard<mutex> lock(entries_mutex);
+    find(name, COUNTER).current += amount;
+  }
+
+  void set(const char* name, double value)
+  {
+    lock_guard<mutex> lock(entries_mutex);
+    entry_t& e = find(name, GAUGE);
+    e.current = e.last = value;
+  }
+
+  void time(const char* name, double ms)
+  {
+    lock_guard<mutex> lock(entries_mutex);
+    find(name, TIMER).current += ms;
+  }
+
+  double get(const char* name)
+  {
+    lock_guard<mutex> lock(entries_mutex);
+    auto i = entries.find(name);
+    return (i == entries.end()) ? 0.0 : i->second.last;
+  }
+
+  double now()
+  {
+    static const double frequency = (double)SDL_GetPerformanceFrequency();
+    return SDL_GetPerformanceCounter() * 1000.0 / frequency;
+  }
+
+  void frame()
+  {
+    {
+      lock_guard<mutex> lock(entries_mutex);
+      for(auto i = entries.begin(); i != entries.end(); i++)
+      {
+        entry_t& e = i->second;
+        if(e.kind == GAUGE)
+          continue;
+        e.last = e.current;
+        e.total += e.current;
+        if(e.current > e.peak)
+          e.peak = e.current;
+        e.current = 0;
+      }
+      frames++;
+    }
+
+    if(frames >= STATS_PERIOD)
+      report();
+  }
+
+  void report()
+  {
+    lock_guard<mutex> lock(entries_mutex);
+
+    double n = (frames > 0) ? frames : 1;
+    log("Stats over %u frames", frames);
+    for(auto i = entries.begin(); i != entries.end(); i++)
+    {
+      entry_t& e = i->second;
+      switch(e.kind)
+      {
+        case COUNTER:
+          log("  %-32s avg %12.2f  max %12.2f", i->first,
+              e.total/n, e.peak);
+        break;
+        case TIMER:
+          log("  %-32s avg %9.3f ms  max %9.3f ms", i->first,
+              e.total/n, e.peak);
+        break;
+        case GAUGE:
+          log("  %-32s %12.2f", i->first, e.last);
+        break;
+      }
+      e.total = e.peak = 0;
+    }
+    frames = 0;
+  }
+}
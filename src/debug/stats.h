@@ -0,0 +1,49 @@
+#pragma once
+
+#include "SDL.h"    // needed for SDL_GetPerformanceCounter
+
+// Per-frame statistics: counters are summed over a frame, gauges keep their
+// last value and timers accumulate milliseconds. A summary is written to the
+// log every STATS_PERIOD frames (DEBUG builds only, like the log itself).
+
+#define STATS_PERIOD 300
+
+namespace stats
+{
+  // add to a counter for the current frame
+  void count(const char* name, double amount = 1.0);
+
+  // overwrite a gauge
+  void set(const char* name, double value);
+
+  // add a duration in milliseconds to a timer
+  void time(const char* name, double ms);
+
+  // read back the last complete frame (or the gauge value)
+  double get(const char* name);
+
+  // high-resolution clock in milliseconds
+  double now();
+
+  // close the current frame
+  void frame();
+
+  // write everything to the log immediately
+  void report();
+
+  // time the enclosing scope
+  class Timer
+  {
+  private:
+    const char* name;
+    double start;
+  public:
+    Timer(const char* _name) : name(_name), start(now()) {}
+    ~Timer() { time(name, now() - start); }
+  };
+}
+
+#define STATS_CONCAT_AUX(a, b) a##b
+#define STATS_CONCAT(a, b) STATS_CONCAT_AUX(a, b)
+#define STATS_TIME(name) \
+  stats::Timer STATS_CONCAT(stats_timer_, __LINE__)(name)
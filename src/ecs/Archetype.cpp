@@ -0,0 +1,190 @@
+//! --------------------------------------------------------------------------
+//! -------------------------- INCLUDES
+//! --------------------------------------------------------------------------
+
+#include "Archetype.hpp"
+
+#include <cstdlib>
+#include <cstring>
+
+using namespace std;
+
+//! --------------------------------------------------------------------------
+//! -------------------------- CONSTANTS
+//! --------------------------------------------------------------------------
+
+#define ALIGN_UP(x) (((x) + ECS_MAX_ALIGN - 1) & ~((size_t)ECS_MAX_ALIGN - 1))
+
+//! --------------------------------------------------------------------------
+//! -------------------------- CONSTRUCTORS, DESTRUCTOR
+//! --------------------------------------------------------------------------
+
+Archetype::Archetype(component_mask_t _mask) :
+mask(_mask),
+columns(),
+chunk_bytes(ECS_CHUNK_SIZE),
+capacity(0),
+chunks(),
+count(0)
+{
+  size_t row_bytes = sizeof(entity_t);
+  for(uint32_t c = 0; c < ECS_MAX_COMPONENTS; c++)
+  {
+    offsets[c] = 0;
+    with[c] = without[c] = nullptr;
+    if(mask & (((component_mask_t)1) << c))
+    {
+      columns.push_back(c);
+      row_bytes += components::size(c);
+    }
+  }
+
+  // As many rows as fit, allowing for each column's alignment padding; at
+  // least one, even if it takes a bigger chunk
+  size_t padding = (columns.size() + 1)*ECS_MAX_ALIGN;
+  capacity = (chunk_bytes > padding) ? (chunk_bytes - padding)/row_bytes : 0;
+  if(!capacity)
+  {
+    capacity = 1;
+    chunk_bytes = padding + row_bytes;
+  }
+
+  // Entity handles first, then one array per component
+  size_t offset = ALIGN_UP(capacity*sizeof(entity_t));
+  for(size_t i = 0; i < columns.size(); i++)
+  {
+    offsets[columns[i]] = offset;
+    offset = ALIGN_UP(offset + capacity*components::size(columns[i]));
+  }
+}
+
+Archetype::~Archetype()
+{
+  for(size_t i = 0; i < chunks.size(); i++)
+    delete[] chunks[i].memory;
+}
+
+//! --------------------------------------------------------------------------
+//! -------------------------- ROWS
+//! --------------------------------------------------------------------------
+
+void Archetype::push(entity_t entity, uint32_t& chunk, uint32_t& row)
+{
+  if(chunks.empty() || chunks.back().size == capacity)
+  {
+    chunk_t c;
+    // NB - new rather than malloc so that heap tracking sees chunks
+    c.memory = new unsigned char[chunk_bytes + ECS_MAX_ALIGN];
+    c.data = (unsigned char*)ALIGN_UP((size_t)c.memory);
+    c.size = 0;
+    chunks.push_back(c);
+  }
+
+  chunk = chunks.size() - 1;
+  row = chunks.back().size++;
+  entities(chunk)[row] = entity;
+  count++;
+}
+
+entity_t Archetype::erase(uint32_t chunk, uint32_t row)
+{
+  uint32_t last_chunk = chunks.size() - 1,
+           last_row = chunks[last_chunk].size - 1;
+  entity_t moved = ECS_NO_ENTITY;
+
+  if(chunk != last_chunk || row != last_row)
+  {
+    unsigned char *to = chunks[chunk].data,
+                  *from = chunks[last_chunk].data;
+    for(size_t i = 0; i < columns.size(); i++)
+    {
+      size_t size = components::size(columns[i]),
+             offset = offsets[columns[i]];
+      memcpy(to + offset + row*size, from + offset + last_row*size, size);
+    }
+    moved = entities(last_chunk)[last_row];
+    entities(chunk)[row] = moved;
+  }
+
+  // Give back empty chunks straight away
+  if(!(--chunks[last_chunk].size))
+  {
+    delete[] chunks[last_chunk].memory;
+    chunks.pop_back();
+  }
+  count--;
+  return moved;
+}
+
+void Archetype::copy(uint32_t chunk, uint32_t row,
+                     Archetype& to, uint32_t to_chunk, uint32_t to_row) const
+{
+  unsigned char *from_data = chunks[chunk].data,
+                *to_data = to.chunks[to_chunk].data;
+  for(size_t i = 0; i < columns.size(); i++)
+  {
+    uint32_t c = columns[i];
+    if(!to.has(c))
+      continue;
+    size_t size = components::size(c);
+    memcpy(to_data + to.offsets[c] + to_row*size,
+           from_data + offsets[c] + row*size, size);
+  }
+}
+
+void* Archetype::get(uint32_t component, uint32_t chunk, uint32_t row)
+{
+  if(!has(component))
+    return nullptr;
+  return chunks[chunk].data + offsets[component]
+         + row*components::size(component);
+}
+
+entity_t* Archetype::entities(uint32_t chunk)
+{
+  return (entity_t*)chunks[chunk].data;
+}
+
+//! --------------------------------------------------------------------------
+//! -------------------------- ACCESSORS
+//! --------------------------------------------------------------------------
+
+Archetype*& Archetype::getWith(uint32_t component)
+{
+  return with[component];
+}
+
+Archetype*& Archetype::getWithout(uint32_t component)
+{
+  return without[component];
+}
+
+component_mask_t Archetype::getMask() const
+{
+  return mask;
+}
+
+bool Archetype::has(uint32_t component) const
+{
+  return (mask >> component) & 1;
+}
+
+uint32_t Archetype::getChunkCount() const
+{
+  return chunks.size();
+}
+
+uint32_t Archetype::getChunkSize(uint32_t chunk) const
+{
+  return chunks[chunk].size;
+}
+
+uint32_t Archetype::getCapacity() const
+{
+  return capacity;
+}
+
+size_t Archetype::size() const
+{
+  return count;
+}
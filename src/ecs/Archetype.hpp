@@ -0,0 +1,79 @@
+#ifndef ARCHETYPE_HPP_INCLUDED
+#define ARCHETYPE_HPP_INCLUDED
+
+#include <vector>
+
+#include "components.h"
+
+// Storage for every entity with exactly the same set of components. Rows
+// are kept in fixed-size chunks, each holding one array per component type
+// (structure of arrays) plus the array of entity handles, so that a system
+// walking a chunk reads each array front to back. Every chunk but the last
+// is always full: removing a row moves the very last one into the hole.
+
+#define ECS_CHUNK_SIZE (16*1024)
+
+class Archetype
+{
+  /// NESTING
+private:
+  struct chunk_t
+  {
+    unsigned char* memory;    // as allocated
+    unsigned char* data;      // aligned to ECS_MAX_ALIGN
+    uint32_t size;
+  };
+
+  /// ATTRIBUTES
+private:
+  component_mask_t mask;
+  std::vector<uint32_t> columns;          // component ids, in order
+  size_t offsets[ECS_MAX_COMPONENTS];     // of each column in a chunk
+  size_t chunk_bytes;
+  uint32_t capacity;                      // rows per chunk
+  std::vector<chunk_t> chunks;
+  size_t count;
+  // where entities go when a component is added or removed (cached)
+  Archetype* with[ECS_MAX_COMPONENTS];
+  Archetype* without[ECS_MAX_COMPONENTS];
+
+  /// METHODS
+public:
+  // constructors, destructors
+  Archetype(component_mask_t mask);
+  ~Archetype();
+  // add a row at the end, uninitialised but for the entity
+  void push(entity_t entity, uint32_t& chunk, uint32_t& row);
+  // fill the hole with the last row and return the entity that was moved
+  // there (ECS_NO_ENTITY if it was the last row already)
+  entity_t erase(uint32_t chunk, uint32_t row);
+  // copy the components both archetypes have from a row here to one there
+  void copy(uint32_t chunk, uint32_t row,
+            Archetype& to, uint32_t to_chunk, uint32_t to_row) const;
+  // one component of one row, null if there's no such column
+  void* get(uint32_t component, uint32_t chunk, uint32_t row);
+  // a column of a chunk
+  template <typename T>
+  T* column(uint32_t chunk)
+  {
+    return (T*)(chunks[chunk].data + offsets[components::id<T>()]);
+  }
+  entity_t* entities(uint32_t chunk);
+  // graph cache
+  Archetype*& getWith(uint32_t component);
+  Archetype*& getWithout(uint32_t component);
+  // accessors
+  component_mask_t getMask() const;
+  bool has(uint32_t component) const;
+  uint32_t getChunkCount() const;
+  uint32_t getChunkSize(uint32_t chunk) const;
+  uint32_t getCapacity() const;
+  size_t size() const;
+
+private:
+  // archetypes are shared through pointers: never copied
+  Archetype(const Archetype&);
+  Archetype& operator=(const Archetype&);
+};
+
+#endif // ARCHETYPE_HPP_INCLUDED
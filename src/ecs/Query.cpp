@@ -0,0 +1,55 @@
+//! --------------------------------------------------------------------------
+//! -------------------------- INCLUDES
+//! --------------------------------------------------------------------------
+
+#include "Query.hpp"
+
+using namespace std;
+
+//! --------------------------------------------------------------------------
+//! -------------------------- CONSTRUCTORS, DESTRUCTOR
+//! --------------------------------------------------------------------------
+
+Query::Query(World& _world, component_mask_t _all, component_mask_t _none) :
+world(&_world),
+all(_all),
+none(_none),
+matches(),
+checked(0)
+{
+}
+
+//! --------------------------------------------------------------------------
+//! -------------------------- MATCHING
+//! --------------------------------------------------------------------------
+
+void Query::update()
+{
+  // Archetypes are never destroyed: only look at the new ones
+  const vector<Archetype*>& archetypes = world->getArchetypes();
+  for(; checked < archetypes.size(); checked++)
+  {
+    component_mask_t mask = archetypes[checked]->getMask();
+    if((mask & all) == all && !(mask & none))
+      matches.push_back(archetypes[checked]);
+  }
+}
+
+//! --------------------------------------------------------------------------
+//! -------------------------- ACCESSORS
+//! --------------------------------------------------------------------------
+
+size_t Query::size()
+{
+  update();
+  size_t total = 0;
+  for(size_t i = 0; i < matches.size(); i++)
+    total += matches[i]->size();
+  return total;
+}
+
+const vector<Archetype*>& Query::getMatches()
+{
+  update();
+  return matches;
+}
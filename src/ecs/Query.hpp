@@ -0,0 +1,44 @@
+#ifndef QUERY_HPP_INCLUDED
+#define QUERY_HPP_INCLUDED
+
+#include <vector>
+
+#include "World.hpp"
+
+// Every entity with a given set of components (and none of another set).
+// The matching archetypes are remembered: only archetypes created since the
+// last use are checked, so a query kept from one frame to the next costs
+// nothing to find its entities and then walks their chunks in order.
+
+class Query
+{
+  /// ATTRIBUTES
+private:
+  World* world;
+  component_mask_t all, none;
+  std::vector<Archetype*> matches;
+  size_t checked;     // how many of the world's archetypes
+
+  /// METHODS
+public:
+  // constructors, destructors
+  Query(World& world, component_mask_t all, component_mask_t none = 0);
+  // call f(T1&, T2&, ...) for each entity, or f(entity, T1&, T2&, ...)
+  template <typename... Ts, typename F>
+  void each(F f);
+  template <typename... Ts, typename F>
+  void eachEntity(F f);
+  // call f(count, T1*, T2*, ...) with the arrays of each chunk
+  template <typename... Ts, typename F>
+  void chunks(F f);
+  // accessors
+  size_t size();
+  const std::vector<Archetype*>& getMatches();
+
+private:
+  void update();
+};
+
+#include "Query.inl"
+
+#endif // QUERY_HPP_INCLUDED
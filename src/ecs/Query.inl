@@ -0,0 +1,64 @@
+// Inline file: a special implementation that is included rather than compiled
+
+//! --------------------------------------------------------------------------
+//! -------------------------- ITERATION
+//! --------------------------------------------------------------------------
+
+// The arrays come in as separate arguments so that they can be expanded
+// next to the index (C++11: no index sequences)
+namespace query_detail
+{
+  template <typename F, typename... Ts>
+  inline void each(F& f, uint32_t count, Ts*... arrays)
+  {
+    for(uint32_t i = 0; i < count; i++)
+      f(arrays[i]...);
+  }
+
+  template <typename F, typename... Ts>
+  inline void eachEntity(F& f, uint32_t count, const entity_t* entities,
+                         Ts*... arrays)
+  {
+    for(uint32_t i = 0; i < count; i++)
+      f(entities[i], arrays[i]...);
+  }
+}
+
+template <typename... Ts, typename F>
+void Query::each(F f)
+{
+  update();
+  for(size_t a = 0; a < matches.size(); a++)
+  {
+    Archetype& archetype = *(matches[a]);
+    for(uint32_t c = 0; c < archetype.getChunkCount(); c++)
+      query_detail::each(f, archetype.getChunkSize(c),
+                         archetype.template column<Ts>(c)...);
+  }
+}
+
+template <typename... Ts, typename F>
+void Query::eachEntity(F f)
+{
+  update();
+  for(size_t a = 0; a < matches.size(); a++)
+  {
+    Archetype& archetype = *(matches[a]);
+    for(uint32_t c = 0; c < archetype.getChunkCount(); c++)
+      query_detail::eachEntity(f, archetype.getChunkSize(c),
+                               archetype.entities(c),
+                               archetype.template column<Ts>(c)...);
+  }
+}
+
+template <typename... Ts, typename F>
+void Query::chunks(F f)
+{
+  update();
+  for(size_t a = 0; a < matches.size(); a++)
+  {
+    Archetype& archetype = *(matches[a]);
+    for(uint32_t c = 0; c < archetype.getChunkCount(); c++)
+      f(archetype.getChunkSize(c), archetype.template column<Ts>(c)...);
+  }
+}
@@ -0,0 +1,103 @@
+//! --------------------------------------------------------------------------
+//! -------------------------- INCLUDES
+//! --------------------------------------------------------------------------
+
+#include "Scheduler.hpp"
+
+#include "../debug/stats.h"
+
+using namespace std;
+
+//! --------------------------------------------------------------------------
+//! -------------------------- CONSTRUCTORS, DESTRUCTOR
+//! --------------------------------------------------------------------------
+
+Scheduler::Scheduler(WorkerPool* _pool) :
+pool(_pool),
+systems(),
+stages(),
+planned(false)
+{
+}
+
+//! --------------------------------------------------------------------------
+//! -------------------------- SYSTEMS
+//! --------------------------------------------------------------------------
+
+void Scheduler::add(const char* name, component_mask_t reads,
+                    component_mask_t writes, function<void(World&)> run)
+{
+  system_t s = { name, reads, writes, run };
+  systems.push_back(s);
+  planned = false;
+}
+
+void Scheduler::plan()
+{
+  stages.clear();
+  for(size_t i = 0; i < systems.size(); i++)
+  {
+    const system_t& s = systems[i];
+
+    // Find the last stage holding something this system conflicts with
+    size_t stage = 0;
+    for(size_t g = stages.size(); g > 0 && !stage; g--)
+    for(size_t j = 0; j < stages[g - 1].size(); j++)
+    {
+      const system_t& other = systems[stages[g - 1][j]];
+      if((s.writes & (other.reads | other.writes))
+      || (other.writes & s.reads))
+      {
+        stage = g;
+        break;
+      }
+    }
+
+    if(stage == stages.size())
+      stages.push_back(vector<size_t>());
+    stages[stage].push_back(i);
+  }
+  planned = true;
+}
+
+void Scheduler::run(World& world)
+{
+  if(!planned)
+    plan();
+
+  for(size_t g = 0; g < stages.size(); g++)
+  {
+    const vector<size_t>& stage = stages[g];
+    for(size_t i = 0; i < stage.size(); i++)
+    {
+      system_t* s = &systems[stage[i]];
+      auto task = [s, &world]()
+      {
+        double start = stats::now();
+        s->run(world);
+        stats::time(s->name.c_str(), stats::now() - start);
+      };
+
+      // The last one (or all, without a pool) runs here
+      if(pool && i + 1 < stage.size())
+        pool->submit(task);
+      else
+        task();
+    }
+    if(pool)
+      pool->wait();
+  }
+
+  world.flush();
+}
+
+//! --------------------------------------------------------------------------
+//! -------------------------- ACCESSORS
+//! --------------------------------------------------------------------------
+
+size_t Scheduler::getStageCount()
+{
+  if(!planned)
+    plan();
+  return stages.size();
+}
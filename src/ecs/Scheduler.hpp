@@ -0,0 +1,53 @@
+#ifndef SCHEDULER_HPP_INCLUDED
+#define SCHEDULER_HPP_INCLUDED
+
+#include <string>
+#include <vector>
+#include <functional>
+
+#include "World.hpp"
+#include "../threads/WorkerPool.hpp"
+
+// Runs systems over a World, several at a time when it's safe. Each system
+// declares which components it reads and which it writes; systems are cut
+// into stages, in the order they were added, so that nothing in a stage
+// writes what another system of the same stage reads or writes. A system
+// goes in the stage after the last one it conflicts with, which keeps the
+// order of any two systems that touch the same data. Stages then run one
+// after the other, each spread over the worker pool.
+
+class Scheduler
+{
+  /// NESTING
+private:
+  struct system_t
+  {
+    std::string name;
+    component_mask_t reads, writes;
+    std::function<void(World&)> run;
+  };
+
+  /// ATTRIBUTES
+private:
+  WorkerPool* pool;
+  std::vector<system_t> systems;
+  std::vector<std::vector<size_t>> stages;
+  bool planned;
+
+  /// METHODS
+public:
+  // constructors, destructors: without a pool everything runs in order
+  Scheduler(WorkerPool* pool = nullptr);
+  // systems (see components::mask)
+  void add(const char* name, component_mask_t reads, component_mask_t writes,
+           std::function<void(World&)> run);
+  // run every system once, then carry out the changes they deferred
+  void run(World& world);
+  // accessors
+  size_t getStageCount();
+
+private:
+  void plan();
+};
+
+#endif // SCHEDULER_HPP_INCLUDED
@@ -0,0 +1,170 @@
+//! --------------------------------------------------------------------------
+//! -------------------------- INCLUDES
+//! --------------------------------------------------------------------------
+
+#include "World.hpp"
+
+#include "../memory/FrameAllocator.hpp"
+#include "../memory/heap.h"
+#include "../debug/stats.h"
+
+using namespace std;
+
+//! --------------------------------------------------------------------------
+//! -------------------------- CONSTRUCTORS, DESTRUCTOR
+//! --------------------------------------------------------------------------
+
+World::World() :
+records(),
+free_indices(),
+by_mask(),
+archetypes(),
+deferred_mutex(),
+deferred()
+{
+}
+
+World::~World()
+{
+  for(size_t i = 0; i < archetypes.size(); i++)
+    delete archetypes[i];
+}
+
+//! --------------------------------------------------------------------------
+//! -------------------------- ENTITIES
+//! --------------------------------------------------------------------------
+
+entity_t World::create()
+{
+  return allocate(getArchetype(0));
+}
+
+void World::destroy(entity_t entity)
+{
+  if(!isAlive(entity))
+    return;
+
+  record_t& r = records[entity.index];
+  entity_t moved = r.archetype->erase(r.chunk, r.row);
+  if(moved != ECS_NO_ENTITY)
+  {
+    records[moved.index].chunk = r.chunk;
+    records[moved.index].row = r.row;
+  }
+
+  // Outdate every handle to this index
+  r.archetype = nullptr;
+  if(!(++r.generation))
+    r.generation = 1;
+  HEAP_SCOPE(heap::ECS);
+  free_indices.push_back(entity.index);
+}
+
+bool World::isAlive(entity_t entity) const
+{
+  return entity.index < records.size()
+    && records[entity.index].generation == entity.generation
+    && records[entity.index].archetype;
+}
+
+entity_t World::allocate(Archetype* archetype)
+{
+  HEAP_SCOPE(heap::ECS);
+  entity_t entity;
+  if(free_indices.empty())
+  {
+    record_t r = { nullptr, 0, 0, 1 };
+    entity.index = records.size();
+    records.push_back(r);
+  }
+  else
+  {
+    entity.index = free_indices.back();
+    free_indices.pop_back();
+  }
+
+  record_t& r = records[entity.index];
+  entity.generation = r.generation;
+  r.archetype = archetype;
+  archetype->push(entity, r.chunk, r.row);
+  return entity;
+}
+
+void World::move(entity_t entity, Archetype* to)
+{
+  HEAP_SCOPE(heap::ECS);
+  record_t& r = records[entity.index];
+  uint32_t chunk, row;
+  to->push(entity, chunk, row);
+  r.archetype->copy(r.chunk, r.row, *to, chunk, row);
+
+  entity_t moved = r.archetype->erase(r.chunk, r.row);
+  if(moved != ECS_NO_ENTITY)
+  {
+    records[moved.index].chunk = r.chunk;
+    records[moved.index].row = r.row;
+  }
+
+  r.archetype = to;
+  r.chunk = chunk;
+  r.row = row;
+}
+
+//! --------------------------------------------------------------------------
+//! -------------------------- DEFERRED CHANGES
+//! --------------------------------------------------------------------------
+
+void World::defer(function<void(World&)> change)
+{
+  lock_guard<mutex> lock(deferred_mutex);
+  deferred.push_back(change);
+}
+
+void World::flush()
+{
+  // Moved out so that changes can defer more; 'deferred' keeps its capacity
+  frame_vector<function<void(World&)>> changes;
+  {
+    lock_guard<mutex> lock(deferred_mutex);
+    changes.reserve(deferred.size());
+    for(size_t i = 0; i < deferred.size(); i++)
+      changes.push_back(std::move(deferred[i]));
+    deferred.clear();
+  }
+
+  // Changes may defer more changes: they'll wait for the next flush
+  for(size_t i = 0; i < changes.size(); i++)
+    changes[i](*this);
+  stats::count("ecs.deferred", changes.size());
+}
+
+//! --------------------------------------------------------------------------
+//! -------------------------- ARCHETYPES
+//! --------------------------------------------------------------------------
+
+Archetype* World::getArchetype(component_mask_t mask)
+{
+  auto i = by_mask.find(mask);
+  if(i != by_mask.end())
+    return i->second;
+
+  HEAP_SCOPE(heap::ECS);
+  Archetype* archetype = new Archetype(mask);
+  by_mask[mask] = archetype;
+  archetypes.push_back(archetype);
+  return archetype;
+}
+
+const vector<Archetype*>& World::getArchetypes() const
+{
+  return archetypes;
+}
+
+//! --------------------------------------------------------------------------
+//! -------------------------- ACCESSORS
+//! --------------------------------------------------------------------------
+
+size_t World::size() const
+{
+  return records.size() - free_indices.size();
+}
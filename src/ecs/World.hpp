@@ -0,0 +1,81 @@
+#ifndef WORLD_HPP_INCLUDED
+#define WORLD_HPP_INCLUDED
+
+#include <vector>
+#include <unordered_map>
+#include <functional>
+#include <mutex>
+
+#include "components.h"
+#include "Archetype.hpp"
+
+// Every entity and its components. An entity lives in the archetype that
+// matches its set of components; adding or removing one moves it to another
+// archetype (found through a cached edge after the first time).
+//
+// Structural changes (create, destroy, add, remove) must not happen while
+// systems are running on other threads: defer them instead, they are
+// carried out by flush().
+
+class World
+{
+  /// NESTING
+private:
+  struct record_t
+  {
+    Archetype* archetype;     // null if the index is free
+    uint32_t chunk, row;
+    uint32_t generation;
+  };
+
+  /// ATTRIBUTES
+private:
+  std::vector<record_t> records;
+  std::vector<uint32_t> free_indices;
+  std::unordered_map<component_mask_t, Archetype*> by_mask;
+  std::vector<Archetype*> archetypes;   // in order of creation
+  std::mutex deferred_mutex;
+  std::vector<std::function<void(World&)>> deferred;
+
+  /// METHODS
+public:
+  // constructors, destructors
+  World();
+  ~World();
+  // entities
+  entity_t create();
+  template <typename... Ts>
+  entity_t create(const Ts&... values);
+  void destroy(entity_t entity);
+  bool isAlive(entity_t entity) const;
+  // components
+  template <typename T>
+  void add(entity_t entity, const T& value = T());
+  template <typename T>
+  void remove(entity_t entity);
+  template <typename T>
+  T* get(entity_t entity);        // null if it doesn't have one
+  template <typename T>
+  bool has(entity_t entity) const;
+  // structural changes from systems: thread-safe, run by flush()
+  void defer(std::function<void(World&)> change);
+  void flush();
+  // archetypes (for queries)
+  Archetype* getArchetype(component_mask_t mask);
+  const std::vector<Archetype*>& getArchetypes() const;
+  // accessors
+  size_t size() const;
+
+private:
+  // worlds are never copied: archetypes would be shared
+  World(const World&);
+  World& operator=(const World&);
+  entity_t allocate(Archetype* archetype);
+  void move(entity_t entity, Archetype* to);
+  template <typename T>
+  void set(entity_t entity, const T& value);
+};
+
+#include "World.inl"
+
+#endif // WORLD_HPP_INCLUDED
@@ -0,0 +1,79 @@
+// Inline file: a special implementation that is included rather than compiled
+
+//! --------------------------------------------------------------------------
+//! -------------------------- ENTITIES
+//! --------------------------------------------------------------------------
+
+template <typename... Ts>
+entity_t World::create(const Ts&... values)
+{
+  entity_t entity = allocate(getArchetype(components::mask<Ts...>()));
+
+  // Expand the pack in an array initialiser (C++11: no fold expressions)
+  int unused[] = { 0, (set<Ts>(entity, values), 0)... };
+  (void)unused;
+  return entity;
+}
+
+//! --------------------------------------------------------------------------
+//! -------------------------- COMPONENTS
+//! --------------------------------------------------------------------------
+
+template <typename T>
+void World::add(entity_t entity, const T& value)
+{
+  if(!isAlive(entity))
+    return;
+
+  uint32_t id = components::id<T>();
+  Archetype* from = records[entity.index].archetype;
+  if(!from->has(id))
+  {
+    Archetype*& to = from->getWith(id);
+    if(!to)
+      to = getArchetype(from->getMask() | components::bit<T>());
+    move(entity, to);
+  }
+  set<T>(entity, value);
+}
+
+template <typename T>
+void World::remove(entity_t entity)
+{
+  if(!isAlive(entity))
+    return;
+
+  uint32_t id = components::id<T>();
+  Archetype* from = records[entity.index].archetype;
+  if(from->has(id))
+  {
+    Archetype*& to = from->getWithout(id);
+    if(!to)
+      to = getArchetype(from->getMask() & ~components::bit<T>());
+    move(entity, to);
+  }
+}
+
+template <typename T>
+T* World::get(entity_t entity)
+{
+  if(!isAlive(entity))
+    return nullptr;
+
+  const record_t& r = records[entity.index];
+  return (T*)r.archetype->get(components::id<T>(), r.chunk, r.row);
+}
+
+template <typename T>
+bool World::has(entity_t entity) const
+{
+  return isAlive(entity)
+    && records[entity.index].archetype->has(components::id<T>());
+}
+
+template <typename T>
+void World::set(entity_t entity, const T& value)
+{
+  const record_t& r = records[entity.index];
+  r.archetype->column<T>(r.chunk)[r.row] = value;
+}
@@ -0,0 +1,48 @@
+//! --------------------------------------------------------------------------
+//! -------------------------- INCLUDES
+//! --------------------------------------------------------------------------
+
+#include "components.h"
+
+#include <cstdlib>
+#include <mutex>
+
+#include "../debug/log.h"
+
+using namespace std;
+
+//! --------------------------------------------------------------------------
+//! -------------------------- WORKSPACE
+//! --------------------------------------------------------------------------
+
+namespace
+{
+  static mutex types_mutex;
+  static size_t sizes[ECS_MAX_COMPONENTS];
+  static uint32_t n_types = 0;
+}
+
+//! --------------------------------------------------------------------------
+//! -------------------------- INTERFACE
+//! --------------------------------------------------------------------------
+
+namespace components
+{
+  uint32_t add(size_t size)
+  {
+    lock_guard<mutex> lock(types_mutex);
+    if(n_types >= ECS_MAX_COMPONENTS)
+    {
+      // Masks would silently overlap: better stop here
+      log(LOG_ERROR, "More than %d component types", ECS_MAX_COMPONENTS);
+      abort();
+    }
+    sizes[n_types] = size;
+    return n_types++;
+  }
+
+  size_t size(uint32_t id)
+  {
+    return sizes[id];
+  }
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstddef>
+#include <stdint.h>
+#include <type_traits>
+
+// Components are plain data: any trivially copyable type can be one, with
+// no registration beyond using it. Each type gets a small number the first
+// time it's used, and a set of component types fits in a 64-bit mask.
+
+#define ECS_MAX_COMPONENTS 64
+#define ECS_MAX_ALIGN 16
+
+typedef uint64_t component_mask_t;
+
+// --------------------------------------------------------------------------
+// ENTITY HANDLE
+// --------------------------------------------------------------------------
+
+// The index is reused once an entity is destroyed, the generation isn't: an
+// old handle to a reused index won't find anything
+struct entity_t
+{
+  uint32_t index;
+  uint32_t generation;    // 0 is never alive
+
+  bool operator==(const entity_t& other) const
+    { return index == other.index && generation == other.generation; }
+  bool operator!=(const entity_t& other) const
+    { return !(*this == other); }
+};
+
+#define ECS_NO_ENTITY (entity_t { 0, 0 })
+
+// --------------------------------------------------------------------------
+// COMPONENT TYPES
+// --------------------------------------------------------------------------
+
+namespace components
+{
+  // number the next type (thread-safe), fatal past ECS_MAX_COMPONENTS
+  uint32_t add(size_t size);
+
+  // size of a numbered type
+  size_t size(uint32_t id);
+
+  template <typename T>
+  uint32_t id()
+  {
+    static_assert(std::is_trivially_copyable<T>::value,
+                  "components are moved around with memcpy");
+    static_assert(std::alignment_of<T>::value <= ECS_MAX_ALIGN,
+                  "components can't be aligned beyond ECS_MAX_ALIGN");
+
+    // NB - initialisation of a local static only happens once, safely
+    static const uint32_t id = add(sizeof(T));
+    return id;
+  }
+
+  template <typename T>
+  component_mask_t bit()
+  {
+    return ((component_mask_t)1) << id<T>();
+  }
+
+  // mask of a list of types (C++11: no fold expressions)
+  template <typename... Ts>
+  component_mask_t mask()
+  {
+    component_mask_t bits[] = { 0, bit<Ts>()... }, result = 0;
+    for(size_t i = 0; i < sizeof(bits)/sizeof(bits[0]); i++)
+      result |= bits[i];
+    return result;
+  }
+}
@@ -0,0 +1,133 @@
+//! --------------------------------------------------------------------------
+//! -------------------------- INCLUDES
+//! --------------------------------------------------------------------------
+
+#include "events.h"
+
+#include <cstdlib>
+#include <atomic>
+#include <vector>
+
+#include "../threads/MpscQueue.hpp"
+#include "../memory/heap.h"
+#include "../debug/assert.h"
+#include "../debug/warn.h"
+#include "../debug/log.h"
+#include "../debug/stats.h"
+
+using namespace std;
+
+//! --------------------------------------------------------------------------
+//! -------------------------- WORKSPACE
+//! --------------------------------------------------------------------------
+
+namespace
+{
+  struct consumer_state_t
+  {
+    const char* name;
+    MpscQueue<events::event_t> queue;
+    vector<events::handler_t> handlers[EVENTS_MAX_TYPES];
+
+    consumer_state_t(const char* _name, size_t capacity) :
+    name(_name),
+    queue(capacity)
+    {
+    }
+  };
+
+  // The main consumer is there from the start; the others are never freed
+  // since a publisher could be holding on to them at any time
+  static consumer_state_t main_consumer("main", EVENTS_QUEUE_SIZE);
+  static consumer_state_t* consumers[EVENTS_MAX_CONSUMERS] = { &main_consumer };
+  static atomic<uint32_t> n_consumers(1);
+
+  // bit i of subscribers[type] is set if consumer i wants the type
+  static atomic<uint32_t> subscribers[EVENTS_MAX_TYPES];
+
+  // stats::count takes a lock, so publishers only touch these and the main
+  // consumer reports them
+  static atomic<uint32_t> published(0), dropped(0);
+}
+
+//! --------------------------------------------------------------------------
+//! -------------------------- INTERFACE
+//! --------------------------------------------------------------------------
+
+namespace events
+{
+  consumer_t add_consumer(const char* name, size_t capacity)
+  {
+    HEAP_SCOPE(heap::EVENTS);
+    consumer_t id = n_consumers.load();
+    ASSERT(id < EVENTS_MAX_CONSUMERS, "Adding event consumer");
+    consumers[id] = new consumer_state_t(name, capacity);
+    n_consumers.store(id + 1);
+    log("Added event consumer '%s' (%u events)", name,
+        (unsigned int)consumers[id]->queue.capacity());
+    return id;
+  }
+
+  int subscribe(type_t type, handler_t handler, consumer_t consumer)
+  {
+    if(type >= EVENTS_MAX_TYPES)
+      WARN_RTN("Subscribing to event", "Invalid type", EXIT_FAILURE);
+    if(consumer >= n_consumers.load())
+      WARN_RTN("Subscribing to event", "Invalid consumer", EXIT_FAILURE);
+
+    HEAP_SCOPE(heap::EVENTS);
+    consumers[consumer]->handlers[type].push_back(handler);
+    subscribers[type].fetch_or(1u << consumer);
+    return EXIT_SUCCESS;
+  }
+
+  bool publish(type_t type, const void* data, size_t size)
+  {
+    if(type >= EVENTS_MAX_TYPES || size > EVENTS_PAYLOAD)
+      return false;
+
+    published.fetch_add(1, memory_order_relaxed);
+    uint32_t mask = subscribers[type].load(memory_order_acquire);
+    if(!mask)
+      return true;
+
+    event_t event;
+    event.type = type;
+    event.size = (uint32_t)size;
+    if(size)
+      memcpy(event.payload, data, size);
+
+    bool delivered = true;
+    for(consumer_t i = 0; mask; i++, mask >>= 1)
+      if((mask & 1) && !consumers[i]->queue.push(event))
+      {
+        dropped.fetch_add(1, memory_order_relaxed);
+        delivered = false;
+      }
+    return delivered;
+  }
+
+  size_t dispatch(consumer_t consumer)
+  {
+    consumer_state_t* state = consumers[consumer];
+
+    // Stop at one queue's worth so handlers that publish can't keep us here
+    event_t event;
+    size_t n = 0, limit = state->queue.capacity();
+    while(n < limit && state->queue.pop(event))
+    {
+      vector<handler_t>& handlers = state->handlers[event.type];
+      for(size_t i = 0; i < handlers.size(); i++)
+        handlers[i](event);
+      n++;
+    }
+
+    if(consumer == MAIN)
+    {
+      stats::set("events.dispatched", n);
+      stats::set("events.published", published.exchange(0));
+      stats::set("events.dropped", dropped.exchange(0));
+    }
+    return n;
+  }
+}
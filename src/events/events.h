@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cstddef>
+#include <cstring>
+#include <functional>
+#include <stdint.h>
+#include <type_traits>
+
+// Typed events that any thread can publish without locking or allocating.
+// Each consumer (the main loop, a worker, ...) owns a lock-free queue of
+// fixed-size records; publishing copies the record into the queue of every
+// consumer subscribed to its type, and the consumer later dispatches its
+// queue to the handlers it registered, on its own thread. The main loop's
+// consumer exists from the start and is dispatched once per frame.
+//
+// Subscribing isn't meant to race with publishing: do it during setup.
+
+#define EVENTS_PAYLOAD 56           // bytes of data per event
+#define EVENTS_QUEUE_SIZE 4096      // records per consumer
+#define EVENTS_MAX_TYPES 64
+#define EVENTS_MAX_CONSUMERS 32
+
+namespace events
+{
+  typedef uint32_t type_t;
+  typedef uint32_t consumer_t;
+
+  // engine event types: the game numbers its own from USER
+  enum
+  {
+    QUIT,           // no payload
+    STATE_LEFT,     // no payload: the state on top is done leaving
+    CAPTURE_SAVED,  // capture::saved_t
+    USER = 16
+  };
+
+  // the consumer dispatched by the main loop
+  static const consumer_t MAIN = 0;
+
+  struct event_t
+  {
+    type_t type;
+    uint32_t size;
+    unsigned char payload[EVENTS_PAYLOAD];
+
+    template <typename T>
+    const T& as() const
+    {
+      return *reinterpret_cast<const T*>(payload);
+    }
+  };
+
+  typedef std::function<void(const event_t&)> handler_t;
+
+  // create a new queue, to be dispatched by whoever asked for it
+  consumer_t add_consumer(const char* name,
+                          size_t capacity = EVENTS_QUEUE_SIZE);
+
+  // call 'handler' for events of 'type' dispatched by 'consumer'
+  int subscribe(type_t type, handler_t handler, consumer_t consumer = MAIN);
+
+  // any thread: false if a subscriber's queue was full and the event was
+  // dropped for it (counted in events.dropped)
+  bool publish(type_t type, const void* data = nullptr, size_t size = 0);
+
+  template <typename T>
+  bool publish(type_t type, const T& data)
+  {
+    static_assert(sizeof(T) <= EVENTS_PAYLOAD, "Event payload too big");
+    static_assert(std::is_trivially_copyable<T>::value,
+                  "Event payload must be plain data");
+    return publish(type, &data, sizeof(T));
+  }
+
+  // consumer's thread: call the handlers for everything queued so far,
+  // returning how many events there were
+  size_t dispatch(consumer_t consumer = MAIN);
+}
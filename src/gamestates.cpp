@@ -0,0 +1,265 @@
+//! --------------------------------------------------------------------------
+//! -------------------------- INCLUDES
+//! --------------------------------------------------------------------------
+
+#include "gamestates.h"
+
+#include <cstdlib>
+#include <vector>
+
+#include "SDL.h"                        // Needed for SDL_Delay
+
+#include "events/events.h"
+#include "graphics/uploader.h"
+#include "debug/assert.h"
+#include "debug/log.h"
+#include "debug/warn.h"
+#include "debug/stats.h"
+
+using namespace std;
+
+//! --------------------------------------------------------------------------
+//! -------------------------- WORKSPACE
+//! --------------------------------------------------------------------------
+
+namespace
+{
+  enum operation_t
+  {
+    NONE,
+    PUSH,
+    POP,
+    REPLACE
+  };
+
+  static vector<gamestate_t*> stack;
+
+  // the switch waiting to happen
+  static operation_t operation = NONE;
+  static gamestate_t* incoming = nullptr;
+  static bool left = false, subscribed = false;
+  static double requested_at = 0, left_at = 0;
+
+  // enter and leave are optional
+  void enter(gamestate_t* state, gamestate_t* previous)
+  {
+    if(state->enter)
+      state->enter(previous ? *previous : *state);
+  }
+
+  void leave(gamestate_t* state, gamestate_t* next)
+  {
+    if(state->leave)
+      state->leave(next ? *next : *state);
+  }
+
+  bool is_ready(gamestate_t* state)
+  {
+    return !state || !state->ready || state->ready();
+  }
+
+  int request(operation_t op, gamestate_t* next)
+  {
+    if(operation != NONE)
+      WARN_RTN("Switching gamestate", "Already switching", EXIT_FAILURE);
+
+    operation = op;
+    incoming = next;
+    left = false;
+    requested_at = stats::now();
+
+    // Start loading now, while the current state is still playing
+    if(next && next->prepare)
+      ASSERT(next->prepare() == EXIT_SUCCESS, "Preparing gamestate");
+
+    return EXIT_SUCCESS;
+  }
+
+  void apply()
+  {
+    gamestate_t* previous = stack.empty() ? nullptr : stack.back();
+    switch(operation)
+    {
+      case PUSH:
+        stack.push_back(incoming);
+        enter(incoming, previous);
+      break;
+
+      case POP:
+        stack.pop_back();
+        leave(previous, stack.back());
+      break;
+
+      case REPLACE:
+        if(previous)
+        {
+          leave(previous, incoming);
+          stack.pop_back();
+        }
+        stack.push_back(incoming);
+        enter(incoming, previous);
+      break;
+
+      default:
+      break;
+    }
+
+    double now = stats::now();
+    stats::set("gamestate.switch.ms", now - requested_at);
+    stats::set("gamestate.switch.wait.ms", left ? now - left_at : 0.0);
+    log("Switched gamestate after %.1f ms (%.1f ms waiting on assets)",
+        now - requested_at, left ? now - left_at : 0.0);
+
+    operation = NONE;
+    incoming = nullptr;
+    left = false;
+  }
+
+  // Returns true if the switch happened
+  bool try_switch()
+  {
+    // Pushing doesn't need the state on top to leave
+    if(operation == NONE || !(left || operation == PUSH)
+    || !is_ready(incoming))
+      return false;
+
+    apply();
+    return true;
+  }
+
+  void on_left(const events::event_t& event)
+  {
+    // Nowhere to go: nothing to do
+    if(operation == NONE)
+      return;
+
+    if(!left)
+    {
+      left = true;
+      left_at = stats::now();
+    }
+    try_switch();
+  }
+}
+
+//! --------------------------------------------------------------------------
+//! -------------------------- INTERFACE
+//! --------------------------------------------------------------------------
+
+namespace gamestates
+{
+  int preload(gamestate_t& first)
+  {
+    ASSERT(stack.empty(), "Starting gamestates");
+    if(!subscribed)
+    {
+      ASSERT(events::subscribe(events::STATE_LEFT, on_left) == EXIT_SUCCESS,
+             "Subscribing to gamestate events");
+      subscribed = true;
+    }
+    ASSERT(request(PUSH, &first) == EXIT_SUCCESS, "Preparing first state");
+    return EXIT_SUCCESS;
+  }
+
+  int start(gamestate_t& first)
+  {
+    if(operation != PUSH || incoming != &first)
+      ASSERT(preload(first) == EXIT_SUCCESS, "Preloading first state");
+
+    // Nothing to show in the meantime: wait
+    while(!is_ready(&first))
+    {
+      uploader::update();
+      SDL_Delay(1);
+    }
+    apply();
+    return EXIT_SUCCESS;
+  }
+
+  int stop()
+  {
+    while(!stack.empty())
+    {
+      gamestate_t* state = stack.back();
+      stack.pop_back();
+      leave(state, stack.empty() ? nullptr : stack.back());
+    }
+    operation = NONE;
+    incoming = nullptr;
+    return EXIT_SUCCESS;
+  }
+
+  int push(gamestate_t& next)
+  {
+    return request(PUSH, &next);
+  }
+
+  int pop()
+  {
+    if(stack.size() < 2)
+      WARN_RTN("Popping gamestate", "Nothing to go back to", EXIT_FAILURE);
+    return request(POP, nullptr);
+  }
+
+  int replace(gamestate_t& next)
+  {
+    return request(REPLACE, &next);
+  }
+
+  int update(float dt)
+  {
+    int flags = stack.back()->update(dt);
+
+    // Keep checking while the assets arrive; the new state will want drawing
+    if(operation != NONE)
+      flags &= ~EVENT_IDLE;
+    try_switch();
+
+    return flags;
+  }
+
+  int treatInput(const input::snapshot_t& input)
+  {
+    if(!stack.back()->treatInput)
+      return 0;
+    return stack.back()->treatInput(input);
+  }
+
+  int draw()
+  {
+    // Start from the lowest state visible through the overlays
+    size_t first = stack.size() - 1;
+    while(first > 0 && stack[first]->overlay)
+      first--;
+
+    int result = EXIT_SUCCESS;
+    for(size_t i = first; i < stack.size(); i++)
+      if(stack[i]->draw() != EXIT_SUCCESS)
+        result = EXIT_FAILURE;
+    return result;
+  }
+
+  bool damage(DirtyRegion& region)
+  {
+    size_t first = stack.size() - 1;
+    while(first > 0 && stack[first]->overlay)
+      first--;
+
+    for(size_t i = first; i < stack.size(); i++)
+      if(!stack[i]->damage)
+        return false;
+    for(size_t i = first; i < stack.size(); i++)
+      stack[i]->damage(region);
+    return true;
+  }
+
+  bool busy()
+  {
+    return (operation != NONE);
+  }
+
+  gamestate_t* top()
+  {
+    return stack.empty() ? nullptr : stack.back();
+  }
+}
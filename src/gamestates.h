@@ -0,0 +1,93 @@
+#pragma once
+
+#include <functional>
+
+class DirtyRegion;
+namespace input { struct snapshot_t; }
+
+// --------------------------------------------------------------------------
+// FLAGS (returned by update and treatInput)
+// --------------------------------------------------------------------------
+
+// Anything more than this per-tick status, quitting and being done leaving
+// included, is published on the event bus (see events/events.h)
+#define EVENT_IDLE 0b00000010   // nothing changed: no need to redraw
+
+// --------------------------------------------------------------------------
+// GAMESTATE STRUCTURE
+// --------------------------------------------------------------------------
+
+struct gamestate_t
+{
+  std::function<int(float)> update;
+  std::function<int()> draw;
+  std::function<int(const input::snapshot_t &input)> treatInput;
+  std::function<int(gamestate_t &previous)> enter;
+  std::function<int(gamestate_t &next)> leave;
+  // optional: what changed since last frame (if not set, everything did)
+  std::function<void(DirtyRegion &region)> damage;
+  // optional: start loading assets in the background when a switch to this
+  // state is requested, and say when they have all arrived
+  std::function<int()> prepare;
+  std::function<bool()> ready;
+  // drawn over the state below rather than instead of it
+  bool overlay;
+
+  gamestate_t() : overlay(false) {}
+};
+
+// --------------------------------------------------------------------------
+// STACK OF GAMESTATES
+// --------------------------------------------------------------------------
+
+// Only the state on top is updated and receives events; it is drawn along
+// with any states below it that it overlays. Switching is done in two steps
+// so that the next state can load while the current one plays its exit:
+//
+//  1. push/replace call the new state's prepare() straight away;
+//  2. the switch happens once the state on top publishes events::STATE_LEFT
+//     and the new one is ready(). A push doesn't wait for STATE_LEFT: the
+//     state below stays where it is.
+//
+// STATE_LEFT is handled when the main consumer is dispatched, so the switch
+// happens within the tick that published it as long as dispatching comes
+// after update and treatInput.
+//
+// Switches are timed from request to completion (gamestate.switch.ms) and
+// the time spent waiting on assets after STATE_LEFT, which the player will
+// notice, is reported separately (gamestate.switch.wait.ms).
+
+namespace gamestates
+{
+  // start loading the first state's assets without waiting for them, so
+  // that start() has less to wait for
+  int preload(gamestate_t& first);
+
+  // prepare (unless preloaded) and enter the first state, waiting for its
+  // assets
+  int start(gamestate_t& first);
+
+  // leave every state, top first
+  int stop();
+
+  // request a switch (only one at a time: later requests are ignored)
+  int push(gamestate_t& next);
+  int pop();
+  int replace(gamestate_t& next);
+
+  // forward to the state on top, then switch if it's time
+  int update(float dt);
+  int treatInput(const input::snapshot_t& input);
+
+  // draw the top state over the ones it overlays
+  int draw();
+
+  // collect damage from every state drawn; false if one can't tell
+  bool damage(DirtyRegion& region);
+
+  // is a switch waiting to happen?
+  bool busy();
+
+  // the state on top (null if none)
+  gamestate_t* top();
+}
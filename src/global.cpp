@@ -3,5 +3,3 @@
 using namespace std;
 
 iV2 global::viewport;
-
-fV2 global::scale;
@@ -8,10 +8,38 @@
 #define MIN_FPS 20
 #define MAX_DT 1.0f/MIN_FPS
 #define APP_NAME "Fat Labrador Simulator 2014"
+#define DIRTY_RECTS 0           // redraw only what changed (needs swap-exchange)
+#define DYNAMIC_RESOLUTION 1    // render at lower resolution when frames run long
+#define ASSET_PACK "assets.pak" // built from assets/ by tools/mkpack
+
+// Memory tracking costs a header per allocation and an atomic add or two:
+// debug builds only unless asked for
+#ifndef MEMORY_TRACKING
+  #ifdef DEBUG
+    #define MEMORY_TRACKING 1
+  #else
+    #define MEMORY_TRACKING 0
+  #endif
+#endif
+#define BUDGET_GRAPHICS_MB 32   // warn when a subsystem holds more than this
+#define BUDGET_ECS_MB 64
+#define BUDGET_EVENTS_MB 4
+#define BUDGET_CAPTURE_MB 96
+#define BUDGET_VRAM_MB 128
+
+// Reloading assets when they're saved costs a watcher thread: debug builds
+// only as well
+#ifndef HOT_RELOAD
+  #ifdef DEBUG
+    #define HOT_RELOAD 1
+  #else
+    #define HOT_RELOAD 0
+  #endif
+#endif
+#define HOT_RELOAD_DIR "assets"
 
 namespace global
 {
   extern iV2 viewport;
-  extern fV2 scale;
 };
 
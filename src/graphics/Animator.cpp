@@ -0,0 +1,316 @@
+//! --------------------------------------------------------------------------
+//! -------------------------- INCLUDES
+//! --------------------------------------------------------------------------
+
+#include "Animator.hpp"
+
+#include <cmath>
+#include <algorithm>
+
+#include "../memory/heap.h"
+#include "../debug/stats.h"
+#include "../debug/warn.h"
+
+using namespace std;
+
+//! --------------------------------------------------------------------------
+//! -------------------------- CONSTRUCTORS, DESTRUCTOR
+//! --------------------------------------------------------------------------
+
+Animator::Animator() :
+sequences(),
+frames(),
+codes(),
+clocks(),
+instances(),
+events(),
+moving(false)
+{
+  // Everything runs on real time unless told otherwise
+  addClock();
+}
+
+//! --------------------------------------------------------------------------
+//! -------------------------- DEFINITIONS
+//! --------------------------------------------------------------------------
+
+uint32_t Animator::addSequence(Texture& texture, const fRect* _frames,
+                               uint32_t count, float fps, mode_t mode)
+{
+  // Nothing to show: update() would have no frame to pick
+  if(!count)
+    WARN_RTN("Animator::addSequence", "A sequence needs frames",
+             ANIMATOR_NO_SEQUENCE);
+
+  HEAP_SCOPE(heap::GRAPHICS);
+  sequence_t s = { &texture, (uint32_t)frames.size(), count, fps, mode };
+  frames.insert(frames.end(), _frames, _frames + count);
+  codes.resize(frames.size(), 0);
+  sequences.push_back(s);
+  return sequences.size() - 1;
+}
+
+uint32_t Animator::addMotion(const fRect* keys, uint32_t count,
+                             float keys_per_second, mode_t mode)
+{
+  // Moving goes from a key to another
+  if(count < 2)
+    WARN_RTN("Animator::addMotion", "A motion needs at least two keys",
+             ANIMATOR_NO_SEQUENCE);
+
+  HEAP_SCOPE(heap::GRAPHICS);
+  sequence_t s = { nullptr, (uint32_t)frames.size(), count, keys_per_second,
+                   mode };
+  frames.insert(frames.end(), keys, keys + count);
+  codes.resize(frames.size(), 0);
+  sequences.push_back(s);
+  return sequences.size() - 1;
+}
+
+void Animator::setKeys(uint32_t sequence, const fRect* keys)
+{
+  // Instances read the keys as they go: they follow at once
+  if(sequence < sequences.size())
+  {
+    const sequence_t& s = sequences[sequence];
+    copy(keys, keys + s.count, frames.begin() + s.first);
+  }
+}
+
+void Animator::setEvent(uint32_t sequence, uint32_t frame, int code)
+{
+  if(sequence >= sequences.size())
+    return;
+  const sequence_t& s = sequences[sequence];
+  if(frame < s.count)
+    codes[s.first + frame] = code;
+}
+
+uint32_t Animator::addClock(float speed)
+{
+  shared_clock_t c = { 0.0f, speed < 0.0f ? 0.0f : speed };
+  clocks.push_back(c);
+  return clocks.size() - 1;
+}
+
+int Animator::setSpeed(uint32_t clock, float speed)
+{
+  if(clock >= clocks.size())
+    WARN_RTN("Animator::setSpeed", "No such clock", EXIT_FAILURE);
+
+  // Time only goes forward: frames are worked out from elapsed time
+  clocks[clock].speed = (speed < 0.0f) ? 0.0f : speed;
+  return EXIT_SUCCESS;
+}
+
+//! --------------------------------------------------------------------------
+//! -------------------------- INSTANCES
+//! --------------------------------------------------------------------------
+
+handle_t Animator::play(uint32_t sequence, uint32_t clock)
+{
+  if(sequence >= sequences.size() || clock >= clocks.size())
+    WARN_RTN("Animator::play", "No such sequence or clock", NO_HANDLE);
+
+  HEAP_SCOPE(heap::GRAPHICS);
+  uint32_t first = sequences[sequence].first;
+  instance_t i = { sequence, clock, clocks[clock].time, first, first, 0.0f,
+                   true, false };
+  moving = true;
+  return instances.insert(i);
+}
+
+int Animator::restart(handle_t instance)
+{
+  instance_t* i = instances.get(instance);
+  if(!i)
+    WARN_RTN("Animator::restart", "Instance was stopped", EXIT_FAILURE);
+
+  i->start = clocks[i->clock].time;
+  i->frame = i->next = sequences[i->sequence].first;
+  i->blend = 0.0f;
+  i->fresh = true;
+  i->finished = false;
+  moving = true;
+  return EXIT_SUCCESS;
+}
+
+int Animator::stop(handle_t instance)
+{
+  // The last instance moves into the hole to stay contiguous
+  if(!instances.erase(instance))
+    WARN_RTN("Animator::stop", "Instance was already stopped", EXIT_FAILURE);
+  return EXIT_SUCCESS;
+}
+
+void Animator::clear()
+{
+  instances.clear();
+  events.clear();
+  moving = false;
+}
+
+//! --------------------------------------------------------------------------
+//! -------------------------- UPDATE
+//! --------------------------------------------------------------------------
+
+void Animator::update(float dt)
+{
+  STATS_TIME("animator.update");
+
+  for(size_t c = 0; c < clocks.size(); c++)
+    clocks[c].time += dt*clocks[c].speed;
+
+  // Frames are worked out from the time elapsed rather than stepped, so a
+  // long frame skips straight to where the animation should be (events of
+  // the frames in between are not reported)
+  events.clear();
+  moving = false;
+  const size_t n_instances = instances.size();
+  for(size_t index = 0; index < n_instances; index++)
+  {
+    instance_t& i = instances[index];
+    if(i.finished)
+      continue;
+
+    const sequence_t& s = sequences[i.sequence];
+    const shared_clock_t& c = clocks[i.clock];
+    uint32_t n, next;
+    float blend = 0.0f;
+    bool finishing = false;
+    if(s.texture)
+    {
+      n = (uint32_t)((c.time - i.start)*s.fps);
+      if(n >= s.count)
+      {
+        switch(s.mode)
+        {
+          case LOOP:
+            n %= s.count;
+          break;
+
+          case ONCE:
+            n = s.count - 1;
+            finishing = true;
+          break;
+
+          case PINGPONG:
+          {
+            uint32_t period = (s.count > 1) ? 2*s.count - 2 : 1;
+            n %= period;
+            if(n >= s.count)
+              n = period - n;
+          }
+          break;
+        }
+      }
+      next = n;
+    }
+    else
+    {
+      // Motions keep the fraction, to slide between keys: looping wraps
+      // the last key back to the first, the others stop on the last
+      float last = s.count - 1, f = (c.time - i.start)*s.fps;
+      switch(s.mode)
+      {
+        case LOOP:
+          f = fmod(f, (float)s.count);
+        break;
+
+        case ONCE:
+          if(f >= last)
+          {
+            f = last;
+            finishing = true;
+          }
+        break;
+
+        case PINGPONG:
+          f = fmod(f, 2*last);
+          if(f > last)
+            f = 2*last - f;
+        break;
+      }
+      n = (uint32_t)f;
+      if(n >= s.count)
+        n = s.count - 1;
+      blend = f - n;
+      next = (n + 1 < s.count) ? n + 1 : ((s.mode == LOOP) ? 0 : n);
+    }
+    i.next = s.first + next;
+    i.blend = blend;
+
+    uint32_t frame = s.first + n;
+    if(frame != i.frame || i.fresh)
+    {
+      i.frame = frame;
+      i.fresh = false;
+      if(codes[frame])
+      {
+        event_t e = { FRAME, instances.getHandle(index), codes[frame] };
+        events.push_back(e);
+      }
+    }
+
+    if(finishing)
+    {
+      i.finished = true;
+      event_t e = { FINISHED, instances.getHandle(index), 0 };
+      events.push_back(e);
+    }
+    else if(c.speed > 0.0f)
+      moving = true;
+  }
+
+  stats::count("animator.instances", n_instances);
+}
+
+const vector<Animator::event_t>& Animator::getEvents() const
+{
+  return events;
+}
+
+//! --------------------------------------------------------------------------
+//! -------------------------- ACCESSORS
+//! --------------------------------------------------------------------------
+
+Texture* Animator::getTexture(handle_t instance) const
+{
+  const instance_t* i = instances.get(instance);
+  return i ? sequences[i->sequence].texture : nullptr;
+}
+
+const fRect* Animator::getFrame(handle_t instance) const
+{
+  const instance_t* i = instances.get(instance);
+  return i ? &frames[i->frame] : nullptr;
+}
+
+fRect Animator::getRect(handle_t instance) const
+{
+  const instance_t* i = instances.get(instance);
+  if(!i)
+    return fRect();
+
+  const fRect &a = frames[i->frame], &b = frames[i->next];
+  float k = i->blend;
+  return fRect(a.x + (b.x - a.x)*k, a.y + (b.y - a.y)*k,
+               a.w + (b.w - a.w)*k, a.h + (b.h - a.h)*k);
+}
+
+bool Animator::isFinished(handle_t instance) const
+{
+  // Stopped counts as finished: there's nothing left to wait for
+  const instance_t* i = instances.get(instance);
+  return !i || i->finished;
+}
+
+size_t Animator::size() const
+{
+  return instances.size();
+}
+
+bool Animator::isPlaying() const
+{
+  return moving;
+}
@@ -0,0 +1,121 @@
+#ifndef ANIMATOR_HPP_INCLUDED
+#define ANIMATOR_HPP_INCLUDED
+
+#include <vector>
+#include <stdint.h>
+
+#include "Texture.hpp"
+#include "../math/Rect.hpp"
+#include "../memory/SlotMap.hpp"
+
+// Sprite animation: a sequence is a list of source rectangles in a texture
+// (an atlas) played at a fixed rate; an instance is one sprite playing a
+// sequence. Instances don't keep their own time: they read a clock, shared
+// by any number of them, so pausing or slowing down a group of sprites is a
+// single write. All instances are kept side by side and advanced by update()
+// in one pass, which also collects the events reached on the way.
+//
+// A motion is a sequence without a texture whose rectangles are keys, where
+// to draw something rather than what: instances of it glide from one key to
+// the next instead of jumping.
+
+#define ANIMATOR_DEFAULT_CLOCK 0
+#define ANIMATOR_NO_SEQUENCE 0xFFFFFFFF
+
+class Animator
+{
+  /// NESTING
+public:
+  enum mode_t
+  {
+    LOOP,       // start again from the first frame
+    ONCE,       // stop on the last frame
+    PINGPONG    // back and forth
+  };
+
+  enum event_type_t
+  {
+    FRAME,      // reached a frame with an event code
+    FINISHED    // a ONCE sequence reached its last frame
+  };
+
+  struct event_t
+  {
+    event_type_t type;
+    handle_t instance;
+    int code;   // given to the frame (FRAME events only)
+  };
+
+private:
+  struct sequence_t
+  {
+    Texture* texture; // null for motions
+    uint32_t first;   // in frames/codes
+    uint32_t count;
+    float fps;
+    mode_t mode;
+  };
+
+  struct shared_clock_t
+  {
+    float time;
+    float speed;
+  };
+
+  struct instance_t
+  {
+    uint32_t sequence;
+    uint32_t clock;
+    float start;      // clock time at which it started
+    uint32_t frame;   // absolute index in frames
+    uint32_t next;    // the key a motion is heading for...
+    float blend;      // ... and how far along it is
+    bool fresh;       // hasn't reported its first frame yet
+    bool finished;
+  };
+
+  /// ATTRIBUTES
+private:
+  // definitions
+  std::vector<sequence_t> sequences;
+  std::vector<fRect> frames;
+  std::vector<int> codes;       // 0 for no event
+  std::vector<shared_clock_t> clocks;
+  // playing instances, dense, with handles that notice when they go stale
+  SlotMap<instance_t> instances;
+  // output of the last update
+  std::vector<event_t> events;
+  bool moving;
+
+  /// METHODS
+public:
+  // constructors, destructors
+  Animator();
+  // definitions: frames are source rectangles in the texture, keys are
+  // destination rectangles (ANIMATOR_NO_SEQUENCE if there are too few)
+  uint32_t addSequence(Texture& texture, const fRect* frames,
+                       uint32_t count, float fps, mode_t mode = LOOP);
+  uint32_t addMotion(const fRect* keys, uint32_t count, float keys_per_second,
+                     mode_t mode = ONCE);
+  void setKeys(uint32_t sequence, const fRect* keys);   // as many as before
+  void setEvent(uint32_t sequence, uint32_t frame, int code);
+  uint32_t addClock(float speed = 1.0f);
+  int setSpeed(uint32_t clock, float speed);    // 0 to pause
+  // instances: NO_HANDLE or EXIT_FAILURE for an unknown sequence or instance
+  handle_t play(uint32_t sequence, uint32_t clock = ANIMATOR_DEFAULT_CLOCK);
+  int restart(handle_t instance);
+  int stop(handle_t instance);
+  void clear();
+  // advance every clock then every instance, refill the events
+  void update(float dt);
+  const std::vector<event_t>& getEvents() const;
+  // accessors: null (or empty) for an instance that was stopped
+  Texture* getTexture(handle_t instance) const;
+  const fRect* getFrame(handle_t instance) const;
+  fRect getRect(handle_t instance) const;   // the frame, or between keys
+  bool isFinished(handle_t instance) const;
+  size_t size() const;
+  bool isPlaying() const;   // is anything still moving?
+};
+
+#endif // ANIMATOR_HPP_INCLUDED
@@ -0,0 +1,176 @@
+//! --------------------------------------------------------------------------
+//! -------------------------- INCLUDES
+//! --------------------------------------------------------------------------
+
+#include "Camera.hpp"
+
+#include <cmath>
+
+#if defined(__SSE__) || defined(_M_X64)
+  #include <xmmintrin.h>            // Needed for SSE intrinsics
+  #define CAMERA_SSE
+#endif
+
+#include "opengl.h"
+#include "glstate.h"
+#include "../math/wjd_math.h"       // Needed for DEG2RAD
+
+//! --------------------------------------------------------------------------
+//! -------------------------- CONSTRUCTORS, DESTRUCTOR
+//! --------------------------------------------------------------------------
+
+Camera::Camera() :
+size(0, 0),
+position(0, 0),
+zoom(1.0f),
+rotation(0.0f),
+view()
+{
+}
+
+//! --------------------------------------------------------------------------
+//! -------------------------- ACCESSORS
+//! --------------------------------------------------------------------------
+
+void Camera::setSize(fV2 new_size)
+{
+  size = new_size;
+  updateView();
+}
+
+void Camera::setPosition(fV2 new_position)
+{
+  position = new_position;
+  updateView();
+}
+
+void Camera::setZoom(float new_zoom)
+{
+  zoom = new_zoom;
+  updateView();
+}
+
+void Camera::setRotation(float new_rotation)
+{
+  rotation = new_rotation;
+  updateView();
+}
+
+fV2 Camera::getSize() const
+{
+  return size;
+}
+
+fV2 Camera::getPosition() const
+{
+  return position;
+}
+
+float Camera::getZoom() const
+{
+  return zoom;
+}
+
+float Camera::getRotation() const
+{
+  return rotation;
+}
+
+fRect Camera::getView() const
+{
+  return view;
+}
+
+void Camera::updateView()
+{
+  // Half the screen in world units, then its bounding box once rotated
+  float c = fabs(cos(DEG2RAD(rotation))), s = fabs(sin(DEG2RAD(rotation)));
+  float half_w = size.x*0.5f/zoom, half_h = size.y*0.5f/zoom;
+  float extent_x = half_w*c + half_h*s, extent_y = half_w*s + half_h*c;
+  view = fRect(position.x - extent_x, position.y - extent_y,
+               extent_x*2, extent_y*2);
+}
+
+//! --------------------------------------------------------------------------
+//! -------------------------- COORDINATE CONVERSION
+//! --------------------------------------------------------------------------
+
+fV2 Camera::toWorld(fV2 screen) const
+{
+  fV2 d = (screen - size*0.5f)/zoom;
+  float c = cos(DEG2RAD(-rotation)), s = sin(DEG2RAD(-rotation));
+  return position + fV2(d.x*c - d.y*s, d.x*s + d.y*c);
+}
+
+fV2 Camera::toScreen(fV2 world) const
+{
+  fV2 d = world - position;
+  float c = cos(DEG2RAD(rotation)), s = sin(DEG2RAD(rotation));
+  return size*0.5f + fV2(d.x*c - d.y*s, d.x*s + d.y*c)*zoom;
+}
+
+void Camera::apply() const
+{
+  glstate::matrix_mode(GL_MODELVIEW);
+  glLoadIdentity();
+  glTranslatef(size.x*0.5f, size.y*0.5f, 0.0f);
+  glRotatef(rotation, 0.0f, 0.0f, 1.0f);
+  glScalef(zoom, zoom, 1.0f);
+  glTranslatef(-position.x, -position.y, 0.0f);
+}
+
+//! --------------------------------------------------------------------------
+//! -------------------------- CULLING
+//! --------------------------------------------------------------------------
+
+// A rectangle is visible if it overlaps the view's bounding box. With SSE the
+// rectangles are taken four at a time: fRect is exactly one register wide, so
+// four loads and a transpose give x, y, w and h vectors.
+size_t Camera::cull(const fRect* bounds, size_t count, uint32_t* visible) const
+{
+  size_t n_visible = 0, i = 0;
+
+#ifdef CAMERA_SSE
+  static_assert(sizeof(fRect) == 4*sizeof(float), "fRect must be packed");
+
+  const __m128 v_left = _mm_set1_ps(view.x),
+               v_top = _mm_set1_ps(view.y),
+               v_right = _mm_set1_ps(view.x + view.w),
+               v_bottom = _mm_set1_ps(view.y + view.h);
+
+  for(; i + 4 <= count; i += 4)
+  {
+    __m128 x = _mm_loadu_ps(&bounds[i].x),
+           y = _mm_loadu_ps(&bounds[i + 1].x),
+           w = _mm_loadu_ps(&bounds[i + 2].x),
+           h = _mm_loadu_ps(&bounds[i + 3].x);
+    _MM_TRANSPOSE4_PS(x, y, w, h);
+
+    __m128 inside = _mm_and_ps(
+      _mm_and_ps(_mm_cmplt_ps(x, v_right),
+                 _mm_cmpgt_ps(_mm_add_ps(x, w), v_left)),
+      _mm_and_ps(_mm_cmplt_ps(y, v_bottom),
+                 _mm_cmpgt_ps(_mm_add_ps(y, h), v_top)));
+
+    int mask = _mm_movemask_ps(inside);
+    for(int j = 0; j < 4; j++)
+    {
+      // branch-free: always write, only advance if visible
+      visible[n_visible] = i + j;
+      n_visible += (mask >> j) & 1;
+    }
+  }
+#endif // CAMERA_SSE
+
+  // Whatever is left (or everything, without SSE)
+  float right = view.x + view.w, bottom = view.y + view.h;
+  for(; i < count; i++)
+  {
+    const fRect& b = bounds[i];
+    visible[n_visible] = i;
+    n_visible += (b.x < right && b.x + b.w > view.x
+                  && b.y < bottom && b.y + b.h > view.y);
+  }
+
+  return n_visible;
+}
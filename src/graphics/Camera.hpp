@@ -0,0 +1,51 @@
+#ifndef CAMERA_HPP_INCLUDED
+#define CAMERA_HPP_INCLUDED
+
+#include <cstddef>
+#include <stdint.h>
+
+#include "../math/V2.hpp"
+#include "../math/Rect.hpp"
+
+// What part of the world is shown on screen. Sprites are given in world
+// coordinates; the camera turns them into screen pixels and decides which of
+// them are worth drawing at all. By default (centred on half the screen size,
+// zoom 1, no rotation) world coordinates are screen pixels.
+
+class Camera
+{
+  /// ATTRIBUTES
+private:
+  fV2 size;         // of the screen, in pixels
+  fV2 position;     // world point shown at the centre of the screen
+  float zoom;       // screen pixels per world unit
+  float rotation;   // in degrees, like Texture::draw's angle
+  fRect view;       // world-space bounding box of the screen
+
+  /// METHODS
+public:
+  // constructors, destructors
+  Camera();
+  // accessors
+  void setSize(fV2 new_size);
+  void setPosition(fV2 new_position);
+  void setZoom(float new_zoom);
+  void setRotation(float new_rotation);
+  fV2 getSize() const;
+  fV2 getPosition() const;
+  float getZoom() const;
+  float getRotation() const;
+  fRect getView() const;
+  // coordinate conversion
+  fV2 toWorld(fV2 screen) const;
+  fV2 toScreen(fV2 world) const;
+  // load the camera's transform into the modelview matrix
+  void apply() const;
+  // write the indices of the bounds that overlap the view, return how many
+  size_t cull(const fRect* bounds, size_t count, uint32_t* visible) const;
+
+private:
+  void updateView();
+};
+
+#endif // CAMERA_HPP_INCLUDED
@@ -0,0 +1,130 @@
+//! --------------------------------------------------------------------------
+//! -------------------------- INCLUDES
+//! --------------------------------------------------------------------------
+
+#include "DirtyRegion.hpp"
+
+#include <cmath>
+
+using namespace std;
+
+//! --------------------------------------------------------------------------
+//! -------------------------- UTILITIES
+//! --------------------------------------------------------------------------
+
+namespace
+{
+  iRect bounding_box(const iRect& a, const iRect& b)
+  {
+    int left = MIN(a.x, b.x), top = MIN(a.y, b.y),
+        right = MAX(a.x + a.w, b.x + b.w),
+        bottom = MAX(a.y + a.h, b.y + b.h);
+    return iRect(left, top, right - left, bottom - top);
+  }
+}
+
+//! --------------------------------------------------------------------------
+//! -------------------------- CONSTRUCTORS, DESTRUCTOR
+//! --------------------------------------------------------------------------
+
+DirtyRegion::DirtyRegion(iRect _bounds) :
+bounds(_bounds),
+rects()
+{
+}
+
+//! --------------------------------------------------------------------------
+//! -------------------------- MODIFICATION
+//! --------------------------------------------------------------------------
+
+void DirtyRegion::add(iRect rect)
+{
+  // Nothing outside the screen matters
+  rect = rect.getInter(bounds);
+  if(!rect)
+    return;
+
+  for(auto i = rects.begin(); i != rects.end(); )
+  {
+    // Already covered
+    if(i->getInter(rect) == rect)
+      return;
+
+    // Mostly overlapping: redraw the whole box at once
+    iRect box = bounding_box(*i, rect);
+    if(box.w*box.h <= i->w*i->h + rect.w*rect.h)
+    {
+      rect = box;
+      i = rects.erase(i);
+      continue;
+    }
+
+    // Otherwise trim what the new rectangle already covers
+    (*i) -= rect;
+    if(!(*i))
+      i = rects.erase(i);
+    else
+      i++;
+  }
+
+  rects.push_back(rect);
+
+  // Too many passes: merge everything
+  if(rects.size() > DIRTY_MAX_RECTS)
+  {
+    iRect box = rects[0];
+    for(size_t i = 1; i < rects.size(); i++)
+      box = bounding_box(box, rects[i]);
+    rects.assign(1, box);
+  }
+}
+
+void DirtyRegion::add(const fRect& rect)
+{
+  int left = (int)floor(rect.x), top = (int)floor(rect.y),
+      right = (int)ceil(rect.x + rect.w), bottom = (int)ceil(rect.y + rect.h);
+  add(iRect(left, top, right - left, bottom - top));
+}
+
+void DirtyRegion::add(const DirtyRegion& other)
+{
+  for(size_t i = 0; i < other.rects.size(); i++)
+    add(other.rects[i]);
+}
+
+void DirtyRegion::addAll()
+{
+  rects.assign(1, bounds);
+}
+
+void DirtyRegion::clear()
+{
+  rects.clear();
+}
+
+//! --------------------------------------------------------------------------
+//! -------------------------- ACCESSORS
+//! --------------------------------------------------------------------------
+
+void DirtyRegion::setBounds(iRect new_bounds)
+{
+  bounds = new_bounds;
+}
+
+const vector<iRect>& DirtyRegion::getRects() const
+{
+  return rects;
+}
+
+bool DirtyRegion::isEmpty() const
+{
+  return rects.empty();
+}
+
+int DirtyRegion::getArea() const
+{
+  int area = 0;
+  for(size_t i = 0; i < rects.size(); i++)
+    area += rects[i].w * rects[i].h;
+  return area;
+}
@@ -0,0 +1,39 @@
+#ifndef DIRTYREGION_HPP_INCLUDED
+#define DIRTYREGION_HPP_INCLUDED
+
+#include <vector>
+
+#include "../math/Rect.hpp"
+
+// The parts of the screen that changed since the last frame, as a short list
+// of non-overlapping rectangles. When the list grows too long, or rectangles
+// overlap too much, they are merged into their bounding box: a few extra
+// pixels are much cheaper than an extra pass over the scene.
+
+#define DIRTY_MAX_RECTS 4
+
+class DirtyRegion
+{
+  /// ATTRIBUTES
+private:
+  iRect bounds;
+  std::vector<iRect> rects;
+
+  /// METHODS
+public:
+  // constructors, destructors
+  DirtyRegion(iRect bounds = iRect());
+  // modification
+  void add(iRect rect);
+  void add(const fRect& rect);    // rounded outwards
+  void add(const DirtyRegion& other);
+  void addAll();
+  void clear();
+  // accessors
+  void setBounds(iRect new_bounds);
+  const std::vector<iRect>& getRects() const;
+  bool isEmpty() const;
+  int getArea() const;
+};
+
+#endif // DIRTYREGION_HPP_INCLUDED
@@ -0,0 +1,181 @@
+//! --------------------------------------------------------------------------
+//! -------------------------- INCLUDES
+//! --------------------------------------------------------------------------
+
+#include "DynamicResolution.hpp"
+
+#include "extensions.h"             // Needed for timer queries
+#include "glstate.h"
+#include "../debug/stats.h"
+#include "../math/wjd_math.h"       // Needed for MIN, MAX
+#include "../global.hpp"            // Needed for MAX_FPS
+
+//! --------------------------------------------------------------------------
+//! -------------------------- CONSTRUCTORS, DESTRUCTOR
+//! --------------------------------------------------------------------------
+
+resolution_settings_t::resolution_settings_t() :
+target_ms(RESOLUTION_TARGET_MS),
+min_scale(RESOLUTION_MIN_SCALE),
+max_scale(RESOLUTION_MAX_SCALE),
+step(RESOLUTION_STEP),
+hysteresis(RESOLUTION_HYSTERESIS),
+cooldown(RESOLUTION_COOLDOWN)
+{
+}
+
+DynamicResolution::DynamicResolution() :
+settings(),
+target(),
+window(),
+scale(1.0f),
+smoothed_ms(0.0f),
+cooldown(0),
+active(false),
+query(0),
+gpu_ms(0.0f)
+{
+  for(int i = 0; i < RESOLUTION_QUERIES; i++)
+  {
+    queries[i] = 0;
+    pending[i] = false;
+  }
+}
+
+int DynamicResolution::create(iRect _window, resolution_settings_t _settings)
+{
+  window = _window;
+  setSettings(_settings);
+  scale = settings.max_scale;
+
+  // Without somewhere to render to, just draw straight to the window
+  active = (target.create(window.w, window.h) == EXIT_SUCCESS);
+
+  if(active && extensions::timer_query)
+    extensions::GenQueries(RESOLUTION_QUERIES, queries);
+
+  return EXIT_SUCCESS;
+}
+
+int DynamicResolution::destroy()
+{
+  if(queries[0])
+    extensions::DeleteQueries(RESOLUTION_QUERIES, queries);
+  for(int i = 0; i < RESOLUTION_QUERIES; i++)
+  {
+    queries[i] = 0;
+    pending[i] = false;
+  }
+
+  active = false;
+  return target.destroy();
+}
+
+//! --------------------------------------------------------------------------
+//! -------------------------- DRAWING
+//! --------------------------------------------------------------------------
+
+void DynamicResolution::begin()
+{
+  // Time the GPU unless the oldest result hasn't been collected yet
+  if(queries[0] && !pending[query])
+    extensions::BeginQuery(GL_TIME_ELAPSED, queries[query]);
+
+  target.begin(scale);
+}
+
+void DynamicResolution::end()
+{
+  target.end();
+
+  // Stretch the part we rendered to cover the whole window, ignoring the
+  // camera: this is a screen-space operation
+  fRect src(0, 0, window.w*scale, window.h*scale), dst(window);
+  glstate::matrix_mode(GL_MODELVIEW);
+  glPushMatrix();
+  glLoadIdentity();
+  target.draw(&src, &dst);
+  glPopMatrix();
+
+  if(queries[0] && !pending[query])
+  {
+    extensions::EndQuery(GL_TIME_ELAPSED);
+    pending[query] = true;
+  }
+  query = (query + 1) % RESOLUTION_QUERIES;
+}
+
+//! --------------------------------------------------------------------------
+//! -------------------------- CONTROLLER
+//! --------------------------------------------------------------------------
+
+void DynamicResolution::update(float cpu_ms)
+{
+  if(!active)
+    return;
+
+  // Collect the GPU time of the oldest frame in flight, if it's done
+  if(queries[0] && pending[query])
+  {
+    GLint available = 0;
+    extensions::GetQueryObjectiv(queries[query], GL_QUERY_RESULT_AVAILABLE,
+                                 &available);
+    if(available)
+    {
+      GLuint64 ns = 0;
+      extensions::GetQueryObjectui64v(queries[query], GL_QUERY_RESULT, &ns);
+      gpu_ms = ns/1000000.0f;
+      pending[query] = false;
+    }
+  }
+
+  // Smooth out the odd slow frame
+  float frame_ms = MAX(cpu_ms, gpu_ms);
+  smoothed_ms = (smoothed_ms > 0) ? smoothed_ms*0.9f + frame_ms*0.1f
+                                  : frame_ms;
+
+  // Give the last change time to show before deciding again
+  if(cooldown > 0)
+    cooldown--;
+  else
+  {
+    float previous = scale;
+    if(smoothed_ms > settings.target_ms)
+      scale = MAX(scale - settings.step, settings.min_scale);
+    else if(smoothed_ms < settings.target_ms*(1.0f - settings.hysteresis))
+      scale = MIN(scale + settings.step, settings.max_scale);
+    if(scale != previous)
+      cooldown = settings.cooldown;
+  }
+
+  stats::set("resolution.scale", scale);
+  stats::set("resolution.cpu.ms", cpu_ms);
+  stats::set("resolution.gpu.ms", gpu_ms);
+}
+
+//! --------------------------------------------------------------------------
+//! -------------------------- ACCESSORS
+//! --------------------------------------------------------------------------
+
+bool DynamicResolution::isActive() const
+{
+  return active;
+}
+
+float DynamicResolution::getScale() const
+{
+  return scale;
+}
+
+void DynamicResolution::setSettings(resolution_settings_t new_settings)
+{
+  settings = new_settings;
+
+  // Never render above the window's own resolution
+  settings.max_scale = MIN(settings.max_scale, 1.0f);
+  settings.min_scale = MIN(settings.min_scale, settings.max_scale);
+  if(scale > settings.max_scale)
+    scale = settings.max_scale;
+  else if(scale < settings.min_scale)
+    scale = settings.min_scale;
+}
@@ -0,0 +1,66 @@
+#ifndef DYNAMICRESOLUTION_HPP_INCLUDED
+#define DYNAMICRESOLUTION_HPP_INCLUDED
+
+#include "RenderTarget.hpp"
+
+// Render the world offscreen at a fraction of the window's resolution and
+// stretch it back up, lowering the fraction when frames take too long and
+// raising it again when there is room to spare. The cost of a frame is the
+// worst of its CPU time (measured by the caller, without the swap) and its
+// GPU time (timer queries, a few frames late, when available).
+
+#define RESOLUTION_TARGET_MS (900.0f/MAX_FPS)  // leave 10% for the swap
+#define RESOLUTION_MIN_SCALE 0.5f
+#define RESOLUTION_MAX_SCALE 1.0f
+#define RESOLUTION_STEP 0.05f
+#define RESOLUTION_HYSTERESIS 0.2f   // grow only below (1 - this) x target
+#define RESOLUTION_COOLDOWN 30       // frames to wait after each change
+
+#define RESOLUTION_QUERIES 3         // GPU timings in flight
+
+struct resolution_settings_t
+{
+  float target_ms;
+  float min_scale, max_scale;
+  float step;
+  float hysteresis;
+  int cooldown;
+
+  resolution_settings_t();
+};
+
+class DynamicResolution
+{
+  /// ATTRIBUTES
+private:
+  resolution_settings_t settings;
+  RenderTarget target;
+  iRect window;
+  float scale;
+  float smoothed_ms;
+  int cooldown;
+  bool active;
+  // GPU timing
+  GLuint queries[RESOLUTION_QUERIES];
+  bool pending[RESOLUTION_QUERIES];
+  int query;
+  float gpu_ms;
+
+  /// METHODS
+public:
+  // constructors, destructors
+  DynamicResolution();
+  int create(iRect window, resolution_settings_t settings);
+  int destroy();
+  // redirect drawing offscreen, then stretch the result onto the window
+  void begin();
+  void end();
+  // once per frame with the CPU cost of the frame
+  void update(float cpu_ms);
+  // accessors
+  bool isActive() const;
+  float getScale() const;
+  void setSettings(resolution_settings_t new_settings);
+};
+
+#endif // DYNAMICRESOLUTION_HPP_INCLUDED
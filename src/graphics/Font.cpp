@@ -0,0 +1,207 @@
+//! --------------------------------------------------------------------------
+//! -------------------------- INCLUDES
+//! --------------------------------------------------------------------------
+
+#include "Font.hpp"
+
+#include "Text.hpp"
+#include "opengl.h"
+#include "glstate.h"
+#include "../math/wjd_math.h"       // Needed for MIN
+#include "../memory/heap.h"
+#include "../debug/assert.h"
+#include "../debug/stats.h"
+
+using namespace std;
+
+//! --------------------------------------------------------------------------
+//! -------------------------- CONSTANTS
+//! --------------------------------------------------------------------------
+
+// Indices are 16-bit: split bigger batches into several draws
+#define FONT_MAX_GLYPHS_PER_DRAW 16384
+
+//! --------------------------------------------------------------------------
+//! -------------------------- CONSTRUCTORS, DESTRUCTOR
+//! --------------------------------------------------------------------------
+
+Font::Font() :
+atlas(),
+cell(),
+batch(),
+indices()
+{
+}
+
+int Font::load(const char* filepath, iV2 cell_size, int columns)
+{
+  return load(hashid::intern(filepath), filepath, cell_size, columns);
+}
+
+int Font::load(hashid_t id, const char* filepath, iV2 cell_size, int columns)
+{
+  ASSERT(atlas.load(id, filepath) == EXIT_SUCCESS, filepath);
+  cell = fV2(cell_size);
+
+  // The atlas may have been padded to powers of 2: work in texture space
+  iRect area = atlas.getArea();
+  for(int i = 0; i < FONT_GLYPHS; i++)
+  {
+    uv[i].x = (i % columns)*cell.x/area.w;
+    uv[i].y = (i / columns)*cell.y/area.h;
+    uv[i].w = cell.x/area.w;
+    uv[i].h = cell.y/area.h;
+  }
+
+  return EXIT_SUCCESS;
+}
+
+int Font::unload()
+{
+  batch.clear();
+  return atlas.unload();
+}
+
+//! --------------------------------------------------------------------------
+//! -------------------------- LAYOUT
+//! --------------------------------------------------------------------------
+
+fV2 Font::measure(const char* text, float scale) const
+{
+  int columns = 0, widest = 0, lines = 1;
+  for(const char* c = text; *c; c++)
+  {
+    if(*c == '\n')
+    {
+      lines++;
+      columns = 0;
+    }
+    else if(++columns > widest)
+      widest = columns;
+  }
+  return fV2(widest*cell.x, lines*cell.y)*scale;
+}
+
+void Font::layout(const char* text, vector<vertex_t>& out, float scale,
+                  uint32_t colour) const
+{
+  GLubyte rgba[4] = { (GLubyte)(colour >> 24), (GLubyte)(colour >> 16),
+                      (GLubyte)(colour >> 8), (GLubyte)colour };
+  float w = cell.x*scale, h = cell.y*scale, x = 0, y = 0;
+
+  for(const char* c = text; *c; c++)
+  {
+    if(*c == '\n')
+    {
+      x = 0;
+      y += h;
+      continue;
+    }
+
+    // Spaces and anything outside the atlas take up room but aren't drawn
+    int glyph = (unsigned char)(*c) - FONT_FIRST;
+    if(glyph > 0 && glyph < FONT_GLYPHS)
+    {
+      const fRect& t = uv[glyph];
+      vertex_t quad[4] =
+      {
+        { x,     y,     t.x,       t.y,       { rgba[0], rgba[1], rgba[2], rgba[3] } },
+        { x + w, y,     t.x + t.w, t.y,       { rgba[0], rgba[1], rgba[2], rgba[3] } },
+        { x + w, y + h, t.x + t.w, t.y + t.h, { rgba[0], rgba[1], rgba[2], rgba[3] } },
+        { x,     y + h, t.x,       t.y + t.h, { rgba[0], rgba[1], rgba[2], rgba[3] } }
+      };
+      out.insert(out.end(), quad, quad + 4);
+    }
+    x += w;
+  }
+}
+
+//! --------------------------------------------------------------------------
+//! -------------------------- DRAWING
+//! --------------------------------------------------------------------------
+
+void Font::print(const char* text, fV2 position, float scale,
+                 uint32_t colour)
+{
+  HEAP_SCOPE(heap::GRAPHICS);
+  size_t first = batch.size();
+  layout(text, batch, scale, colour);
+  for(size_t i = first; i < batch.size(); i++)
+  {
+    batch[i].x += position.x;
+    batch[i].y += position.y;
+  }
+}
+
+void Font::print(const Text& text, fV2 position)
+{
+  const vector<vertex_t>& vertices = text.getVertices();
+  size_t first = batch.size();
+  batch.resize(first + vertices.size());
+  for(size_t i = 0; i < vertices.size(); i++)
+  {
+    vertex_t& v = batch[first + i];
+    v = vertices[i];
+    v.x += position.x;
+    v.y += position.y;
+  }
+}
+
+void Font::flush()
+{
+  if(batch.empty() || !atlas.isLoaded())
+  {
+    batch.clear();
+    return;
+  }
+
+  STATS_TIME("font.flush");
+  size_t glyphs = batch.size()/4;
+
+  // Two triangles per glyph, the same indices every time: grow only
+  size_t needed = MIN(glyphs, (size_t)FONT_MAX_GLYPHS_PER_DRAW)*6;
+  for(size_t i = indices.size()/6; i*6 < needed; i++)
+  {
+    GLushort q = i*4;
+    GLushort quad[6] = { q, (GLushort)(q + 1), (GLushort)(q + 2),
+                         q, (GLushort)(q + 2), (GLushort)(q + 3) };
+    indices.insert(indices.end(), quad, quad + 6);
+  }
+
+  glstate::bind_texture(atlas.getHandle());
+  glstate::enable_client_state(GL_VERTEX_ARRAY);
+  glstate::enable_client_state(GL_TEXTURE_COORD_ARRAY);
+  glstate::enable_client_state(GL_COLOR_ARRAY);
+
+  for(size_t first = 0; first < glyphs; first += FONT_MAX_GLYPHS_PER_DRAW)
+  {
+    size_t count = MIN(glyphs - first, (size_t)FONT_MAX_GLYPHS_PER_DRAW);
+    const vertex_t* v = &batch[first*4];
+    glVertexPointer(2, GL_FLOAT, sizeof(vertex_t), &v->x);
+    glTexCoordPointer(2, GL_FLOAT, sizeof(vertex_t), &v->u);
+    glColorPointer(4, GL_UNSIGNED_BYTE, sizeof(vertex_t), v->colour);
+    glDrawElements(GL_TRIANGLES, count*6, GL_UNSIGNED_SHORT, &indices[0]);
+    stats::count("font.draws");
+  }
+
+  // Everything else expects an untinted, colour-array-less pipeline
+  glstate::disable_client_state(GL_COLOR_ARRAY);
+  glColor4ub(255, 255, 255, 255);
+
+  stats::count("font.glyphs", glyphs);
+  batch.clear();
+}
+
+//! --------------------------------------------------------------------------
+//! -------------------------- ACCESSORS
+//! --------------------------------------------------------------------------
+
+bool Font::isLoaded() const
+{
+  return atlas.isLoaded();
+}
+
+fV2 Font::getCell() const
+{
+  return cell;
+}
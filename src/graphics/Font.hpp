@@ -0,0 +1,66 @@
+#ifndef FONT_HPP_INCLUDED
+#define FONT_HPP_INCLUDED
+
+#include <vector>
+#include <stdint.h>
+
+#include "Texture.hpp"
+#include "../math/V2.hpp"
+
+class Text;
+
+// Monospaced bitmap font: printable ASCII laid out in a grid of equal cells
+// in a single texture (the atlas), first character top-left, row by row.
+// Glyphs are not drawn one by one: everything printed is appended to a
+// vertex batch that flush() sends to OpenGL in a single draw call.
+
+#define FONT_FIRST 32           // ' '
+#define FONT_GLYPHS 96          // up to and including DEL (unused)
+#define FONT_COLUMNS 16
+#define FONT_WHITE 0xFFFFFFFF   // colours are 0xRRGGBBAA
+
+class Font
+{
+  /// NESTING
+public:
+  struct vertex_t
+  {
+    GLfloat x, y;
+    GLfloat u, v;
+    GLubyte colour[4];
+  };
+
+  /// ATTRIBUTES
+private:
+  Texture atlas;
+  fV2 cell;                     // size of each glyph in pixels
+  fRect uv[FONT_GLYPHS];        // texture coordinates of each glyph
+  std::vector<vertex_t> batch;
+  std::vector<GLushort> indices;
+
+  /// METHODS
+public:
+  // constructors, destructors
+  Font();
+  int load(const char* filepath, iV2 cell_size,
+           int columns = FONT_COLUMNS);
+  int load(hashid_t id, const char* filepath, iV2 cell_size,
+           int columns = FONT_COLUMNS);
+  int unload();
+  // size of some text once printed, new-lines included
+  fV2 measure(const char* text, float scale = 1.0f) const;
+  // lay out text with its top-left corner at the origin
+  void layout(const char* text, std::vector<vertex_t>& out,
+              float scale = 1.0f, uint32_t colour = FONT_WHITE) const;
+  // add text to the batch
+  void print(const char* text, fV2 position, float scale = 1.0f,
+             uint32_t colour = FONT_WHITE);
+  void print(const Text& text, fV2 position);
+  // draw and empty the batch
+  void flush();
+  // accessors
+  bool isLoaded() const;
+  fV2 getCell() const;
+};
+
+#endif // FONT_HPP_INCLUDED
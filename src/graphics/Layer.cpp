@@ -0,0 +1,98 @@
+//! --------------------------------------------------------------------------
+//! -------------------------- INCLUDES
+//! --------------------------------------------------------------------------
+
+#include "Layer.hpp"
+
+#include "opengl.h"
+#include "glstate.h"
+#include "../debug/stats.h"
+
+using namespace std;
+
+//! --------------------------------------------------------------------------
+//! -------------------------- CONSTRUCTORS, DESTRUCTOR
+//! --------------------------------------------------------------------------
+
+Layer::Layer() :
+target(),
+render(),
+dirty(true),
+cached(false)
+{
+}
+
+int Layer::create(int w, int h, function<void()> _render)
+{
+  render = _render;
+  dirty = true;
+
+  // Fall back to rendering every frame if we can't cache
+  cached = (target.create(w, h) == EXIT_SUCCESS);
+  return EXIT_SUCCESS;
+}
+
+int Layer::destroy()
+{
+  cached = false;
+  return target.destroy();
+}
+
+//! --------------------------------------------------------------------------
+//! -------------------------- DRAWING
+//! --------------------------------------------------------------------------
+
+void Layer::invalidate()
+{
+  dirty = true;
+}
+
+bool Layer::update()
+{
+  if(!cached)
+    return false;
+
+  if(dirty)
+  {
+    stats::count("layer.render");
+
+    // Start from transparent so the layer can go over anything
+    GLfloat clear_colour[4];
+    glstate::get_clear_colour(clear_colour);
+    target.begin();
+      glstate::clear_colour(0, 0, 0, 0);
+      glClear(GL_COLOR_BUFFER_BIT);
+      render();
+    target.end();
+    glstate::clear_colour(clear_colour[0], clear_colour[1], clear_colour[2],
+                          clear_colour[3]);
+
+    dirty = false;
+  }
+  return true;
+}
+
+void Layer::draw(const fRect* dst_ptr)
+{
+  if(!update())
+  {
+    render();
+    return;
+  }
+
+  // The colours in the layer are already multiplied by their alpha
+  fRect src(target.getUsed());
+  fRect dst = dst_ptr ? (*dst_ptr) : src;
+  glstate::blend_func(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+  target.draw(&src, &dst);
+  glstate::blend_func(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+}
+
+//! --------------------------------------------------------------------------
+//! -------------------------- ACCESSORS
+//! --------------------------------------------------------------------------
+
+RenderTarget& Layer::getTarget()
+{
+  return target;
+}
@@ -0,0 +1,40 @@
+#ifndef LAYER_HPP_INCLUDED
+#define LAYER_HPP_INCLUDED
+
+#include <functional>
+
+#include "RenderTarget.hpp"
+
+// Cache for something that rarely changes (a tiled background, a HUD frame):
+// it is rendered once into a RenderTarget and then drawn as a single quad
+// until invalidate() is called. Without framebuffer objects the layer is
+// simply rendered every frame. To go through a RenderQueue rather than be
+// drawn on the spot, update() it and push its target.
+
+class Layer
+{
+  /// ATTRIBUTES
+private:
+  RenderTarget target;
+  std::function<void()> render;
+  bool dirty;
+  bool cached;
+
+  /// METHODS
+public:
+  // constructors, destructors
+  Layer();
+  int create(int w, int h, std::function<void()> render);
+  int destroy();
+  // the contents have changed, re-render them next time they are drawn
+  void invalidate();
+  // re-render the contents if needed: false if they can't be cached, in
+  // which case the caller has to render them itself
+  bool update();
+  // draw the contents, re-rendering them first if needed
+  void draw(const fRect* destination_pointer = nullptr);
+  // accessors
+  RenderTarget& getTarget();
+};
+
+#endif // LAYER_HPP_INCLUDED
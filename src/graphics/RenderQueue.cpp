@@ -0,0 +1,195 @@
+//! --------------------------------------------------------------------------
+//! -------------------------- INCLUDES
+//! --------------------------------------------------------------------------
+
+#include "RenderQueue.hpp"
+
+#include <cstring>
+#include <cmath>
+
+#include "../memory/frame.h"
+#include "../memory/heap.h"
+#include "../debug/stats.h"
+#include "../math/wjd_math.h"       // Needed for DEG2RAD
+
+using namespace std;
+
+//! --------------------------------------------------------------------------
+//! -------------------------- UTILITIES
+//! --------------------------------------------------------------------------
+
+namespace
+{
+  // Map a float onto an unsigned integer with the same ordering
+  inline uint32_t sortable(float f)
+  {
+    uint32_t u;
+    memcpy(&u, &f, sizeof(u));
+    return (u & 0x80000000) ? ~u : (u | 0x80000000);
+  }
+}
+
+//! --------------------------------------------------------------------------
+//! -------------------------- CONSTRUCTORS, DESTRUCTOR
+//! --------------------------------------------------------------------------
+
+uint64_t RenderQueue::key(unsigned int layer, bool translucent,
+                          GLuint texture, float depth)
+{
+  uint64_t result = (uint64_t)(layer & 0xff) << 56;
+  uint64_t t = texture & 0x7fffff;
+  uint64_t d = sortable(depth);
+
+  if(translucent)
+    result |= ((uint64_t)1 << 55) | ((~d & 0xffffffff) << 23) | t;
+  else
+    result |= (t << 32) | d;
+
+  return result;
+}
+
+RenderQueue::RenderQueue() :
+commands(),
+bounds(),
+items(),
+visible()
+{
+}
+
+//! --------------------------------------------------------------------------
+//! -------------------------- SUBMISSIONS
+//! --------------------------------------------------------------------------
+
+void RenderQueue::push(uint64_t key, Texture& texture, const fRect* src_ptr,
+                       const fRect& dst, float angle)
+{
+  HEAP_SCOPE(heap::GRAPHICS);
+  item_t item = { key, (uint32_t)commands.size() };
+  items.push_back(item);
+
+  command_t command;
+  command.texture = &texture;
+  command.whole = !src_ptr;
+  if(src_ptr)
+    command.src = *src_ptr;
+  command.dst = dst;
+  command.angle = angle;
+  commands.push_back(command);
+
+  // Rotated sprites (around their centre) cover their bounding box
+  if(angle)
+  {
+    float c = fabs(cos(DEG2RAD(angle))), s = fabs(sin(DEG2RAD(angle)));
+    float extent_x = (dst.w*c + dst.h*s)*0.5f,
+          extent_y = (dst.w*s + dst.h*c)*0.5f;
+    bounds.push_back(fRect(dst.x + dst.w*0.5f - extent_x,
+                           dst.y + dst.h*0.5f - extent_y,
+                           extent_x*2, extent_y*2));
+  }
+  else
+    bounds.push_back(dst);
+}
+
+void RenderQueue::clear()
+{
+  // keep the memory for next frame
+  commands.clear();
+  bounds.clear();
+  items.clear();
+}
+
+//! --------------------------------------------------------------------------
+//! -------------------------- SORT AND SUBMIT
+//! --------------------------------------------------------------------------
+
+// Must come before sort(), while items are still in submission order
+void RenderQueue::cull(const Camera& camera)
+{
+  STATS_TIME("render.cull");
+
+  size_t n = items.size();
+  if(!n)
+    return;
+
+  // the camera may write one index past the last visible one
+  visible.resize(n + 4);
+  size_t n_visible = camera.cull(&bounds[0], n, &visible[0]);
+  for(size_t i = 0; i < n_visible; i++)
+    items[i] = items[visible[i]];
+  items.resize(n_visible);
+
+  stats::count("render.culled", n - n_visible);
+}
+
+// Least-significant-digit radix sort, one byte per pass. All the histograms
+// are built in a single read, and passes where every key has the same byte
+// (typically the layer and most of the depth) are skipped entirely.
+void RenderQueue::sort()
+{
+  STATS_TIME("render.sort");
+  stats::count("render.commands", items.size());
+
+  size_t n = items.size();
+  if(n < 2)
+    return;
+
+  // Only needed while sorting: no point keeping a second copy around
+  item_t* scratch = frame::allocate<item_t>(n);
+
+  static uint32_t histogram[8][256];
+  memset(histogram, 0, sizeof(histogram));
+  for(size_t i = 0; i < n; i++)
+  {
+    uint64_t k = items[i].key;
+    for(int b = 0; b < 8; b++)
+      histogram[b][(k >> (8*b)) & 0xff]++;
+  }
+
+  item_t *from = &items[0], *to = scratch;
+  for(int b = 0; b < 8; b++)
+  {
+    uint32_t* counts = histogram[b];
+    if(counts[(from[0].key >> (8*b)) & 0xff] == n)
+      continue;
+
+    // counts become starting offsets
+    uint32_t offset = 0;
+    for(int d = 0; d < 256; d++)
+    {
+      uint32_t count = counts[d];
+      counts[d] = offset;
+      offset += count;
+    }
+
+    for(size_t i = 0; i < n; i++)
+      to[counts[(from[i].key >> (8*b)) & 0xff]++] = from[i];
+
+    item_t* swap = from;
+    from = to;
+    to = swap;
+  }
+
+  // odd number of passes: the result is in the scratch buffer
+  if(from != &items[0])
+    memcpy(&items[0], from, n*sizeof(item_t));
+}
+
+void RenderQueue::submit()
+{
+  STATS_TIME("render.submit");
+
+  for(size_t i = 0; i < items.size(); i++)
+  {
+    command_t& c = commands[items[i].index];
+    c.texture->draw(c.whole ? nullptr : &c.src, &c.dst, c.angle);
+  }
+}
+
+//! --------------------------------------------------------------------------
+//! -------------------------- ACCESSORS
+//! --------------------------------------------------------------------------
+
+size_t RenderQueue::size() const
+{
+  return items.size();
+}
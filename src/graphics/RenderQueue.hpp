@@ -0,0 +1,62 @@
+#ifndef RENDERQUEUE_HPP_INCLUDED
+#define RENDERQUEUE_HPP_INCLUDED
+
+#include <vector>
+#include <stdint.h>
+
+#include "Texture.hpp"
+#include "Camera.hpp"
+
+// Draw commands collected over a frame, then radix-sorted on a 64-bit key so
+// that they come out layer by layer and, within a layer, grouped by texture
+// (opaque) or back-to-front (translucent). From most to least significant:
+//
+//   opaque:       layer:8 | 0 | texture:23 | depth:32
+//   translucent:  layer:8 | 1 | depth:32 (far first) | texture:23
+
+class RenderQueue
+{
+  /// NESTING
+public:
+  struct command_t
+  {
+    Texture* texture;
+    fRect src, dst;
+    float angle;
+    bool whole;       // no source rectangle: use the whole texture
+  };
+private:
+  struct item_t
+  {
+    uint64_t key;
+    uint32_t index;
+  };
+
+  /// ATTRIBUTES
+private:
+  std::vector<command_t> commands;
+  std::vector<fRect> bounds;      // contiguous for culling
+  std::vector<item_t> items;
+  std::vector<uint32_t> visible;
+
+  /// METHODS
+public:
+  // build a sort key, larger depth means further away
+  static uint64_t key(unsigned int layer, bool translucent, GLuint texture,
+                      float depth);
+  // constructors, destructors
+  RenderQueue();
+  // submissions
+  void push(uint64_t key, Texture& texture, const fRect* src_ptr,
+            const fRect& dst, float angle = 0.0f);
+  void clear();
+  // once per frame: drop what's off-screen, order, then draw (possibly
+  // several times)
+  void cull(const Camera& camera);
+  void sort();
+  void submit();
+  // accessors
+  size_t size() const;
+};
+
+#endif // RENDERQUEUE_HPP_INCLUDED
@@ -0,0 +1,111 @@
+//! --------------------------------------------------------------------------
+//! -------------------------- INCLUDES
+//! --------------------------------------------------------------------------
+
+#include "RenderTarget.hpp"
+
+#include "extensions.h"             // Needed for framebuffer objects
+#include "glstate.h"
+#include "../debug/assert.h"
+#include "../debug/warn.h"
+#include "../math/wjd_math.h"       // Needed for nextpwr2
+
+//! --------------------------------------------------------------------------
+//! -------------------------- CONSTRUCTORS, DESTRUCTOR
+//! --------------------------------------------------------------------------
+
+RenderTarget::RenderTarget() :
+Texture(),
+framebuffer(0),
+used()
+{
+}
+
+int RenderTarget::create(int w, int h)
+{
+  if(!extensions::fbo)
+    WARN_RTN("RenderTarget::create()", "No framebuffer objects",
+             EXIT_FAILURE);
+
+  // Free any previous content
+  if(framebuffer)
+    destroy();
+
+  // An empty texture to draw into
+  ASSERT(from_pixels(nullptr, nextpwr2(w), nextpwr2(h), 4) == EXIT_SUCCESS,
+         "Creating render target texture");
+  used = iRect(0, 0, w, h);
+
+  // Attach it to a new framebuffer
+  extensions::GenFramebuffers(1, &framebuffer);
+  glstate::bind_framebuffer(framebuffer);
+  extensions::FramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0,
+                                   GL_TEXTURE_2D, handle, 0);
+  GLenum status = extensions::CheckFramebufferStatus(GL_FRAMEBUFFER);
+  glstate::bind_framebuffer(0);
+
+  // Don't leave a framebuffer nobody can use behind
+  if(status != GL_FRAMEBUFFER_COMPLETE)
+    destroy();
+  ASSERT(status == GL_FRAMEBUFFER_COMPLETE, "Creating render target");
+  return EXIT_SUCCESS;
+}
+
+int RenderTarget::destroy()
+{
+  if(framebuffer)
+    extensions::DeleteFramebuffers(1, &framebuffer);
+  framebuffer = 0;
+
+  return loaded ? unload() : EXIT_SUCCESS;
+}
+
+//! --------------------------------------------------------------------------
+//! -------------------------- DRAWING
+//! --------------------------------------------------------------------------
+
+void RenderTarget::begin(float scale)
+{
+  glstate::bind_framebuffer(framebuffer);
+
+  // Cover the used part of the texture with the origin at the top-left,
+  // shrunk by 'scale'. The projection is upside-down compared to the
+  // screen's because texture rows start at the bottom: the result then
+  // draws the right way up.
+  glstate::get_viewport(previous_viewport);
+  glstate::viewport(0, 0, (GLsizei)(used.w*scale), (GLsizei)(used.h*scale));
+  glstate::matrix_mode(GL_PROJECTION);
+  glPushMatrix();
+  glLoadIdentity();
+  glOrtho(0, used.w, 0, used.h, -1, 1);
+  glstate::matrix_mode(GL_MODELVIEW);
+  glPushMatrix();
+  glLoadIdentity();
+
+  // Keep the alpha channel meaningful so the result can be blended later
+  glstate::blend_func_separate(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA,
+                               GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+}
+
+void RenderTarget::end()
+{
+  glstate::blend_func(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+  glstate::matrix_mode(GL_PROJECTION);
+  glPopMatrix();
+  glstate::matrix_mode(GL_MODELVIEW);
+  glPopMatrix();
+  glstate::viewport(previous_viewport[0], previous_viewport[1],
+                    previous_viewport[2], previous_viewport[3]);
+
+  glstate::bind_framebuffer(0);
+}
+
+//! --------------------------------------------------------------------------
+//! -------------------------- ACCESSORS
+//! --------------------------------------------------------------------------
+
+iRect RenderTarget::getUsed() const
+{
+  return used;
+}
@@ -0,0 +1,33 @@
+#ifndef RENDERTARGET_HPP_INCLUDED
+#define RENDERTARGET_HPP_INCLUDED
+
+#include "Texture.hpp"
+
+// A Texture that can be drawn into through a framebuffer object. Everything
+// drawn between begin() and end() lands in the texture, using the same
+// top-left pixel coordinates as the screen.
+
+class RenderTarget : public Texture
+{
+  /// ATTRIBUTES
+private:
+  GLuint framebuffer;
+  iRect used;             // requested size, the texture is padded to pwr2
+  GLint previous_viewport[4];
+
+  /// METHODS
+public:
+  // constructors, destructors
+  RenderTarget();
+  int create(int w, int h);
+  int destroy();
+  // redirect drawing to the texture and back to the screen; with a scale
+  // below 1 only the top-left part of the texture is drawn into, at a
+  // proportionally lower resolution
+  void begin(float scale = 1.0f);
+  void end();
+  // accessors
+  iRect getUsed() const;
+};
+
+#endif // RENDERTARGET_HPP_INCLUDED
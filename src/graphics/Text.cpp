@@ -0,0 +1,76 @@
+//! --------------------------------------------------------------------------
+//! -------------------------- INCLUDES
+//! --------------------------------------------------------------------------
+
+#include "Text.hpp"
+
+using namespace std;
+
+//! --------------------------------------------------------------------------
+//! -------------------------- CONSTRUCTORS, DESTRUCTOR
+//! --------------------------------------------------------------------------
+
+Text::Text() :
+font(nullptr),
+text(),
+scale(1.0f),
+colour(FONT_WHITE),
+vertices(),
+size()
+{
+}
+
+Text::Text(const Font& _font) :
+font(&_font),
+text(),
+scale(1.0f),
+colour(FONT_WHITE),
+vertices(),
+size()
+{
+}
+
+//! --------------------------------------------------------------------------
+//! -------------------------- LAYOUT
+//! --------------------------------------------------------------------------
+
+void Text::set(const char* new_text, float new_scale, uint32_t new_colour)
+{
+  if(!font || (text == new_text && scale == new_scale
+               && colour == new_colour))
+    return;
+
+  text = new_text;
+  scale = new_scale;
+  colour = new_colour;
+  vertices.clear();
+  font->layout(new_text, vertices, scale, colour);
+  size = font->measure(new_text, scale);
+}
+
+void Text::setFont(const Font& new_font)
+{
+  font = &new_font;
+  vertices.clear();
+  font->layout(text.c_str(), vertices, scale, colour);
+  size = font->measure(text.c_str(), scale);
+}
+
+//! --------------------------------------------------------------------------
+//! -------------------------- ACCESSORS
+//! --------------------------------------------------------------------------
+
+const string& Text::getText() const
+{
+  return text;
+}
+
+fV2 Text::getSize() const
+{
+  return size;
+}
+
+const vector<Font::vertex_t>& Text::getVertices() const
+{
+  return vertices;
+}
@@ -0,0 +1,39 @@
+#ifndef TEXT_HPP_INCLUDED
+#define TEXT_HPP_INCLUDED
+
+#include <string>
+#include <vector>
+
+#include "Font.hpp"
+
+// A string laid out once with a given font, scale and colour, so that text
+// which doesn't change from one frame to the next (labels, menus, a score
+// that only moves now and then) is only copied into the batch when printed.
+
+class Text
+{
+  /// ATTRIBUTES
+private:
+  const Font* font;
+  std::string text;
+  float scale;
+  uint32_t colour;
+  std::vector<Font::vertex_t> vertices;
+  fV2 size;
+
+  /// METHODS
+public:
+  // constructors, destructors
+  Text();
+  Text(const Font& font);
+  // lay the text out again only if something changed
+  void set(const char* new_text, float new_scale = 1.0f,
+           uint32_t new_colour = FONT_WHITE);
+  void setFont(const Font& new_font);
+  // accessors
+  const std::string& getText() const;
+  fV2 getSize() const;
+  const std::vector<Font::vertex_t>& getVertices() const;
+};
+
+#endif // TEXT_HPP_INCLUDED
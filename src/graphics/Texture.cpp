@@ -4,15 +4,83 @@
 
 #include "Texture.hpp"
 
-#include "SDL.h"                    // Needed for IMG_Load
+#include "SDL.h"                    // Needed for IMG_Load_RW
 #include "SDL_image.h"
 
 #include "opengl.h"                 // Needed for OpenGL/GLES
+#include "extensions.h"             // Needed for glCompressedTexImage2D
+#include "texture_cache.h"
+#include "hotreload.h"              // Needed to reload when files change
+#include "glstate.h"                // Needed for glstate::bind_texture
+#include "../io/pack.h"             // Needed for pack::open_rw
 #include "../debug/assert.h"        // Needed for ASSERT macro
 #include "../debug/warn.h"
 #include "../math/wjd_math.h"       // Needed for ISPWR2
+#include "../debug/stats.h"
+#include "../memory/heap.h"
+#include "../memory/vram.h"         // Needed to account for uploads
 #include "../global.hpp"
 
+#include <vector>
+#include <mutex>
+
+using namespace std;
+
+//! --------------------------------------------------------------------------
+//! -------------------------- UTILITIES
+//! --------------------------------------------------------------------------
+
+namespace
+{
+  // Handles waiting to be deleted at the end of the frame
+  static vector<GLuint> unloaded;
+  static mutex unloaded_mutex;
+
+  // Set the properties of the currently bound texture
+  void set_parameters()
+  {
+    glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+  }
+
+  // Format matching the number of channels, 0 if there's none
+  GLenum pixel_format(int n_colours)
+  {
+    switch(n_colours)
+    {
+      case 1: return GL_LUMINANCE;
+      case 2: return GL_LUMINANCE_ALPHA;
+      case 3: return GL_RGB;
+      case 4: return GL_RGBA;
+      default:
+        log(LOG_ERROR, "Load texture failed : %d colours Image must be LUMINANCE, RGB or RGBA", n_colours);
+        return 0;
+    }
+  }
+
+  // Return a copy of the surface enlarged to powers of 2, or the surface
+  // itself if it already has the right size
+  SDL_Surface* enlarge(SDL_Surface* surface)
+  {
+    int w = ISPWR2(surface->w) ? surface->w : nextpwr2(surface->w),
+        h = ISPWR2(surface->h) ? surface->h : nextpwr2(surface->h);
+    if(w == surface->w && h == surface->h)
+      return surface;
+
+    // NB - Hexadecimal parameters are: Rmask, Gmask, Bmask and Amask, in the
+    // byte order glTexImage2D expects for GL_RGBA
+    SDL_Surface* result = SDL_CreateRGBSurface(0, w, h, 32,
+                                0x000000ff, 0x0000ff00, 0x00ff0000, 0xff000000);
+    // paste contents of previous (small) surface onto new (larger) surface,
+    // copying alpha rather than blending with the empty background
+    SDL_SetSurfaceBlendMode(surface, SDL_BLENDMODE_NONE);
+    SDL_BlitSurface(surface, 0, result, 0);
+    return result;
+  }
+}
+
 //! --------------------------------------------------------------------------
 //! -------------------------- CONSTRUCTORS, DESTRUCTOR
 //! --------------------------------------------------------------------------
@@ -25,94 +93,219 @@ loaded(false)
 
 int Texture::load(const char* filepath)
 {
+  return load(hashid::intern(filepath), filepath);
+}
+
+int Texture::load(hashid_t id, const char* filepath)
+{
+  STATS_TIME("texture.load");
+
   // Free any previous content
   if(loaded)
     unload();
 
-  // Load the image using SDL_image
-  SDL_Surface* surface = IMG_Load(filepath);
+  // Block-compressed textures skip SDL_image entirely
+  if(compressed::is_compressed(filepath))
+  {
+    compressed::image_t image;
+    ASSERT(compressed::read(filepath, image) == EXIT_SUCCESS,
+           "Opening compressed texture file");
+    return this->from_compressed(image);
+  }
+
+  // Previously decoded images go straight from the disk cache to GL
+  if(texture_cache::load(id, filepath, *this) == EXIT_SUCCESS)
+  {
+    hotreload::track(id, *this);
+    return EXIT_SUCCESS;
+  }
+
+  // Load the image using SDL_image, from the asset pack if it has it
+  SDL_Surface* surface = IMG_Load_RW(pack::open_rw(id, filepath), 1);
 
   ASSERT_SDL(surface, "Opening image file");
 
-  // continue working from this surface
-  int result = this->from_surface(surface);
+  // continue working from this surface, padded to powers of 2
+  SDL_Surface* padded = enlarge(surface);
+  int result = this->from_pixels(padded->pixels, padded->w, padded->h,
+                                 padded->format->BytesPerPixel);
+
+  // Save the work done for next time
+  if(result == EXIT_SUCCESS)
+  {
+    texture_cache::store(id, filepath, padded->pixels,
+                         padded->pitch*padded->h, padded->w, padded->h,
+                         padded->format->BytesPerPixel);
+    hotreload::track(id, *this);
+  }
 
   // Be sure to delete the bitmap from CPU memory before returning the result!
+  if(padded != surface)
+    SDL_FreeSurface(padded);
   SDL_FreeSurface(surface);
 
   return result;
 }
 
 int Texture::from_surface(SDL_Surface* surface)
+{
+  // Make sure the image length and width are powers of 2
+  SDL_Surface* padded = enlarge(surface);
+
+  int result = this->from_pixels(padded->pixels, padded->w, padded->h,
+                                 padded->format->BytesPerPixel);
+
+  if(padded != surface)
+    SDL_FreeSurface(padded);
+  return result;
+}
+
+int Texture::from_pixels(const void* pixels, int w, int h, int n_colours)
 {
   // Free any previous content
   if(loaded)
     unload();
 
   // Local variables for extracting properties about the image
-  GLuint n_colours = 0;
-  GLenum format = (GLenum) NULL;
-
-  // Make sure the image length and width are powers of 2
-	area = iRect(0, 0,
-                ISPWR2(surface->w) ? surface->w : nextpwr2(surface->w),
-                ISPWR2(surface->h) ? surface->h : nextpwr2(surface->h));
-  if(area.w != surface->w || area.h != surface->h)
-  {
-    // enlarge the surface if needed
-    SDL_Surface* previous_surface = surface;
-    // NB - Hexadecimal parameters are: Rmask, Gmask, Bmask and Amask
-    surface = SDL_CreateRGBSurface(0, area.w, area.h, 32,
-                                0x00ff0000, 0x0000ff00, 0x000000ff, 0xff000000);
-    // past contents of previous (small) surface onto new (larger) surface
-    SDL_BlitSurface(previous_surface, 0, surface, 0);
-  }
-
-  //get number of channels in the SDL surface
-  n_colours = surface->format->BytesPerPixel;
-  switch(n_colours)
-  {
-      case 1: format = GL_LUMINANCE;          break;
-      case 2: format = GL_LUMINANCE_ALPHA;    break;
-      case 3: format = GL_RGB;                break;
-      case 4: format = GL_RGBA;               break;
-      default:
-        log(LOG_ERROR, "Load texture failed : %d colours Image must be LUMINANCE, RGB or RGBA");
-        return EXIT_FAILURE;
-       break;
-  }
+  GLenum format = pixel_format(n_colours);
+  if(!format)
+    return EXIT_FAILURE;
+  area = iRect(0, 0, w, h);
 
   // Request an OpenGL unassigned GLuint to identify this texture
   glGenTextures(1, &handle);
 
   // Bind the texture object to the current block
-  glBindTexture(GL_TEXTURE_2D, handle);
+  glstate::bind_texture(handle);
 
   // Set the texture’s properties
-  glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-  glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-  glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-  glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+  set_parameters();
 
   // Finally: convert the image to a texture
   glTexImage2D(GL_TEXTURE_2D, 0, n_colours, area.w, area.h, 0,
-                  format, GL_UNSIGNED_BYTE, surface->pixels);
+                  format, GL_UNSIGNED_BYTE, pixels);
+  stats::count("texture.upload.kb", area.w*area.h*n_colours/1024.0);
+  vram::add(handle, vram::estimate(area.w, area.h, n_colours), area.w, area.h);
 
   // Unbind the texture
-  glBindTexture(GL_TEXTURE_2D, 0);
+  glstate::bind_texture(0);
 
   // The return result reports the success of the operation
   loaded = true;
   return EXIT_SUCCESS;
 }
 
+int Texture::reload(SDL_Surface* surface)
+{
+  if(!loaded)
+    WARN_RTN("Texture::reload()", "Texture is not loaded!", EXIT_FAILURE);
+
+  // Every copy of this texture has its own area: it can't change
+  SDL_Surface* padded = enlarge(surface);
+  int n_colours = padded->format->BytesPerPixel;
+  GLenum format = pixel_format(n_colours);
+  int result = EXIT_FAILURE;
+  if(padded->w != area.w || padded->h != area.h)
+  {
+    WARN("Texture::reload()", "Size changed, restart to see the new image")
+  }
+  else if(format)
+  {
+    // Same handle, new pixels: whoever holds the texture draws them
+    glstate::bind_texture(handle);
+    glTexImage2D(GL_TEXTURE_2D, 0, n_colours, area.w, area.h, 0,
+                 format, GL_UNSIGNED_BYTE, padded->pixels);
+    glstate::bind_texture(0);
+    stats::count("texture.upload.kb", area.w*area.h*n_colours/1024.0);
+    vram::remove(handle);
+    vram::add(handle, vram::estimate(area.w, area.h, n_colours),
+              area.w, area.h);
+    result = EXIT_SUCCESS;
+  }
+
+  if(padded != surface)
+    SDL_FreeSurface(padded);
+  return result;
+}
+
+int Texture::from_compressed(const compressed::image_t& image)
+{
+  // Free any previous content
+  if(loaded)
+    unload();
+
+  // The converter pads to powers of 2, but check anyway
+  if(!ISPWR2(image.w) || !ISPWR2(image.h))
+    WARN_RTN("Texture::from_compressed()", "Size must be a power of 2",
+             EXIT_FAILURE);
+  area = iRect(0, 0, image.w, image.h);
+
+  // Can the driver take the blocks as they are?
+  GLenum format = 0;
+  switch(image.format)
+  {
+    case compressed::BC1:
+      if(extensions::s3tc)
+        format = GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+    break;
+    case compressed::BC3:
+      if(extensions::s3tc)
+        format = GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+    break;
+    case compressed::ETC1:
+      if(extensions::etc1)
+        format = extensions::etc1_format;
+    break;
+  }
+
+  // Request an OpenGL unassigned GLuint to identify this texture
+  glGenTextures(1, &handle);
+  glstate::bind_texture(handle);
+  set_parameters();
+
+  if(format)
+  {
+    // Upload the blocks directly: they stay compressed in video memory
+    extensions::CompressedTexImage2D(GL_TEXTURE_2D, 0, format,
+                                     area.w, area.h, 0,
+                                     image.data.size(), &image.data[0]);
+    stats::count("texture.upload.kb", image.data.size()/1024.0);
+    vram::add(handle, image.data.size(), area.w, area.h);
+  }
+  else
+  {
+    // Otherwise decompress on the CPU and upload plain RGBA
+    HEAP_SCOPE(heap::GRAPHICS);
+    vector<unsigned char> rgba(area.w*area.h*4);
+    {
+      STATS_TIME("texture.decompress");
+      compressed::decode(image, &rgba[0]);
+    }
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, area.w, area.h, 0,
+                  GL_RGBA, GL_UNSIGNED_BYTE, &rgba[0]);
+    stats::count("texture.upload.kb", rgba.size()/1024.0);
+    vram::add(handle, rgba.size(), area.w, area.h);
+  }
+
+  // Unbind the texture
+  glstate::bind_texture(0);
+
+  loaded = true;
+  return EXIT_SUCCESS;
+}
+
 int Texture::unload()
 {
   if(!loaded)
     WARN_RTN("Texture::unload()", "Texture is not loaded!", EXIT_SUCCESS);
 
-  // Free the texture from video memory
-  glDeleteTextures(1, &handle);
+  // Don't free the texture from video memory mid-frame: other draws may
+  // still be queued on it. collect() does it at the end of the frame.
+  {
+    lock_guard<mutex> lock(unloaded_mutex);
+    unloaded.push_back(handle);
+  }
+  loaded = false;
 
   // Success !
   return EXIT_SUCCESS;
@@ -121,12 +314,34 @@ int Texture::unload()
 Texture::~Texture()
 {
   // don't force unload here: this may not be the only copy of the handle!
+  // (vram::report lists the handles nobody unloaded)
+}
+
+void Texture::collect()
+{
+  lock_guard<mutex> lock(unloaded_mutex);
+  if(unloaded.empty())
+    return;
+
+  for(size_t i = 0; i < unloaded.size(); i++)
+    hotreload::forget(unloaded[i]);
+  glDeleteTextures(unloaded.size(), &unloaded[0]);
+  glstate::deleted_textures(unloaded.size(), &unloaded[0]);
+  for(size_t i = 0; i < unloaded.size(); i++)
+    vram::remove(unloaded[i]);
+  stats::count("texture.deleted", unloaded.size());
+  unloaded.clear();
 }
 
 //! --------------------------------------------------------------------------
 //! -------------------------- ACCESSORS
 //! --------------------------------------------------------------------------
 
+bool Texture::isLoaded() const
+{
+  return loaded;
+}
+
 iRect Texture::getArea() const
 {
   return area;
@@ -139,8 +354,6 @@ GLuint Texture::getHandle() const
 
 void Texture::draw(const fRect* src_ptr, const fRect* dst_ptr, float angle)
 {
-  glPushMatrix();
-
   // Crop the source rectangle if necessary
   fRect src(area);
   if(src_ptr) // if no source is given the full texture is used!
@@ -151,35 +364,40 @@ void Texture::draw(const fRect* src_ptr, const fRect* dst_ptr, float angle)
   if(dst_ptr) // if no destination is given the full viewport is used!
     dst = (*dst_ptr);
 
-  // Set up position, rotation, colour
-  glTranslatef(global::scale.x*(dst.x + dst.w/2),
-                global::scale.y*(dst.y + dst.h/2), 0.0);
-  glRotatef(angle, 0.0, 0.0, 1.0);
-  glScalef(global::scale.x, global::scale.y, 0.0f);
-
   // Bind the texture to which subsequent calls refer to
-  glBindTexture(GL_TEXTURE_2D, handle);
+  glstate::bind_texture(handle);
 
-  // Tell graphics hardware what to expect
-  glEnableClientState(GL_VERTEX_ARRAY);
-  glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+  // Tell graphics hardware what to expect (this stays enabled)
+  glstate::enable_client_state(GL_VERTEX_ARRAY);
+  glstate::enable_client_state(GL_TEXTURE_COORD_ARRAY);
 
-  // Set up the polygon in which we'll draw
+  // Set up the polygon in which we'll draw, rotated around its centre here
+  // rather than by pushing a matrix (the camera has set up the rest)
   GLfloat
-  min_x = -dst.w/2,
-  min_y = -dst.h/2,
-  max_x = -min_x,
-  max_y = -min_y;
-  GLfloat polygon[8]  =   {min_x, min_y,      // Top-left
-                          max_x,  min_y,      // Top-right
-                          min_x,  max_y,      // Bottom-left
-                          max_x,  max_y };    // Bottom-right
+  half_w = dst.w/2,
+  half_h = dst.h/2,
+  centre_x = dst.x + half_w,
+  centre_y = dst.y + half_h,
+  c = 1.0f,
+  s = 0.0f;
+  if(angle)
+  {
+    c = cos(DEG2RAD(angle));
+    s = sin(DEG2RAD(angle));
+  }
+  GLfloat ux = half_w*c, uy = half_w*s,   // half of the top edge
+          vx = -half_h*s, vy = half_h*c;  // half of the left edge
+  GLfloat polygon[8]  =   {centre_x - ux - vx, centre_y - uy - vy,  // Top-left
+                          centre_x + ux - vx, centre_y + uy - vy,   // Top-right
+                          centre_x - ux + vx, centre_y - uy + vy,   // Bottom-left
+                          centre_x + ux + vx, centre_y + uy + vy }; // Bottom-right
   glVertexPointer(2, GL_FLOAT, 0, polygon);
 
   // Set up the binding of the skin (texture) to this polygon
-  min_x = src.x/area.w;
-  min_y = src.y/area.h;
-  max_x = (src.x + src.w)/area.w;
+  GLfloat
+  min_x = src.x/area.w,
+  min_y = src.y/area.h,
+  max_x = (src.x + src.w)/area.w,
   max_y = (src.y + src.h)/area.h;
   GLfloat skin[8]     =    {min_x, min_y,      // Top-left
                             max_x,  min_y,      // Top-right
@@ -189,12 +407,4 @@ void Texture::draw(const fRect* src_ptr, const fRect* dst_ptr, float angle)
 
   // Draw everything (finally)!
   glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
-
-  // Stop drawing texture
-  glDisableClientState(GL_VERTEX_ARRAY);
-  glDisableClientState(GL_TEXTURE_COORD_ARRAY);
-
-  // Reset back to normal
-  glPopMatrix();
-  glBindTexture(GL_TEXTURE_2D, 0);
 }
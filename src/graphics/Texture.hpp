@@ -24,11 +24,13 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "opengl.h"         // Needed for GLuint
 #include "../math/V2.hpp"      // Needed for iV2
 #include "../math/Rect.hpp"    // Needed for iRect
+#include "compressed.h"        // Needed for compressed::image_t
+#include "../hashid.h"         // Needed for hashid_t
 
 class Texture
 {
   /// ATTRIBUTES
-private:
+protected:
   GLuint handle;
   bool loaded;
   iRect area; // size of the texture
@@ -38,10 +40,18 @@ public:
   // constructors, destructors
   Texture();
   int load(const char* filename);
+  int load(hashid_t id, const char* filename);  // id: "assets/..."_id
   int from_surface(SDL_Surface* surface);
+  int from_pixels(const void* pixels, int w, int h, int n_colours);
+  int from_compressed(const compressed::image_t& image);
+  // new pixels for the same handle (and size): every copy sees them
+  int reload(SDL_Surface* surface);
   int unload();
   ~Texture();
+  // release unloaded handles, call at the end of each frame
+  static void collect();
   // accessors
+  bool isLoaded() const;
   iRect getArea() const;
   GLuint getHandle() const;
   void draw(const fRect* source_pointer,
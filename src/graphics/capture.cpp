@@ -0,0 +1,440 @@
+//! --------------------------------------------------------------------------
+//! -------------------------- INCLUDES
+//! --------------------------------------------------------------------------
+
+#include "capture.h"
+
+#include <cstdlib>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+#include <zlib.h>                   // Needed for deflate and crc32
+
+#include "opengl.h"
+#include "extensions.h"             // Needed for pixel buffer objects
+#include "../io/filesystem.h"
+#include "../events/events.h"
+#include "../memory/heap.h"
+#include "../debug/assert.h"
+#include "../debug/warn.h"
+#include "../debug/stats.h"
+
+using namespace std;
+
+//! --------------------------------------------------------------------------
+//! -------------------------- WORKSPACE
+//! --------------------------------------------------------------------------
+
+namespace
+{
+  struct frame_t
+  {
+    unsigned int number;
+    capture::format_t format;
+    vector<unsigned char> pixels;   // RGBA, rows bottom-up as read
+  };
+
+  struct slot_t
+  {
+    GLuint buffer;
+    bool full;
+    unsigned int number;
+    capture::format_t format;
+  };
+
+  static iV2 size;
+  static size_t frame_bytes = 0;
+  static unsigned long session = 0;  // keeps runs from overwriting each other
+  static bool started = false;
+
+  // render thread only
+  static slot_t slots[CAPTURE_BUFFERS];
+  static int slot = 0;
+  static unsigned int frame_number = 0;
+  static bool shoot = false, filming = false;
+  static capture::format_t shoot_format = capture::PNG,
+                           film_format = capture::PNG;
+
+  // shared with the workers, protected by the mutex
+  static mutex frames_mutex;
+  static condition_variable wake;
+  static bool running = false;
+  static deque<frame_t*> queued;
+  static vector<frame_t*> spare;    // recycled to avoid reallocating
+  static vector<thread> workers;
+
+  // ------------------------------------------------------------------------
+  // PNG ENCODING
+  // ------------------------------------------------------------------------
+
+  void put_u32(unsigned char* out, uint32_t value)
+  {
+    out[0] = value >> 24;
+    out[1] = value >> 16;
+    out[2] = value >> 8;
+    out[3] = value;
+  }
+
+  int write_chunk(FILE* file, const char* type, const unsigned char* data,
+                  uint32_t length)
+  {
+    unsigned char word[4];
+    put_u32(word, length);
+    uLong crc = crc32(0, (const Bytef*)type, 4);
+    if(length)
+      crc = crc32(crc, data, length);
+
+    if(fwrite(word, 4, 1, file) != 1 || fwrite(type, 4, 1, file) != 1
+    || (length && fwrite(data, length, 1, file) != 1))
+      return EXIT_FAILURE;
+    put_u32(word, crc);
+    return (fwrite(word, 4, 1, file) == 1) ? EXIT_SUCCESS : EXIT_FAILURE;
+  }
+
+  // RGBA rows bottom-up to RGB rows top-down, each behind a PNG filter byte
+  // (0, none: filtering compresses better but costs more time than we have)
+  void to_scanlines(const frame_t* frame, vector<unsigned char>& out,
+                    bool filter_bytes)
+  {
+    size_t row = size.x*3 + (filter_bytes ? 1 : 0);
+    out.resize(row*size.y);
+    for(int y = 0; y < size.y; y++)
+    {
+      const unsigned char* src = &frame->pixels[(size.y - 1 - y)*size.x*4];
+      unsigned char* dst = &out[y*row];
+      if(filter_bytes)
+        *(dst++) = 0;
+      for(int x = 0; x < size.x; x++, src += 4, dst += 3)
+      {
+        dst[0] = src[0];
+        dst[1] = src[1];
+        dst[2] = src[2];
+      }
+    }
+  }
+
+  int write_png(const char* filepath, const frame_t* frame)
+  {
+    static const unsigned char signature[8] =
+      { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+
+    // Fastest compression: the point is to keep up with the game
+    vector<unsigned char> scanlines, compressed;
+    to_scanlines(frame, scanlines, true);
+    uLongf compressed_size = compressBound(scanlines.size());
+    compressed.resize(compressed_size);
+    if(compress2(&compressed[0], &compressed_size, &scanlines[0],
+                 scanlines.size(), Z_BEST_SPEED) != Z_OK)
+      WARN_RTN("Compressing capture", filepath, EXIT_FAILURE);
+
+    // 8-bit truecolour, no interlacing
+    unsigned char header[13];
+    put_u32(header, size.x);
+    put_u32(header + 4, size.y);
+    header[8] = 8;
+    header[9] = 2;
+    header[10] = header[11] = header[12] = 0;
+
+    FILE* file = fopen(filepath, "wb");
+    if(!file)
+      WARN_RTN("Opening capture file", filepath, EXIT_FAILURE);
+    bool ok = fwrite(signature, sizeof(signature), 1, file) == 1
+      && write_chunk(file, "IHDR", header, sizeof(header)) == EXIT_SUCCESS
+      && write_chunk(file, "IDAT", &compressed[0], compressed_size)
+           == EXIT_SUCCESS
+      && write_chunk(file, "IEND", nullptr, 0) == EXIT_SUCCESS;
+    ok = (fclose(file) == 0) && ok;
+    if(!ok)
+      WARN_RTN("Writing capture file", filepath, EXIT_FAILURE);
+
+    return EXIT_SUCCESS;
+  }
+
+  int write_raw(const char* filepath, const frame_t* frame)
+  {
+    vector<unsigned char> scanlines;
+    to_scanlines(frame, scanlines, false);
+
+    FILE* file = fopen(filepath, "wb");
+    if(!file)
+      WARN_RTN("Opening capture file", filepath, EXIT_FAILURE);
+    bool ok = fwrite(&scanlines[0], scanlines.size(), 1, file) == 1;
+    ok = (fclose(file) == 0) && ok;
+    if(!ok)
+      WARN_RTN("Writing capture file", filepath, EXIT_FAILURE);
+
+    return EXIT_SUCCESS;
+  }
+
+  // ------------------------------------------------------------------------
+  // WORKERS
+  // ------------------------------------------------------------------------
+
+  void work()
+  {
+    HEAP_SCOPE(heap::CAPTURE);
+    while(true)
+    {
+      frame_t* frame;
+      {
+        unique_lock<mutex> lock(frames_mutex);
+        wake.wait(lock, []() { return !running || !queued.empty(); });
+        if(queued.empty())
+          break;
+        frame = queued.front();
+        queued.pop_front();
+      }
+
+      {
+        STATS_TIME("capture.encode");
+        capture::saved_t saved;
+        saved.number = frame->number;
+        saved.format = frame->format;
+        if(frame->format == capture::PNG)
+        {
+          snprintf(saved.filepath, sizeof(saved.filepath),
+                   CAPTURE_DIR "/%lu_%06u.png", session, frame->number);
+          saved.result = write_png(saved.filepath, frame);
+        }
+        else
+        {
+          snprintf(saved.filepath, sizeof(saved.filepath),
+                   CAPTURE_DIR "/%lu_%06u.rgb", session, frame->number);
+          saved.result = write_raw(saved.filepath, frame);
+        }
+        events::publish(events::CAPTURE_SAVED, saved);
+      }
+
+      lock_guard<mutex> lock(frames_mutex);
+      spare.push_back(frame);
+    }
+  }
+
+  // Returns null if the workers are too far behind: drop the frame
+  frame_t* get_frame()
+  {
+    lock_guard<mutex> lock(frames_mutex);
+    if(queued.size() >= CAPTURE_MAX_QUEUED)
+      return nullptr;
+    if(spare.empty())
+      return new frame_t();
+    frame_t* frame = spare.back();
+    spare.pop_back();
+    return frame;
+  }
+
+  void queue_frame(frame_t* frame)
+  {
+    {
+      lock_guard<mutex> lock(frames_mutex);
+      queued.push_back(frame);
+    }
+    wake.notify_one();
+  }
+
+  // Copy a slot's pixels out to the workers now that the GPU is done
+  void collect(slot_t& s)
+  {
+    HEAP_SCOPE(heap::CAPTURE);
+    s.full = false;
+    frame_t* frame = get_frame();
+    if(!frame)
+    {
+      stats::count("capture.dropped");
+      return;
+    }
+    frame->number = s.number;
+    frame->format = s.format;
+    frame->pixels.resize(frame_bytes);
+
+    STATS_TIME("capture.map");
+    extensions::BindBuffer(GL_PIXEL_PACK_BUFFER, s.buffer);
+    const void* mapped = extensions::MapBuffer(GL_PIXEL_PACK_BUFFER,
+                                               GL_READ_ONLY);
+    if(mapped)
+    {
+      memcpy(&frame->pixels[0], mapped, frame_bytes);
+      extensions::UnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    }
+    extensions::BindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    if(mapped)
+      queue_frame(frame);
+    else
+    {
+      lock_guard<mutex> lock(frames_mutex);
+      spare.push_back(frame);
+    }
+  }
+}
+
+//! --------------------------------------------------------------------------
+//! -------------------------- INTERFACE
+//! --------------------------------------------------------------------------
+
+namespace capture
+{
+  int start(iV2 _size)
+  {
+    if(started)
+      return EXIT_SUCCESS;
+
+    size = _size;
+    frame_bytes = size.x*size.y*4;
+    session = (unsigned long)time(NULL);
+    ASSERT(filesystem::make_directory(CAPTURE_DIR) == EXIT_SUCCESS,
+           "Creating capture directory");
+
+    // Without pixel buffers glReadPixels will block: still works, slowly
+    for(int i = 0; i < CAPTURE_BUFFERS; i++)
+    {
+      slots[i].buffer = 0;
+      slots[i].full = false;
+    }
+    if(extensions::pbo)
+    {
+      GLuint buffers[CAPTURE_BUFFERS];
+      extensions::GenBuffers(CAPTURE_BUFFERS, buffers);
+      for(int i = 0; i < CAPTURE_BUFFERS; i++)
+      {
+        slots[i].buffer = buffers[i];
+        extensions::BindBuffer(GL_PIXEL_PACK_BUFFER, buffers[i]);
+        extensions::BufferData(GL_PIXEL_PACK_BUFFER, frame_bytes, nullptr,
+                               GL_STREAM_READ);
+      }
+      extensions::BindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    }
+    else
+      WARN("Capturing frames", "No pixel buffer objects: will stall");
+
+    running = true;
+    for(int i = 0; i < CAPTURE_THREADS; i++)
+      workers.push_back(thread(work));
+
+    started = true;
+    return EXIT_SUCCESS;
+  }
+
+  int stop()
+  {
+    if(!started)
+      return EXIT_SUCCESS;
+
+    // Collect what's still on the GPU
+    filming = shoot = false;
+    for(int i = 0; i < CAPTURE_BUFFERS; i++)
+    {
+      slot = (slot + 1) % CAPTURE_BUFFERS;
+      if(slots[slot].full)
+        collect(slots[slot]);
+    }
+
+    // Let the workers finish the queue
+    {
+      lock_guard<mutex> lock(frames_mutex);
+      running = false;
+    }
+    wake.notify_all();
+    for(size_t i = 0; i < workers.size(); i++)
+      workers[i].join();
+    workers.clear();
+
+    for(size_t i = 0; i < spare.size(); i++)
+      delete spare[i];
+    spare.clear();
+
+    if(slots[0].buffer)
+    {
+      GLuint buffers[CAPTURE_BUFFERS];
+      for(int i = 0; i < CAPTURE_BUFFERS; i++)
+        buffers[i] = slots[i].buffer;
+      extensions::DeleteBuffers(CAPTURE_BUFFERS, buffers);
+    }
+
+    started = false;
+    return EXIT_SUCCESS;
+  }
+
+  void screenshot(format_t format)
+  {
+    shoot = true;
+    shoot_format = format;
+  }
+
+  void record(bool on, format_t format)
+  {
+    filming = on;
+    film_format = format;
+  }
+
+  bool recording()
+  {
+    return filming;
+  }
+
+  bool busy()
+  {
+    if(shoot || filming)
+      return true;
+    for(int i = 0; i < CAPTURE_BUFFERS; i++)
+      if(slots[i].full)
+        return true;
+    return false;
+  }
+
+  void frame()
+  {
+    if(!started)
+      return;
+
+    frame_number++;
+
+    // The oldest slot was read CAPTURE_BUFFERS - 1 frames ago: by now the
+    // copy should be finished, so mapping it won't wait on the GPU
+    slot = (slot + 1) % CAPTURE_BUFFERS;
+    if(slots[slot].full)
+      collect(slots[slot]);
+
+    if(!shoot && !filming)
+      return;
+    slot_t& s = slots[slot];
+    s.number = frame_number;
+    s.format = filming ? film_format : shoot_format;
+    shoot = false;
+
+    STATS_TIME("capture.read");
+    glReadBuffer(GL_BACK);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    if(s.buffer)
+    {
+      // Asynchronous: returns as soon as the copy is queued
+      extensions::BindBuffer(GL_PIXEL_PACK_BUFFER, s.buffer);
+      glReadPixels(0, 0, size.x, size.y, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+      extensions::BindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+      s.full = true;
+    }
+    else
+    {
+      HEAP_SCOPE(heap::CAPTURE);
+      frame_t* frame = get_frame();
+      if(!frame)
+      {
+        stats::count("capture.dropped");
+        return;
+      }
+      frame->number = s.number;
+      frame->format = s.format;
+      frame->pixels.resize(frame_bytes);
+      glReadPixels(0, 0, size.x, size.y, GL_RGBA, GL_UNSIGNED_BYTE,
+                   &frame->pixels[0]);
+      queue_frame(frame);
+    }
+    stats::count("capture.frames");
+  }
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include "../math/V2.hpp"
+
+// Screenshots and frame recording without stalling the render thread: the
+// back buffer is read into a ring of pixel buffer objects and only mapped
+// a couple of frames later, once the GPU is done with it, then encoded and
+// written to disk by worker threads. Frames the workers can't keep up with
+// are dropped rather than slowing the game down. Each file written is
+// announced from its worker with an events::CAPTURE_SAVED event.
+
+#define CAPTURE_DIR "capture"
+#define CAPTURE_BUFFERS 3         // frames between reading and mapping
+#define CAPTURE_THREADS 2
+#define CAPTURE_MAX_QUEUED 8      // frames waiting for a worker
+
+namespace capture
+{
+  enum format_t
+  {
+    PNG,    // compressed, one .png per frame
+    RAW     // one headerless .rgb per frame: rows top-down, 8-bit RGB
+  };
+
+  // payload of events::CAPTURE_SAVED
+  struct saved_t
+  {
+    unsigned int number;
+    format_t format;
+    int result;
+    char filepath[44];
+  };
+
+  // allocate buffers for a 'size' back buffer and start the workers: call
+  // from the render thread while its context is current
+  int start(iV2 size);
+
+  // finish writing queued frames and release everything
+  int stop();
+
+  // save the next frame
+  void screenshot(format_t format = PNG);
+
+  // save every frame until told to stop
+  void record(bool on, format_t format = PNG);
+  bool recording();
+
+  // are frames still waiting to be read back? (keep drawing if so)
+  bool busy();
+
+  // call once the frame is drawn, before the buffers are swapped
+  void frame();
+}
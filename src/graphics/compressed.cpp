@@ -0,0 +1,592 @@
+//! --------------------------------------------------------------------------
+//! -------------------------- INCLUDES
+//! --------------------------------------------------------------------------
+
+#include "compressed.h"
+
+#include <cstdlib>
+#include <cstdio>
+#include <cstring>
+#include <climits>
+#include <cmath>
+
+#include "../debug/warn.h"
+
+using namespace std;
+
+//! --------------------------------------------------------------------------
+//! -------------------------- COMMON
+//! --------------------------------------------------------------------------
+
+namespace
+{
+  typedef unsigned char pixel_t[4];
+
+  inline int clamp255(int v)
+  {
+    return (v < 0) ? 0 : ((v > 255) ? 255 : v);
+  }
+
+  inline int distance2(const unsigned char* a, const unsigned char* b)
+  {
+    int dr = a[0] - b[0], dg = a[1] - b[1], db = a[2] - b[2];
+    return dr*dr + dg*dg + db*db;
+  }
+
+  // copy a 4x4 block out of an RGBA image
+  void fetch_block(const unsigned char* rgba, int w, int bx, int by,
+                   pixel_t block[16])
+  {
+    for(int y = 0; y < 4; y++)
+      memcpy(block[y*4], rgba + ((by*4 + y)*w + bx*4)*4, 16);
+  }
+
+  // copy a 4x4 block back into an RGBA image
+  void store_block(unsigned char* rgba, int w, int bx, int by,
+                   const pixel_t block[16])
+  {
+    for(int y = 0; y < 4; y++)
+      memcpy(rgba + ((by*4 + y)*w + bx*4)*4, block[y*4], 16);
+  }
+}
+
+//! --------------------------------------------------------------------------
+//! -------------------------- BC1 / BC3
+//! --------------------------------------------------------------------------
+
+namespace
+{
+  inline uint16_t pack565(const float c[3])
+  {
+    int r = clamp255((int)(c[0] + 0.5f)),
+        g = clamp255((int)(c[1] + 0.5f)),
+        b = clamp255((int)(c[2] + 0.5f));
+    return (uint16_t)(((r * 31 + 127) / 255) << 11
+                    | ((g * 63 + 127) / 255) << 5
+                    | ((b * 31 + 127) / 255));
+  }
+
+  inline void unpack565(uint16_t c, unsigned char* out)
+  {
+    int r = (c >> 11) & 31, g = (c >> 5) & 63, b = c & 31;
+    out[0] = (unsigned char)((r << 3) | (r >> 2));
+    out[1] = (unsigned char)((g << 2) | (g >> 4));
+    out[2] = (unsigned char)((b << 3) | (b >> 2));
+    out[3] = 255;
+  }
+
+  void bc_palette(uint16_t c0, uint16_t c1, bool four_colours,
+                  pixel_t palette[4])
+  {
+    unpack565(c0, palette[0]);
+    unpack565(c1, palette[1]);
+    if(four_colours || c0 > c1)
+    {
+      for(int i = 0; i < 3; i++)
+      {
+        palette[2][i] = (unsigned char)((2*palette[0][i] + palette[1][i])/3);
+        palette[3][i] = (unsigned char)((palette[0][i] + 2*palette[1][i])/3);
+      }
+      palette[2][3] = palette[3][3] = 255;
+    }
+    else
+    {
+      for(int i = 0; i < 3; i++)
+      {
+        palette[2][i] = (unsigned char)((palette[0][i] + palette[1][i])/2);
+        palette[3][i] = 0;
+      }
+      palette[2][3] = 255;
+      palette[3][3] = 0; // transparent black
+    }
+  }
+
+  // Endpoints are the extremes of the block along its principal axis, found
+  // with a few rounds of power iteration on the colour covariance.
+  void encode_colour_block(const pixel_t block[16], unsigned char* out)
+  {
+    float mean[3] = { 0, 0, 0 };
+    for(int p = 0; p < 16; p++)
+      for(int i = 0; i < 3; i++)
+        mean[i] += block[p][i] / 16.0f;
+
+    float cov[6] = { 0, 0, 0, 0, 0, 0 }; // rr rg rb gg gb bb
+    for(int p = 0; p < 16; p++)
+    {
+      float r = block[p][0] - mean[0],
+            g = block[p][1] - mean[1],
+            b = block[p][2] - mean[2];
+      cov[0] += r*r; cov[1] += r*g; cov[2] += r*b;
+      cov[3] += g*g; cov[4] += g*b; cov[5] += b*b;
+    }
+
+    float axis[3] = { 1, 1, 1 };
+    for(int k = 0; k < 4; k++)
+    {
+      float x = cov[0]*axis[0] + cov[1]*axis[1] + cov[2]*axis[2],
+            y = cov[1]*axis[0] + cov[3]*axis[1] + cov[4]*axis[2],
+            z = cov[2]*axis[0] + cov[4]*axis[1] + cov[5]*axis[2];
+      float m = fabsf(x) > fabsf(y) ? fabsf(x) : fabsf(y);
+      if(fabsf(z) > m)
+        m = fabsf(z);
+      if(m < 1e-6f)
+        break; // flat block: keep the previous axis
+      axis[0] = x/m; axis[1] = y/m; axis[2] = z/m;
+    }
+
+    float lo = 1e30f, hi = -1e30f;
+    for(int p = 0; p < 16; p++)
+    {
+      float d = (block[p][0] - mean[0])*axis[0]
+              + (block[p][1] - mean[1])*axis[1]
+              + (block[p][2] - mean[2])*axis[2];
+      if(d < lo) lo = d;
+      if(d > hi) hi = d;
+    }
+    float norm2 = axis[0]*axis[0] + axis[1]*axis[1] + axis[2]*axis[2];
+    float c_max[3], c_min[3];
+    for(int i = 0; i < 3; i++)
+    {
+      c_max[i] = mean[i] + axis[i]*hi/norm2;
+      c_min[i] = mean[i] + axis[i]*lo/norm2;
+    }
+
+    uint16_t c0 = pack565(c_max), c1 = pack565(c_min);
+    if(c0 < c1)
+    {
+      uint16_t swap = c0; c0 = c1; c1 = swap;
+    }
+
+    uint32_t indices = 0;
+    if(c0 != c1)
+    {
+      pixel_t palette[4];
+      bc_palette(c0, c1, true, palette);
+      for(int p = 0; p < 16; p++)
+      {
+        int best = 0, best_d = INT_MAX;
+        for(int i = 0; i < 4; i++)
+        {
+          int d = distance2(block[p], palette[i]);
+          if(d < best_d)
+          {
+            best_d = d;
+            best = i;
+          }
+        }
+        indices |= (uint32_t)best << (2*p);
+      }
+    }
+
+    out[0] = c0 & 0xff; out[1] = c0 >> 8;
+    out[2] = c1 & 0xff; out[3] = c1 >> 8;
+    for(int i = 0; i < 4; i++)
+      out[4 + i] = (indices >> (8*i)) & 0xff;
+  }
+
+  void decode_colour_block(const unsigned char* in, bool four_colours,
+                           pixel_t block[16])
+  {
+    uint16_t c0 = in[0] | (in[1] << 8), c1 = in[2] | (in[3] << 8);
+    uint32_t indices = in[4] | (in[5] << 8) | (in[6] << 16)
+                     | ((uint32_t)in[7] << 24);
+    pixel_t palette[4];
+    bc_palette(c0, c1, four_colours, palette);
+    for(int p = 0; p < 16; p++)
+      memcpy(block[p], palette[(indices >> (2*p)) & 3], 4);
+  }
+
+  void alpha_palette(int a0, int a1, int palette[8])
+  {
+    palette[0] = a0;
+    palette[1] = a1;
+    if(a0 > a1)
+      for(int i = 1; i < 7; i++)
+        palette[i + 1] = ((7 - i)*a0 + i*a1)/7;
+    else
+    {
+      for(int i = 1; i < 5; i++)
+        palette[i + 1] = ((5 - i)*a0 + i*a1)/5;
+      palette[6] = 0;
+      palette[7] = 255;
+    }
+  }
+
+  void encode_alpha_block(const pixel_t block[16], unsigned char* out)
+  {
+    int a0 = 0, a1 = 255;
+    for(int p = 0; p < 16; p++)
+    {
+      if(block[p][3] > a0) a0 = block[p][3];
+      if(block[p][3] < a1) a1 = block[p][3];
+    }
+
+    uint64_t indices = 0;
+    if(a0 != a1)
+    {
+      int palette[8];
+      alpha_palette(a0, a1, palette);
+      for(int p = 0; p < 16; p++)
+      {
+        int best = 0, best_d = INT_MAX;
+        for(int i = 0; i < 8; i++)
+        {
+          int d = abs(block[p][3] - palette[i]);
+          if(d < best_d)
+          {
+            best_d = d;
+            best = i;
+          }
+        }
+        indices |= (uint64_t)best << (3*p);
+      }
+    }
+
+    out[0] = (unsigned char)a0;
+    out[1] = (unsigned char)a1;
+    for(int i = 0; i < 6; i++)
+      out[2 + i] = (indices >> (8*i)) & 0xff;
+  }
+
+  void decode_alpha_block(const unsigned char* in, pixel_t block[16])
+  {
+    int palette[8];
+    alpha_palette(in[0], in[1], palette);
+    uint64_t indices = 0;
+    for(int i = 0; i < 6; i++)
+      indices |= (uint64_t)in[2 + i] << (8*i);
+    for(int p = 0; p < 16; p++)
+      block[p][3] = (unsigned char)palette[(indices >> (3*p)) & 7];
+  }
+}
+
+//! --------------------------------------------------------------------------
+//! -------------------------- ETC1
+//! --------------------------------------------------------------------------
+
+namespace
+{
+  static const int ETC_MODIFIERS[8][2] =
+  {
+    { 2, 8 }, { 5, 17 }, { 9, 29 }, { 13, 42 },
+    { 18, 60 }, { 24, 80 }, { 33, 106 }, { 47, 183 }
+  };
+
+  // index bits are (msb, lsb): 0 = +small, 1 = +large, 2 = -small, 3 = -large
+  inline int etc_modifier(int table, int index)
+  {
+    int m = ETC_MODIFIERS[table][index & 1];
+    return (index & 2) ? -m : m;
+  }
+
+  // which half of the block does pixel (x, y) belong to?
+  inline int etc_half(int x, int y, bool flip)
+  {
+    return flip ? (y >= 2) : (x >= 2);
+  }
+
+  // choose the best table for one half and return its error
+  int etc_fit_half(const pixel_t block[16], bool flip, int half,
+                   const int base[3], int& table, int indices[16])
+  {
+    int best_error = INT_MAX;
+    for(int t = 0; t < 8; t++)
+    {
+      int error = 0, chosen[16];
+      for(int p = 0; p < 16; p++)
+      {
+        if(etc_half(p % 4, p / 4, flip) != half)
+          continue;
+        int best_d = INT_MAX;
+        for(int i = 0; i < 4; i++)
+        {
+          int m = etc_modifier(t, i);
+          unsigned char c[3] = { (unsigned char)clamp255(base[0] + m),
+                                 (unsigned char)clamp255(base[1] + m),
+                                 (unsigned char)clamp255(base[2] + m) };
+          int d = distance2(block[p], c);
+          if(d < best_d)
+          {
+            best_d = d;
+            chosen[p] = i;
+          }
+        }
+        error += best_d;
+      }
+      if(error < best_error)
+      {
+        best_error = error;
+        table = t;
+        for(int p = 0; p < 16; p++)
+          if(etc_half(p % 4, p / 4, flip) == half)
+            indices[p] = chosen[p];
+      }
+    }
+    return best_error;
+  }
+
+  int etc_encode_flip(const pixel_t block[16], bool flip, uint64_t& word)
+  {
+    // average colour of each half
+    float average[2][3] = { { 0, 0, 0 }, { 0, 0, 0 } };
+    for(int p = 0; p < 16; p++)
+      for(int i = 0; i < 3; i++)
+        average[etc_half(p % 4, p / 4, flip)][i] += block[p][i] / 8.0f;
+
+    // prefer differential mode (5 bits per channel) when it can express both
+    int q[2][3], base[2][3];
+    bool differential = true;
+    for(int h = 0; h < 2; h++)
+      for(int i = 0; i < 3; i++)
+        q[h][i] = (int)(average[h][i] * 31 / 255 + 0.5f);
+    for(int i = 0; i < 3; i++)
+      if(q[1][i] - q[0][i] < -4 || q[1][i] - q[0][i] > 3)
+        differential = false;
+
+    if(differential)
+    {
+      for(int h = 0; h < 2; h++)
+        for(int i = 0; i < 3; i++)
+          base[h][i] = (q[h][i] << 3) | (q[h][i] >> 2);
+    }
+    else
+    {
+      for(int h = 0; h < 2; h++)
+        for(int i = 0; i < 3; i++)
+        {
+          q[h][i] = (int)(average[h][i] * 15 / 255 + 0.5f);
+          base[h][i] = q[h][i] * 17;
+        }
+    }
+
+    int tables[2], indices[16];
+    int error = etc_fit_half(block, flip, 0, base[0], tables[0], indices)
+              + etc_fit_half(block, flip, 1, base[1], tables[1], indices);
+
+    word = 0;
+    if(differential)
+    {
+      for(int i = 0; i < 3; i++)
+      {
+        word |= (uint64_t)q[0][i] << (59 - 8*i);
+        word |= (uint64_t)((q[1][i] - q[0][i]) & 7) << (56 - 8*i);
+      }
+      word |= (uint64_t)1 << 33;
+    }
+    else
+    {
+      for(int i = 0; i < 3; i++)
+      {
+        word |= (uint64_t)q[0][i] << (60 - 8*i);
+        word |= (uint64_t)q[1][i] << (56 - 8*i);
+      }
+    }
+    word |= (uint64_t)tables[0] << 37;
+    word |= (uint64_t)tables[1] << 34;
+    if(flip)
+      word |= (uint64_t)1 << 32;
+
+    // pixel indices are stored column-major, most significant bits first
+    for(int p = 0; p < 16; p++)
+    {
+      int bit = (p % 4)*4 + p / 4;
+      word |= (uint64_t)(indices[p] >> 1) << (16 + bit);
+      word |= (uint64_t)(indices[p] & 1) << bit;
+    }
+    return error;
+  }
+
+  void encode_etc1_block(const pixel_t block[16], unsigned char* out)
+  {
+    uint64_t word, flipped;
+    if(etc_encode_flip(block, true, flipped)
+       < etc_encode_flip(block, false, word))
+      word = flipped;
+    for(int i = 0; i < 8; i++)
+      out[i] = (word >> (56 - 8*i)) & 0xff;
+  }
+
+  void decode_etc1_block(const unsigned char* in, pixel_t block[16])
+  {
+    uint64_t word = 0;
+    for(int i = 0; i < 8; i++)
+      word = (word << 8) | in[i];
+
+    int base[2][3];
+    if(word & ((uint64_t)1 << 33))
+    {
+      for(int i = 0; i < 3; i++)
+      {
+        int c = (word >> (59 - 8*i)) & 31;
+        int d = (word >> (56 - 8*i)) & 7;
+        int c2 = c + ((d >= 4) ? d - 8 : d);
+        base[0][i] = (c << 3) | (c >> 2);
+        base[1][i] = ((c2 & 31) << 3) | ((c2 & 31) >> 2);
+      }
+    }
+    else
+    {
+      for(int i = 0; i < 3; i++)
+      {
+        base[0][i] = ((word >> (60 - 8*i)) & 15) * 17;
+        base[1][i] = ((word >> (56 - 8*i)) & 15) * 17;
+      }
+    }
+    int tables[2] = { (int)((word >> 37) & 7), (int)((word >> 34) & 7) };
+    bool flip = (word >> 32) & 1;
+
+    for(int p = 0; p < 16; p++)
+    {
+      int x = p % 4, y = p / 4, bit = x*4 + y;
+      int index = (int)((((word >> (16 + bit)) & 1) << 1)
+                        | ((word >> bit) & 1));
+      int h = etc_half(x, y, flip);
+      int m = etc_modifier(tables[h], index);
+      for(int i = 0; i < 3; i++)
+        block[p][i] = (unsigned char)clamp255(base[h][i] + m);
+      block[p][3] = 255;
+    }
+  }
+}
+
+//! --------------------------------------------------------------------------
+//! -------------------------- INTERFACE
+//! --------------------------------------------------------------------------
+
+namespace compressed
+{
+  int block_size(format_t format)
+  {
+    return (format == BC3) ? 16 : 8;
+  }
+
+  int data_size(format_t format, int w, int h)
+  {
+    return (w/4) * (h/4) * block_size(format);
+  }
+
+  int encode(format_t format, const unsigned char* rgba, int w, int h,
+             image_t& result)
+  {
+    if(w % 4 || h % 4)
+      WARN_RTN("compressed::encode", "Size must be a multiple of 4",
+               EXIT_FAILURE);
+
+    result.format = format;
+    result.w = w;
+    result.h = h;
+    result.data.resize(data_size(format, w, h));
+
+    unsigned char* out = &result.data[0];
+    pixel_t block[16];
+    for(int by = 0; by < h/4; by++)
+      for(int bx = 0; bx < w/4; bx++)
+      {
+        fetch_block(rgba, w, bx, by, block);
+        switch(format)
+        {
+          case BC1:
+            encode_colour_block(block, out);
+          break;
+          case BC3:
+            encode_alpha_block(block, out);
+            encode_colour_block(block, out + 8);
+          break;
+          case ETC1:
+            encode_etc1_block(block, out);
+          break;
+        }
+        out += block_size(format);
+      }
+
+    return EXIT_SUCCESS;
+  }
+
+  int decode(const image_t& image, unsigned char* rgba)
+  {
+    if((int)image.data.size() < data_size(image.format, image.w, image.h))
+      WARN_RTN("compressed::decode", "Truncated block data", EXIT_FAILURE);
+
+    const unsigned char* in = &image.data[0];
+    pixel_t block[16];
+    for(int by = 0; by < image.h/4; by++)
+      for(int bx = 0; bx < image.w/4; bx++)
+      {
+        switch(image.format)
+        {
+          case BC1:
+            decode_colour_block(in, false, block);
+          break;
+          case BC3:
+            decode_colour_block(in + 8, true, block);
+            decode_alpha_block(in, block);
+          break;
+          case ETC1:
+            decode_etc1_block(in, block);
+          break;
+        }
+        store_block(rgba, image.w, bx, by, block);
+        in += block_size(image.format);
+      }
+
+    return EXIT_SUCCESS;
+  }
+
+  int read(const char* filepath, image_t& result)
+  {
+    FILE* file = fopen(filepath, "rb");
+    if(!file)
+      WARN_RTN("compressed::read", "Could not open file", EXIT_FAILURE);
+
+    header_t header;
+    bool valid = (fread(&header, sizeof(header), 1, file) == 1)
+              && !memcmp(header.magic, CTEX_MAGIC, 4)
+              && header.format >= BC1 && header.format <= ETC1
+              && header.width && header.height
+              && header.width <= CTEX_MAX_SIZE
+              && header.height <= CTEX_MAX_SIZE
+              && header.width % 4 == 0 && header.height % 4 == 0
+              && (int)header.size == data_size((format_t)header.format,
+                                                header.width, header.height);
+    if(valid)
+    {
+      result.format = (format_t)header.format;
+      result.w = header.width;
+      result.h = header.height;
+      result.data.resize(header.size);
+      valid = (fread(&result.data[0], 1, header.size, file) == header.size);
+    }
+    fclose(file);
+
+    if(!valid)
+      WARN_RTN("compressed::read", "Invalid or truncated file", EXIT_FAILURE);
+    return EXIT_SUCCESS;
+  }
+
+  int write(const char* filepath, const image_t& image)
+  {
+    FILE* file = fopen(filepath, "wb");
+    if(!file)
+      WARN_RTN("compressed::write", "Could not open file", EXIT_FAILURE);
+
+    header_t header;
+    memcpy(header.magic, CTEX_MAGIC, 4);
+    header.format = image.format;
+    header.width = image.w;
+    header.height = image.h;
+    header.size = image.data.size();
+    bool valid = (fwrite(&header, sizeof(header), 1, file) == 1)
+              && (fwrite(&image.data[0], 1, header.size, file) == header.size);
+    fclose(file);
+
+    if(!valid)
+      WARN_RTN("compressed::write", "Could not write file", EXIT_FAILURE);
+    return EXIT_SUCCESS;
+  }
+
+  bool is_compressed(const char* filepath)
+  {
+    size_t length = strlen(filepath), ext = strlen(CTEX_EXTENSION);
+    return (length > ext) && !strcmp(filepath + length - ext, CTEX_EXTENSION);
+  }
+}
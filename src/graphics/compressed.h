@@ -0,0 +1,58 @@
+#pragma once
+
+#include <vector>
+#include <stdint.h>
+
+// Block-compressed texture container (".ctex"), written offline by the
+// texconv tool and read by Texture::load. Every format stores 4x4 pixel
+// blocks, so width and height are always multiples of 4 (and powers of 2,
+// like every other texture in the engine). Data is little-endian.
+
+#define CTEX_EXTENSION ".ctex"
+#define CTEX_MAGIC "CTEX"
+// larger than any driver takes, and data_size would overflow
+#define CTEX_MAX_SIZE 16384
+
+namespace compressed
+{
+  enum format_t
+  {
+    BC1 = 1,    // a.k.a. DXT1: RGB, 4 bits per pixel
+    BC3 = 2,    // a.k.a. DXT5: RGBA, 8 bits per pixel
+    ETC1 = 3    // RGB, 4 bits per pixel, for GLES targets
+  };
+
+  struct header_t
+  {
+    char magic[4];
+    uint32_t format;
+    uint32_t width;
+    uint32_t height;
+    uint32_t size;    // number of bytes of block data following the header
+  };
+
+  struct image_t
+  {
+    format_t format;
+    int w, h;
+    std::vector<unsigned char> data;
+  };
+
+  // size of one 4x4 block in bytes
+  int block_size(format_t format);
+  // size of a whole image in bytes
+  int data_size(format_t format, int w, int h);
+
+  // rgba is tightly packed 8-bit RGBA, w and h must be multiples of 4
+  int encode(format_t format, const unsigned char* rgba, int w, int h,
+             image_t& result);
+  // rgba must have room for image.w * image.h * 4 bytes
+  int decode(const image_t& image, unsigned char* rgba);
+
+  // read or write a ".ctex" file
+  int read(const char* filepath, image_t& result);
+  int write(const char* filepath, const image_t& image);
+
+  // does this path name a ".ctex" file?
+  bool is_compressed(const char* filepath);
+}
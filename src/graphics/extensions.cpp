@@ -0,0 +1,136 @@
+#include "extensions.h"
+
+#include <cstdlib>
+
+#include "SDL.h"                    // Needed for SDL_GL_GetProcAddress
+
+#include "../debug/log.h"
+
+namespace extensions
+{
+  bool s3tc = false;
+  bool etc1 = false;
+  GLenum etc1_format = GL_ETC1_RGB8_OES;
+  bool sync = false;
+  bool fbo = false;
+  bool timer_query = false;
+  bool pbo = false;
+
+  PFNGLCOMPRESSEDTEXIMAGE2DPROC CompressedTexImage2D = nullptr;
+  PFNGLFENCESYNCPROC FenceSync = nullptr;
+  PFNGLCLIENTWAITSYNCPROC ClientWaitSync = nullptr;
+  PFNGLDELETESYNCPROC DeleteSync = nullptr;
+  PFNGLGENFRAMEBUFFERSPROC GenFramebuffers = nullptr;
+  PFNGLDELETEFRAMEBUFFERSPROC DeleteFramebuffers = nullptr;
+  PFNGLBINDFRAMEBUFFERPROC BindFramebuffer = nullptr;
+  PFNGLFRAMEBUFFERTEXTURE2DPROC FramebufferTexture2D = nullptr;
+  PFNGLCHECKFRAMEBUFFERSTATUSPROC CheckFramebufferStatus = nullptr;
+  PFNGLBLENDFUNCSEPARATEPROC BlendFuncSeparate = nullptr;
+  PFNGLUSEPROGRAMPROC UseProgram = nullptr;
+  PFNGLGENQUERIESPROC GenQueries = nullptr;
+  PFNGLDELETEQUERIESPROC DeleteQueries = nullptr;
+  PFNGLBEGINQUERYPROC BeginQuery = nullptr;
+  PFNGLENDQUERYPROC EndQuery = nullptr;
+  PFNGLGETQUERYOBJECTIVPROC GetQueryObjectiv = nullptr;
+  PFNGLGETQUERYOBJECTUI64VPROC GetQueryObjectui64v = nullptr;
+  PFNGLGENBUFFERSPROC GenBuffers = nullptr;
+  PFNGLDELETEBUFFERSPROC DeleteBuffers = nullptr;
+  PFNGLBINDBUFFERPROC BindBuffer = nullptr;
+  PFNGLBUFFERDATAPROC BufferData = nullptr;
+  PFNGLMAPBUFFERPROC MapBuffer = nullptr;
+  PFNGLUNMAPBUFFERPROC UnmapBuffer = nullptr;
+
+  namespace
+  {
+    // Core name first, then the EXT variant with the same signature
+    void* find(const char* core, const char* ext)
+    {
+      void* result = SDL_GL_GetProcAddress(core);
+      return result ? result : SDL_GL_GetProcAddress(ext);
+    }
+  }
+
+  int load()
+  {
+    CompressedTexImage2D = (PFNGLCOMPRESSEDTEXIMAGE2DPROC)
+      SDL_GL_GetProcAddress("glCompressedTexImage2D");
+
+    s3tc = CompressedTexImage2D
+      && SDL_GL_ExtensionSupported("GL_EXT_texture_compression_s3tc");
+    if(SDL_GL_ExtensionSupported("GL_OES_compressed_ETC1_RGB8_texture"))
+      etc1_format = GL_ETC1_RGB8_OES;
+    else if(SDL_GL_ExtensionSupported("GL_ARB_ES3_compatibility"))
+      etc1_format = GL_COMPRESSED_RGB8_ETC2;  // ETC2 decodes ETC1 as-is
+    else
+      etc1_format = 0;
+    etc1 = CompressedTexImage2D && etc1_format;
+
+    FenceSync = (PFNGLFENCESYNCPROC)
+      SDL_GL_GetProcAddress("glFenceSync");
+    ClientWaitSync = (PFNGLCLIENTWAITSYNCPROC)
+      SDL_GL_GetProcAddress("glClientWaitSync");
+    DeleteSync = (PFNGLDELETESYNCPROC)
+      SDL_GL_GetProcAddress("glDeleteSync");
+    sync = FenceSync && ClientWaitSync && DeleteSync;
+
+    GenFramebuffers = (PFNGLGENFRAMEBUFFERSPROC)
+      find("glGenFramebuffers", "glGenFramebuffersEXT");
+    DeleteFramebuffers = (PFNGLDELETEFRAMEBUFFERSPROC)
+      find("glDeleteFramebuffers", "glDeleteFramebuffersEXT");
+    BindFramebuffer = (PFNGLBINDFRAMEBUFFERPROC)
+      find("glBindFramebuffer", "glBindFramebufferEXT");
+    FramebufferTexture2D = (PFNGLFRAMEBUFFERTEXTURE2DPROC)
+      find("glFramebufferTexture2D", "glFramebufferTexture2DEXT");
+    CheckFramebufferStatus = (PFNGLCHECKFRAMEBUFFERSTATUSPROC)
+      find("glCheckFramebufferStatus", "glCheckFramebufferStatusEXT");
+    fbo = GenFramebuffers && DeleteFramebuffers && BindFramebuffer
+      && FramebufferTexture2D && CheckFramebufferStatus;
+
+    BlendFuncSeparate = (PFNGLBLENDFUNCSEPARATEPROC)
+      find("glBlendFuncSeparate", "glBlendFuncSeparateEXT");
+    UseProgram = (PFNGLUSEPROGRAMPROC)
+      SDL_GL_GetProcAddress("glUseProgram");
+
+    GenQueries = (PFNGLGENQUERIESPROC)
+      SDL_GL_GetProcAddress("glGenQueries");
+    DeleteQueries = (PFNGLDELETEQUERIESPROC)
+      SDL_GL_GetProcAddress("glDeleteQueries");
+    BeginQuery = (PFNGLBEGINQUERYPROC)
+      SDL_GL_GetProcAddress("glBeginQuery");
+    EndQuery = (PFNGLENDQUERYPROC)
+      SDL_GL_GetProcAddress("glEndQuery");
+    GetQueryObjectiv = (PFNGLGETQUERYOBJECTIVPROC)
+      SDL_GL_GetProcAddress("glGetQueryObjectiv");
+    GetQueryObjectui64v = (PFNGLGETQUERYOBJECTUI64VPROC)
+      SDL_GL_GetProcAddress("glGetQueryObjectui64v");
+    timer_query = GenQueries && DeleteQueries && BeginQuery && EndQuery
+      && GetQueryObjectiv && GetQueryObjectui64v
+      && SDL_GL_ExtensionSupported("GL_ARB_timer_query");
+
+    GenBuffers = (PFNGLGENBUFFERSPROC)
+      find("glGenBuffers", "glGenBuffersARB");
+    DeleteBuffers = (PFNGLDELETEBUFFERSPROC)
+      find("glDeleteBuffers", "glDeleteBuffersARB");
+    BindBuffer = (PFNGLBINDBUFFERPROC)
+      find("glBindBuffer", "glBindBufferARB");
+    BufferData = (PFNGLBUFFERDATAPROC)
+      find("glBufferData", "glBufferDataARB");
+    MapBuffer = (PFNGLMAPBUFFERPROC)
+      find("glMapBuffer", "glMapBufferARB");
+    UnmapBuffer = (PFNGLUNMAPBUFFERPROC)
+      find("glUnmapBuffer", "glUnmapBufferARB");
+    pbo = GenBuffers && DeleteBuffers && BindBuffer && BufferData
+      && MapBuffer && UnmapBuffer
+      && (SDL_GL_ExtensionSupported("GL_ARB_pixel_buffer_object")
+          || SDL_GL_ExtensionSupported("GL_EXT_pixel_buffer_object"));
+
+    log("Compressed textures: S3TC %s, ETC1 %s",
+        s3tc ? "yes" : "no", etc1 ? "yes" : "no");
+    log("Fences: %s, framebuffer objects: %s, timer queries: %s, "
+        "pixel buffers: %s", sync ? "yes" : "no", fbo ? "yes" : "no",
+        timer_query ? "yes" : "no", pbo ? "yes" : "no");
+
+    // Missing extensions are not fatal: there is always a fallback
+    return EXIT_SUCCESS;
+  }
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include "opengl.h"         // Needed for the PFNGL...PROC types
+
+// On Windows opengl32 only exports OpenGL 1.1, so anything newer has to be
+// fetched from the driver once a context is current.
+
+namespace extensions
+{
+  // fetch entry points and capabilities, call once the context is current
+  int load();
+
+  // capabilities
+  extern bool s3tc;   // BC1/BC3 uploads
+  extern bool etc1;   // ETC1 uploads (natively or through ETC2)
+  extern GLenum etc1_format;
+  extern bool sync;   // fences (ARB_sync or OpenGL 3.2)
+  extern bool fbo;    // framebuffer objects (ARB or EXT)
+  extern bool timer_query;  // GPU timing (ARB_timer_query)
+  extern bool pbo;    // pixel buffer objects (OpenGL 2.1 or ARB)
+
+  // entry points (null if unavailable)
+  extern PFNGLCOMPRESSEDTEXIMAGE2DPROC CompressedTexImage2D;
+  extern PFNGLFENCESYNCPROC FenceSync;
+  extern PFNGLCLIENTWAITSYNCPROC ClientWaitSync;
+  extern PFNGLDELETESYNCPROC DeleteSync;
+  extern PFNGLGENFRAMEBUFFERSPROC GenFramebuffers;
+  extern PFNGLDELETEFRAMEBUFFERSPROC DeleteFramebuffers;
+  extern PFNGLBINDFRAMEBUFFERPROC BindFramebuffer;
+  extern PFNGLFRAMEBUFFERTEXTURE2DPROC FramebufferTexture2D;
+  extern PFNGLCHECKFRAMEBUFFERSTATUSPROC CheckFramebufferStatus;
+  extern PFNGLBLENDFUNCSEPARATEPROC BlendFuncSeparate;
+  extern PFNGLUSEPROGRAMPROC UseProgram;
+  extern PFNGLGENQUERIESPROC GenQueries;
+  extern PFNGLDELETEQUERIESPROC DeleteQueries;
+  extern PFNGLBEGINQUERYPROC BeginQuery;
+  extern PFNGLENDQUERYPROC EndQuery;
+  extern PFNGLGETQUERYOBJECTIVPROC GetQueryObjectiv;
+  extern PFNGLGETQUERYOBJECTUI64VPROC GetQueryObjectui64v;
+  extern PFNGLGENBUFFERSPROC GenBuffers;
+  extern PFNGLDELETEBUFFERSPROC DeleteBuffers;
+  extern PFNGLBINDBUFFERPROC BindBuffer;
+  extern PFNGLBUFFERDATAPROC BufferData;
+  extern PFNGLMAPBUFFERPROC MapBuffer;
+  extern PFNGLUNMAPBUFFERPROC UnmapBuffer;
+}
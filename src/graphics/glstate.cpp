@@ -0,0 +1,256 @@
+//! --------------------------------------------------------------------------
+//! -------------------------- INCLUDES
+//! --------------------------------------------------------------------------
+
+#include "glstate.h"
+
+#include <cstring>
+
+#include "extensions.h"             // Needed for programs and framebuffers
+#include "../debug/stats.h"
+
+//! --------------------------------------------------------------------------
+//! -------------------------- WORKSPACE
+//! --------------------------------------------------------------------------
+
+#define UNKNOWN 0xffffffff
+
+namespace
+{
+  // Capabilities we track: anything else goes straight through
+  static const GLenum CAPABILITIES[] =
+  {
+    GL_TEXTURE_2D, GL_BLEND, GL_SCISSOR_TEST, GL_DEPTH_TEST, GL_CULL_FACE,
+    GL_VERTEX_ARRAY, GL_TEXTURE_COORD_ARRAY, GL_COLOR_ARRAY
+  };
+  #define N_CAPABILITIES (sizeof(CAPABILITIES)/sizeof(GLenum))
+
+  struct state_t
+  {
+    GLuint texture;
+    GLuint enabled[N_CAPABILITIES];   // 0, 1 or UNKNOWN
+    GLenum blend[4];
+    GLfloat clear[4];
+    bool clear_known;
+    GLint viewport[4];
+    bool viewport_known;
+    GLenum matrix_mode;
+    GLuint program;
+    GLuint framebuffer;
+    unsigned int issued, skipped;
+  };
+
+  // One per thread, like the contexts
+  static thread_local state_t state;
+  static thread_local bool initialised = false;
+
+  state_t& current()
+  {
+    if(!initialised)
+    {
+      glstate::invalidate();
+      initialised = true;
+    }
+    return state;
+  }
+
+  // returns true if the call needs to be issued
+  inline bool change(GLuint& shadow, GLuint value)
+  {
+    state_t& s = current();
+    if(shadow == value)
+    {
+      s.skipped++;
+      return false;
+    }
+    shadow = value;
+    s.issued++;
+    return true;
+  }
+
+  GLuint* find_capability(GLenum capability)
+  {
+    for(size_t i = 0; i < N_CAPABILITIES; i++)
+      if(CAPABILITIES[i] == capability)
+        return &current().enabled[i];
+    return nullptr;
+  }
+}
+
+//! --------------------------------------------------------------------------
+//! -------------------------- INTERFACE
+//! --------------------------------------------------------------------------
+
+namespace glstate
+{
+  void invalidate()
+  {
+    unsigned int issued = state.issued, skipped = state.skipped;
+    memset(&state, 0xff, sizeof(state));
+    state.clear_known = false;
+    state.viewport_known = false;
+    state.issued = issued;
+    state.skipped = skipped;
+  }
+
+  void bind_texture(GLuint handle)
+  {
+    if(change(current().texture, handle))
+      glBindTexture(GL_TEXTURE_2D, handle);
+  }
+
+  void deleted_textures(GLsizei n, const GLuint* handles)
+  {
+    // Deleting the bound texture binds 0 instead
+    state_t& s = current();
+    for(GLsizei i = 0; i < n; i++)
+      if(s.texture == handles[i])
+        s.texture = 0;
+  }
+
+  void enable(GLenum capability)
+  {
+    GLuint* shadow = find_capability(capability);
+    if(!shadow || change(*shadow, 1))
+      glEnable(capability);
+  }
+
+  void disable(GLenum capability)
+  {
+    GLuint* shadow = find_capability(capability);
+    if(!shadow || change(*shadow, 0))
+      glDisable(capability);
+  }
+
+  void enable_client_state(GLenum array)
+  {
+    GLuint* shadow = find_capability(array);
+    if(!shadow || change(*shadow, 1))
+      glEnableClientState(array);
+  }
+
+  void disable_client_state(GLenum array)
+  {
+    GLuint* shadow = find_capability(array);
+    if(!shadow || change(*shadow, 0))
+      glDisableClientState(array);
+  }
+
+  void blend_func(GLenum source, GLenum destination)
+  {
+    state_t& s = current();
+    if(s.blend[0] == source && s.blend[1] == destination
+    && s.blend[2] == source && s.blend[3] == destination)
+    {
+      s.skipped++;
+      return;
+    }
+    s.blend[0] = s.blend[2] = source;
+    s.blend[1] = s.blend[3] = destination;
+    s.issued++;
+    glBlendFunc(source, destination);
+  }
+
+  void blend_func_separate(GLenum source_rgb, GLenum destination_rgb,
+                           GLenum source_alpha, GLenum destination_alpha)
+  {
+    if(!extensions::BlendFuncSeparate)
+    {
+      blend_func(source_rgb, destination_rgb);
+      return;
+    }
+
+    state_t& s = current();
+    if(s.blend[0] == source_rgb && s.blend[1] == destination_rgb
+    && s.blend[2] == source_alpha && s.blend[3] == destination_alpha)
+    {
+      s.skipped++;
+      return;
+    }
+    s.blend[0] = source_rgb;
+    s.blend[1] = destination_rgb;
+    s.blend[2] = source_alpha;
+    s.blend[3] = destination_alpha;
+    s.issued++;
+    extensions::BlendFuncSeparate(source_rgb, destination_rgb,
+                                  source_alpha, destination_alpha);
+  }
+
+  void get_clear_colour(GLfloat colour[4])
+  {
+    state_t& s = current();
+    if(!s.clear_known)
+    {
+      glGetFloatv(GL_COLOR_CLEAR_VALUE, s.clear);
+      s.clear_known = true;
+    }
+    memcpy(colour, s.clear, sizeof(s.clear));
+  }
+
+  void get_viewport(GLint viewport[4])
+  {
+    state_t& s = current();
+    if(!s.viewport_known)
+    {
+      glGetIntegerv(GL_VIEWPORT, s.viewport);
+      s.viewport_known = true;
+    }
+    memcpy(viewport, s.viewport, sizeof(s.viewport));
+  }
+
+  void clear_colour(GLfloat r, GLfloat g, GLfloat b, GLfloat a)
+  {
+    state_t& s = current();
+    GLfloat colour[4] = { r, g, b, a };
+    if(s.clear_known && !memcmp(s.clear, colour, sizeof(colour)))
+    {
+      s.skipped++;
+      return;
+    }
+    memcpy(s.clear, colour, sizeof(colour));
+    s.clear_known = true;
+    s.issued++;
+    glClearColor(r, g, b, a);
+  }
+
+  void viewport(GLint x, GLint y, GLsizei w, GLsizei h)
+  {
+    state_t& s = current();
+    GLint area[4] = { x, y, w, h };
+    if(s.viewport_known && !memcmp(s.viewport, area, sizeof(area)))
+    {
+      s.skipped++;
+      return;
+    }
+    memcpy(s.viewport, area, sizeof(area));
+    s.viewport_known = true;
+    s.issued++;
+    glViewport(x, y, w, h);
+  }
+
+  void matrix_mode(GLenum mode)
+  {
+    if(change(current().matrix_mode, mode))
+      glMatrixMode(mode);
+  }
+
+  void use_program(GLuint program)
+  {
+    if(extensions::UseProgram && change(current().program, program))
+      extensions::UseProgram(program);
+  }
+
+  void bind_framebuffer(GLuint framebuffer)
+  {
+    if(extensions::fbo && change(current().framebuffer, framebuffer))
+      extensions::BindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+  }
+
+  void report()
+  {
+    state_t& s = current();
+    stats::count("gl.issued", s.issued);
+    stats::count("gl.skipped", s.skipped);
+    s.issued = s.skipped = 0;
+  }
+}
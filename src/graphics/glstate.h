@@ -0,0 +1,46 @@
+#pragma once
+
+#include "opengl.h"
+
+// Shadow copy of the OpenGL state we change most often. Every call compares
+// against what the current context already has and only reaches the driver
+// if something actually changes. Each thread keeps its own copy since each
+// thread has its own context (see uploader.h).
+//
+// Anything that changes this state behind our back must call invalidate().
+
+namespace glstate
+{
+  // forget everything: the next call of each kind is always issued
+  void invalidate();
+
+  // textures (unit 0)
+  void bind_texture(GLuint handle);
+  void deleted_textures(GLsizei n, const GLuint* handles);
+
+  // capabilities (glEnable/glDisable) and client-side arrays
+  void enable(GLenum capability);
+  void disable(GLenum capability);
+  void enable_client_state(GLenum array);
+  void disable_client_state(GLenum array);
+
+  // blending
+  void blend_func(GLenum source, GLenum destination);
+  void blend_func_separate(GLenum source_rgb, GLenum destination_rgb,
+                           GLenum source_alpha, GLenum destination_alpha);
+
+  // what the context has, to put it back afterwards: from the shadow copy,
+  // only asked of the driver if it doesn't know (once after invalidate())
+  void get_clear_colour(GLfloat colour[4]);
+  void get_viewport(GLint viewport[4]);
+
+  // everything else
+  void clear_colour(GLfloat r, GLfloat g, GLfloat b, GLfloat a);
+  void viewport(GLint x, GLint y, GLsizei w, GLsizei h);
+  void matrix_mode(GLenum mode);
+  void use_program(GLuint program);
+  void bind_framebuffer(GLuint framebuffer);
+
+  // publish issued/skipped counts to stats and reset them, once per frame
+  void report();
+}
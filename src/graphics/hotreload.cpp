@@ -0,0 +1,220 @@
+//! --------------------------------------------------------------------------
+//! -------------------------- INCLUDES
+//! --------------------------------------------------------------------------
+
+#include "hotreload.h"
+
+#if HOT_RELOAD
+
+#include <cstring>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <thread>
+#include <mutex>
+#include <atomic>
+
+#include "SDL.h"
+#include "SDL_image.h"
+
+#include "Texture.hpp"
+#include "../io/watcher.h"
+#include "../hashid.h"
+#include "../memory/heap.h"
+#include "../debug/log.h"
+#include "../debug/warn.h"
+#include "../debug/stats.h"
+
+using namespace std;
+
+//! --------------------------------------------------------------------------
+//! -------------------------- CONSTANTS
+//! --------------------------------------------------------------------------
+
+// how long the watcher waits before checking whether it should stop
+#define RELOAD_POLL_MS 50
+
+//! --------------------------------------------------------------------------
+//! -------------------------- WORKSPACE
+//! --------------------------------------------------------------------------
+
+namespace
+{
+  struct decoded_t
+  {
+    hashid_t id;
+    string filepath;
+    SDL_Surface* surface;
+    double detected;    // stats::now() when the change was noticed
+  };
+
+  static thread decoder;
+  static atomic<bool> running(false);
+  static Uint32 wake_event = (Uint32)-1;
+
+  // shared with the decoding thread, protected by the mutex
+  static mutex reload_mutex;
+  static unordered_map<hashid_t, vector<Texture> > tracked;
+  static vector<decoded_t> decoded;
+
+  bool is_tracked(hashid_t id)
+  {
+    lock_guard<mutex> lock(reload_mutex);
+    return (tracked.find(id) != tracked.end());
+  }
+
+  void work()
+  {
+    HEAP_SCOPE(heap::GRAPHICS);
+
+    vector<string> changed;
+    while(running)
+    {
+      changed.clear();
+      if(!watcher::wait(changed, RELOAD_POLL_MS))
+        continue;
+      double detected = stats::now();
+
+      // Only decode what's actually on screen somewhere
+      bool any = false;
+      for(size_t i = 0; i < changed.size(); i++)
+      {
+        hashid_t id = hashid::hash(changed[i].c_str());
+        if(!is_tracked(id))
+          continue;
+
+        SDL_Surface* surface;
+        {
+          STATS_TIME("hotreload.decode");
+          surface = IMG_Load(changed[i].c_str());
+        }
+        if(!surface)
+        {
+          log(LOG_WARN, "Reloading %s : %s", changed[i].c_str(),
+              SDL_GetError());
+          continue;
+        }
+
+        decoded_t result = { id, changed[i], surface, detected };
+        lock_guard<mutex> lock(reload_mutex);
+        decoded.push_back(result);
+        any = true;
+      }
+
+      // Don't leave the render thread asleep waiting for input
+      if(any && wake_event != (Uint32)-1)
+      {
+        SDL_Event event;
+        memset(&event, 0, sizeof(event));
+        event.type = wake_event;
+        SDL_PushEvent(&event);
+      }
+    }
+  }
+}
+
+//! --------------------------------------------------------------------------
+//! -------------------------- INTERFACE
+//! --------------------------------------------------------------------------
+
+namespace hotreload
+{
+  int start(const char* directory)
+  {
+    if(running)
+      return EXIT_SUCCESS;
+
+    if(watcher::start(directory) != EXIT_SUCCESS)
+      return EXIT_FAILURE;
+
+    wake_event = SDL_RegisterEvents(1);
+    running = true;
+    decoder = thread(work);
+    return EXIT_SUCCESS;
+  }
+
+  int stop()
+  {
+    if(!running)
+      return EXIT_SUCCESS;
+
+    running = false;
+    decoder.join();
+    watcher::stop();
+
+    lock_guard<mutex> lock(reload_mutex);
+    for(size_t i = 0; i < decoded.size(); i++)
+      SDL_FreeSurface(decoded[i].surface);
+    decoded.clear();
+    tracked.clear();
+    return EXIT_SUCCESS;
+  }
+
+  void track(hashid_t id, const Texture& texture)
+  {
+    HEAP_SCOPE(heap::GRAPHICS);
+    lock_guard<mutex> lock(reload_mutex);
+    tracked[id].push_back(texture);
+  }
+
+  void forget(unsigned int handle)
+  {
+    lock_guard<mutex> lock(reload_mutex);
+    for(unordered_map<hashid_t, vector<Texture> >::iterator i =
+          tracked.begin();
+        i != tracked.end(); )
+    {
+      vector<Texture>& textures = i->second;
+      for(size_t t = 0; t < textures.size(); )
+        if(textures[t].getHandle() == handle)
+        {
+          textures[t] = textures.back();
+          textures.pop_back();
+        }
+        else
+          t++;
+
+      if(textures.empty())
+        tracked.erase(i++);
+      else
+        i++;
+    }
+  }
+
+  bool update()
+  {
+    vector<decoded_t> ready;
+    vector<Texture> targets;
+    {
+      lock_guard<mutex> lock(reload_mutex);
+      if(decoded.empty())
+        return false;
+      ready.swap(decoded);
+    }
+
+    for(size_t i = 0; i < ready.size(); i++)
+    {
+      // The same image may have been loaded into several handles
+      {
+        lock_guard<mutex> lock(reload_mutex);
+        unordered_map<hashid_t, vector<Texture> >::iterator found =
+          tracked.find(ready[i].id);
+        if(found != tracked.end())
+          targets = found->second;
+        else
+          targets.clear();
+      }
+      for(size_t t = 0; t < targets.size(); t++)
+        targets[t].reload(ready[i].surface);
+      SDL_FreeSurface(ready[i].surface);
+
+      double latency = stats::now() - ready[i].detected;
+      stats::time("hotreload.latency", latency);
+      stats::count("hotreload.reloaded");
+      log("Reloaded %s (%.1f ms)", ready[i].filepath.c_str(), latency);
+    }
+    return true;
+  }
+}
+
+#endif // HOT_RELOAD
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstdlib>
+
+#include "../global.hpp"            // Needed for HOT_RELOAD
+
+#include "../hashid.h"
+
+class Texture;
+
+// Reloads textures while the game runs when their image is saved. A watcher
+// thread notices the change and decodes the new image; the render thread
+// then uploads it into the existing handle, so every copy of the Texture
+// sees it without looking anything up again. The image has to keep its
+// (padded) size: holders have their own copy of the area.
+//
+// With HOT_RELOAD at 0 all of this compiles down to nothing.
+
+namespace hotreload
+{
+#if HOT_RELOAD
+
+  // watch the files below 'directory' and start the decoding thread
+  int start(const char* directory);
+
+  // stop watching and decoding
+  int stop();
+
+  // reload 'texture' whenever the file with this id changes (any thread)
+  void track(hashid_t id, const Texture& texture);
+
+  // the handle is about to be deleted: stop reloading into it
+  void forget(unsigned int handle);
+
+  // upload what was decoded since last time, call once per frame on the
+  // render thread: true if anything was reloaded
+  bool update();
+
+#else
+
+  inline int start(const char*) { return EXIT_SUCCESS; }
+  inline int stop() { return EXIT_SUCCESS; }
+  inline void track(hashid_t, const Texture&) {}
+  inline void forget(unsigned int) {}
+  inline bool update() { return false; }
+
+#endif
+}
@@ -9,4 +9,18 @@
 #define GL_V_MINOR 0
 
 #include <GL/gl.h>          // PC uses OpenGL rather than OpenGL ES
+#include <GL/glext.h>       // entry points beyond 1.1, see extensions.h
 
+// Compressed formats, in case the headers are too old to know them
+#ifndef GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+  #define GL_COMPRESSED_RGB_S3TC_DXT1_EXT 0x83F0
+#endif
+#ifndef GL_COMPRESSED_RGBA_S3TC_DXT5_EXT
+  #define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT 0x83F3
+#endif
+#ifndef GL_ETC1_RGB8_OES
+  #define GL_ETC1_RGB8_OES 0x8D64
+#endif
+#ifndef GL_COMPRESSED_RGB8_ETC2
+  #define GL_COMPRESSED_RGB8_ETC2 0x9274
+#endif
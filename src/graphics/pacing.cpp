@@ -0,0 +1,209 @@
+//! --------------------------------------------------------------------------
+//! -------------------------- INCLUDES
+//! --------------------------------------------------------------------------
+
+#include "pacing.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <thread>
+
+#include "../debug/log.h"
+#include "../debug/warn.h"
+#include "../debug/stats.h"
+
+using namespace std;
+
+//! --------------------------------------------------------------------------
+//! -------------------------- WORKSPACE
+//! --------------------------------------------------------------------------
+
+// V-sync that lets this many frames in a row through faster than the target
+// isn't really there (forced off by the driver, say): limit them ourselves
+#define PACING_SUSPICIOUS_FRAMES 30
+
+namespace
+{
+  static pacing::vsync_t vsync_mode = pacing::VSYNC_OFF;
+  static double target_ms = 0, background_ms = 0;
+  static bool limit = true, focused = true;
+
+  static double deadline = 0;        // when the next frame is due
+  static double last_present = 0;    // 0 if the last frame doesn't count
+  static float spin_ms = PACING_SPIN_MS;
+  static int too_fast = 0;
+
+  static pacing::histogram_t jitter;
+
+  void measure(double now)
+  {
+    if(last_present <= 0)
+      return;
+
+    double interval = now - last_present;
+    double expected = focused ? target_ms : background_ms;
+    float error = (float)fabs(interval - expected);
+    stats::set("pacing.interval.ms", interval);
+    stats::set("pacing.jitter.ms", error);
+
+    int bin = (int)(error/PACING_BIN_MS);
+    jitter.bins[(bin < PACING_BINS) ? bin : PACING_BINS - 1]++;
+    jitter.frames++;
+    if(error > jitter.worst_ms)
+      jitter.worst_ms = error;
+
+    // Catch v-sync that isn't doing anything
+    if(!limit && interval < expected*0.9)
+    {
+      if(++too_fast >= PACING_SUSPICIOUS_FRAMES)
+      {
+        WARN("Pacing frames", "V-sync isn't holding, limiting instead");
+        limit = true;
+      }
+    }
+    else
+      too_fast = 0;
+  }
+}
+
+//! --------------------------------------------------------------------------
+//! -------------------------- INTERFACE
+//! --------------------------------------------------------------------------
+
+namespace pacing
+{
+  vsync_t start(SDL_Window* window, int fps, vsync_t vsync)
+  {
+    memset(&jitter, 0, sizeof(jitter));
+    target_ms = 1000.0/fps;
+    background_ms = 1000.0/PACING_BACKGROUND_FPS;
+    deadline = last_present = 0;
+    too_fast = 0;
+
+    // Adaptive first, then plain, then nothing
+    vsync_mode = VSYNC_OFF;
+    if(vsync == VSYNC_ADAPTIVE && SDL_GL_SetSwapInterval(-1) == 0)
+      vsync_mode = VSYNC_ADAPTIVE;
+    else if(vsync != VSYNC_OFF && SDL_GL_SetSwapInterval(1) == 0)
+      vsync_mode = VSYNC_ON;
+    else
+      SDL_GL_SetSwapInterval(0);
+    WARN_IF(vsync_mode != vsync, "Setting swap interval", SDL_GetError());
+
+    // V-sync is enough unless the display goes faster than we want
+    SDL_DisplayMode mode;
+    int refresh = (SDL_GetWindowDisplayMode(window, &mode) == 0)
+                ? mode.refresh_rate : 0;
+    limit = (vsync_mode == VSYNC_OFF || refresh <= 0 || refresh > fps + 1);
+
+    static const char* names[] = { "off", "on", "adaptive" };
+    log("Pacing to %d fps: v-sync %s, display at %d Hz, limiter %s", fps,
+        names[vsync_mode], refresh, limit ? "on" : "off");
+    return vsync_mode;
+  }
+
+  void focus(bool _focused)
+  {
+    // Catch up straight away rather than finish a long background wait
+    if(_focused != focused)
+    {
+      deadline = 0;
+      last_present = 0;
+    }
+    focused = _focused;
+  }
+
+  void wait()
+  {
+    double now = stats::now();
+    double interval = focused ? target_ms : background_ms;
+
+    if(focused && !limit)
+    {
+      // The swap did the waiting
+      measure(now);
+      last_present = now;
+      return;
+    }
+
+    // Aim for a steady rhythm rather than 'interval' after whenever we got
+    // here, but don't try to make up for frames that were too long
+    deadline += interval;
+    if(deadline < now || deadline > now + interval)
+      deadline = now;
+
+    // Sleep through most of it...
+    double remaining = deadline - now;
+    if(remaining > spin_ms)
+    {
+      double slept = stats::now();
+      SDL_Delay((Uint32)(remaining - spin_ms));
+      now = stats::now();
+      stats::time("pacing.sleep", now - slept);
+
+      // Overslept: spin longer next time; otherwise creep back
+      if(now > deadline)
+        spin_ms = (spin_ms + 0.5f < PACING_MAX_SPIN_MS)
+                ? spin_ms + 0.5f : PACING_MAX_SPIN_MS;
+      else if(spin_ms > PACING_SPIN_MS)
+        spin_ms -= 0.01f;
+    }
+
+    // ... then spin the rest
+    double spun = now;
+    while(now < deadline)
+    {
+      this_thread::yield();
+      now = stats::now();
+    }
+    stats::time("pacing.spin", now - spun);
+
+    measure(now);
+    last_present = now;
+  }
+
+  void idle()
+  {
+    last_present = 0;
+    deadline = 0;
+  }
+
+  vsync_t vsync()
+  {
+    return vsync_mode;
+  }
+
+  bool limiting()
+  {
+    return limit || !focused;
+  }
+
+  const histogram_t& histogram()
+  {
+    return jitter;
+  }
+
+  void report()
+  {
+    if(!jitter.frames)
+      return;
+
+    log("Frame pacing jitter over %u frames (worst %.2f ms):", jitter.frames,
+        jitter.worst_ms);
+    for(int i = 0; i < PACING_BINS; i++)
+    {
+      if(!jitter.bins[i])
+        continue;
+      char bar[41];
+      int length = (int)(40.0*jitter.bins[i]/jitter.frames + 0.5);
+      memset(bar, '#', length);
+      bar[length] = '\0';
+      if(i < PACING_BINS - 1)
+        log("  %5.2f-%5.2f ms %6u %s", i*PACING_BIN_MS, (i + 1)*PACING_BIN_MS,
+            jitter.bins[i], bar);
+      else
+        log("  %5.2f+      ms %6u %s", i*PACING_BIN_MS, jitter.bins[i], bar);
+    }
+  }
+}
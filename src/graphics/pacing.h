@@ -0,0 +1,57 @@
+#pragma once
+
+#include "SDL.h"                    // Needed for SDL_Window
+
+// Frame pacing: v-sync when the driver has it (adaptive if possible, so a
+// late frame tears instead of waiting a whole refresh), and a limiter for
+// when it doesn't or when the display refreshes faster than we want to draw.
+// The limiter sleeps for most of the wait, which is cheap but coarse, then
+// spins for the last PACING_SPIN_MS or so, which is precise. Without focus
+// the game drops to PACING_BACKGROUND_FPS whatever the v-sync.
+//
+// Every interval between presented frames is measured, and how far it was
+// from the target (the jitter) goes into a histogram.
+
+#define PACING_SPIN_MS 1.5f         // start spinning this long before the end
+#define PACING_MAX_SPIN_MS 4.0f     // ... more if sleeps keep overshooting
+#define PACING_BACKGROUND_FPS 10
+#define PACING_BINS 32
+#define PACING_BIN_MS 0.25f         // the last bin takes everything beyond
+
+namespace pacing
+{
+  enum vsync_t
+  {
+    VSYNC_OFF,
+    VSYNC_ON,
+    VSYNC_ADAPTIVE
+  };
+
+  struct histogram_t
+  {
+    unsigned int bins[PACING_BINS];
+    unsigned int frames;
+    float worst_ms;
+  };
+
+  // ask for 'vsync', falling back to what's available, and pace to 'fps':
+  // call with the window's context current
+  vsync_t start(SDL_Window* window, int fps, vsync_t vsync = VSYNC_ADAPTIVE);
+
+  // throttle down while the window doesn't have focus
+  void focus(bool focused);
+
+  // call once the frame has been presented: wait until the next one is due
+  void wait();
+
+  // call instead when no frame was drawn: the next interval doesn't count
+  void idle();
+
+  // what we got, and how well it's going
+  vsync_t vsync();
+  bool limiting();
+  const histogram_t& histogram();
+
+  // write the histogram to the log
+  void report();
+}
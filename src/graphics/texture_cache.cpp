@@ -0,0 +1,230 @@
+//! --------------------------------------------------------------------------
+//! -------------------------- INCLUDES
+//! --------------------------------------------------------------------------
+
+#include "texture_cache.h"
+
+#include <cstdlib>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+#include "Texture.hpp"
+#include "../io/MappedFile.hpp"
+#include "../io/filesystem.h"
+#include "../io/pack.h"
+#include "../hashid.h"
+#include "../debug/warn.h"
+#include "../debug/stats.h"
+
+using namespace std;
+
+//! --------------------------------------------------------------------------
+//! -------------------------- CONSTANTS
+//! --------------------------------------------------------------------------
+
+#define CACHE_MAGIC "TXCH"
+#define CACHE_VERSION 1
+// pixel data starts on a page boundary so the mapping can feed GL directly
+#define CACHE_ALIGN 4096
+
+//! --------------------------------------------------------------------------
+//! -------------------------- UTILITIES
+//! --------------------------------------------------------------------------
+
+namespace
+{
+  struct header_t
+  {
+    char magic[4];
+    uint32_t version;
+    int64_t mtime;          // source modification time
+    uint64_t source_size;   // source size in bytes
+    uint64_t content_hash;  // hashid::hash of the source bytes
+    uint32_t w, h, n_colours;
+    uint32_t offset;        // of the pixel data from the start of the file
+    uint64_t size;          // of the pixel data
+  };
+
+  // What glTexImage2D reads for these pixels, 0 if they make no sense: rows
+  // are 4-byte aligned (GL_UNPACK_ALIGNMENT), as SDL lays them out too
+  uint64_t pixels_size(uint32_t w, uint32_t h, uint32_t n_colours)
+  {
+    if(!w || !h || !n_colours || n_colours > 4)
+      return 0;
+    return (((uint64_t)w*n_colours + 3) & ~(uint64_t)3) * h;
+  }
+
+  // Packed sources have no time of their own: their content decides
+  int source_status(const string& loose, const pack::entry_t* packed,
+                    int64_t& mtime, uint64_t& size)
+  {
+    if(!packed)
+      return filesystem::status(loose.c_str(), mtime, size);
+    mtime = 0;
+    size = packed->original_size;
+    return EXIT_SUCCESS;
+  }
+
+  // The pack tool hashed its entries already: only loose files are read
+  int hash_file(const string& loose, const pack::entry_t* packed,
+                uint64_t& hash)
+  {
+    if(packed)
+    {
+      hash = packed->content_hash;
+      return EXIT_SUCCESS;
+    }
+
+    MappedFile source;
+    if(source.open(loose.c_str()) != EXIT_SUCCESS)
+      return EXIT_FAILURE;
+    hash = hashid::hash(source.getData(), source.getSize());
+    return EXIT_SUCCESS;
+  }
+
+  // One file per source, named after the hash of its path
+  string cache_path(hashid_t id)
+  {
+    char name[17];
+    snprintf(name, sizeof(name), "%016llx", (unsigned long long)id);
+    return string(TEXTURE_CACHE_DIR) + "/" + name + ".raw";
+  }
+
+  // The source was touched but kept its content: remember the new time
+  void refresh(const string& path, int64_t mtime, uint64_t source_size)
+  {
+    FILE* file = fopen(path.c_str(), "r+b");
+    if(!file)
+      return;
+    header_t header;
+    if(fread(&header, sizeof(header), 1, file) == 1)
+    {
+      header.mtime = mtime;
+      header.source_size = source_size;
+      rewind(file);
+      fwrite(&header, sizeof(header), 1, file);
+    }
+    fclose(file);
+  }
+}
+
+//! --------------------------------------------------------------------------
+//! -------------------------- INTERFACE
+//! --------------------------------------------------------------------------
+
+namespace texture_cache
+{
+  int load(hashid_t id, const char* filepath, Texture& texture)
+  {
+    int64_t mtime, cached_mtime;
+    uint64_t source_size, cached_size;
+    const pack::entry_t* packed = pack::find(id);
+    string path = cache_path(id), source = packed ? "" : pack::loose(filepath);
+
+    // No source or no entry: nothing to do (quietly, this is the cold path)
+    if(source_status(source, packed, mtime, source_size) != EXIT_SUCCESS
+    || filesystem::status(path.c_str(), cached_mtime, cached_size)
+        != EXIT_SUCCESS)
+    {
+      stats::count("texture.cache.miss");
+      return EXIT_FAILURE;
+    }
+
+    MappedFile cache;
+    if(cache.open(path.c_str()) != EXIT_SUCCESS)
+      return EXIT_FAILURE;
+
+    header_t header;
+    if(cache.getSize() < sizeof(header))
+      WARN_RTN("texture_cache::load", "Truncated cache entry", EXIT_FAILURE);
+    memcpy(&header, cache.getData(), sizeof(header));
+    if(memcmp(header.magic, CACHE_MAGIC, 4)
+    || header.version != CACHE_VERSION
+    || header.offset > cache.getSize()
+    || header.size > cache.getSize() - header.offset
+    || header.size != pixels_size(header.w, header.h, header.n_colours))
+      WARN_RTN("texture_cache::load", "Invalid cache entry", EXIT_FAILURE);
+
+    // Only hash a loose source if it looks different; packed ones come
+    // with their hash, and no time to go by
+    bool touched = (header.mtime != mtime
+                    || header.source_size != source_size);
+    if(touched || packed)
+    {
+      uint64_t hash;
+      if(hash_file(source, packed, hash) != EXIT_SUCCESS
+      || hash != header.content_hash)
+      {
+        stats::count("texture.cache.stale");
+        return EXIT_FAILURE;
+      }
+    }
+
+    // Upload directly from the mapped pages: no intermediate copy
+    int result = texture.from_pixels(cache.getData() + header.offset,
+                                     header.w, header.h, header.n_colours);
+    cache.close();
+
+    if(result == EXIT_SUCCESS)
+    {
+      stats::count("texture.cache.hit");
+      if(touched)
+        refresh(path, mtime, source_size);
+    }
+    return result;
+  }
+
+  int store(hashid_t id, const char* filepath, const void* pixels,
+            size_t size, int w, int h, int n_colours)
+  {
+    if(w <= 0 || h <= 0 || size != pixels_size(w, h, n_colours))
+      WARN_RTN("texture_cache::store", "Inconsistent pixel size",
+               EXIT_FAILURE);
+
+    header_t header;
+    memcpy(header.magic, CACHE_MAGIC, 4);
+    header.version = CACHE_VERSION;
+    header.w = w;
+    header.h = h;
+    header.n_colours = n_colours;
+    header.offset = CACHE_ALIGN;
+    header.size = size;
+    const pack::entry_t* packed = pack::find(id);
+    string source = packed ? "" : pack::loose(filepath);
+    if(source_status(source, packed, header.mtime, header.source_size)
+        != EXIT_SUCCESS
+    || hash_file(source, packed, header.content_hash) != EXIT_SUCCESS)
+      return EXIT_FAILURE;
+
+    if(filesystem::make_directory(TEXTURE_CACHE_DIR) != EXIT_SUCCESS)
+      WARN_RTN("texture_cache::store", "Could not create cache directory",
+               EXIT_FAILURE);
+
+    // Write to a temporary file and swap it in, so a crash can never leave a
+    // half-written entry behind
+    string path = cache_path(id), temporary = path + ".tmp";
+    FILE* file = fopen(temporary.c_str(), "wb");
+    if(!file)
+      WARN_RTN("texture_cache::store", "Could not open cache entry",
+               EXIT_FAILURE);
+
+    static const char padding[CACHE_ALIGN] = { 0 };
+    bool valid = (fwrite(&header, sizeof(header), 1, file) == 1)
+      && (fwrite(padding, 1, CACHE_ALIGN - sizeof(header), file)
+          == CACHE_ALIGN - sizeof(header))
+      && (fwrite(pixels, 1, size, file) == size);
+    valid = (fclose(file) == 0) && valid;
+
+    if(!valid || filesystem::replace(temporary.c_str(), path.c_str())
+                  != EXIT_SUCCESS)
+    {
+      remove(temporary.c_str());
+      WARN_RTN("texture_cache::store", "Could not write cache entry",
+               EXIT_FAILURE);
+    }
+    return EXIT_SUCCESS;
+  }
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstddef>          // Needed for size_t
+
+#include "../hashid.h"
+
+class Texture;
+
+// On-disk cache of decoded images, already padded to powers of 2 and laid out
+// exactly as glTexImage2D wants them. Entries are keyed by source path and
+// checked against the source's modification time (to the nanosecond where
+// the file system keeps it) and size; if those changed the source content
+// hash decides whether the entry is still good. Packed sources are always
+// checked against the content hash the pack stores for them.
+
+#define TEXTURE_CACHE_DIR "cache"
+
+namespace texture_cache
+{
+  // upload a cached image straight from the mapped cache file,
+  // EXIT_FAILURE if there is no valid entry for this source ('id' is the
+  // hashid of 'filepath', which is only needed if the pack lacks it)
+  int load(hashid_t id, const char* filepath, Texture& texture);
+
+  // remember the upload-ready pixels decoded from this source
+  int store(hashid_t id, const char* filepath, const void* pixels,
+            size_t size, int w, int h, int n_colours);
+}
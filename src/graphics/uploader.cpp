@@ -0,0 +1,235 @@
+//! --------------------------------------------------------------------------
+//! -------------------------- INCLUDES
+//! --------------------------------------------------------------------------
+
+#include "uploader.h"
+
+#include <cstdlib>
+#include <string>
+#include <deque>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+#include "Texture.hpp"
+#include "opengl.h"
+#include "extensions.h"             // Needed for fences
+#include "../memory/heap.h"
+#include "../memory/Pool.hpp"
+#include "../debug/assert.h"
+#include "../debug/stats.h"
+
+using namespace std;
+
+//! --------------------------------------------------------------------------
+//! -------------------------- WORKSPACE
+//! --------------------------------------------------------------------------
+
+namespace
+{
+  struct job_t
+  {
+    hashid_t id;
+    string filepath;
+    Texture* target;
+    function<void(int)> done;
+    Texture staging;    // filled by the loader, copied to target when ready
+    int result;
+    GLsync fence;
+  };
+
+  static SDL_Window* window = nullptr;
+  static SDL_GLContext context = nullptr;
+  static thread loader;
+  static bool running = false;
+
+  // shared with the loader thread, protected by the mutex
+  static mutex jobs_mutex;
+  static condition_variable wake;
+  static deque<job_t*> pending;
+  static deque<job_t*> uploaded;
+
+  // render thread only
+  static Pool<job_t> jobs;
+  static vector<job_t*> fencing;
+  static unsigned int in_flight = 0;
+
+  void work()
+  {
+    HEAP_SCOPE(heap::GRAPHICS);
+    SDL_GL_MakeCurrent(window, context);
+
+    while(true)
+    {
+      job_t* job;
+      {
+        unique_lock<mutex> lock(jobs_mutex);
+        wake.wait(lock, []() { return !running || !pending.empty(); });
+        if(pending.empty())
+          break;
+        job = pending.front();
+        pending.pop_front();
+      }
+
+      {
+        STATS_TIME("uploader.load");
+        job->result = job->staging.load(job->id, job->filepath.c_str());
+      }
+
+      // The render thread may only use the texture once the GPU has it
+      if(extensions::sync)
+      {
+        job->fence = extensions::FenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        glFlush();
+      }
+      else
+        glFinish();
+
+      lock_guard<mutex> lock(jobs_mutex);
+      uploaded.push_back(job);
+    }
+
+    SDL_GL_MakeCurrent(window, nullptr);
+  }
+
+  bool is_ready(job_t* job)
+  {
+    if(!job->fence)
+      return true;
+
+    GLenum status = extensions::ClientWaitSync(job->fence, 0, 0);
+    if(status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED)
+      return false;
+
+    extensions::DeleteSync(job->fence);
+    job->fence = nullptr;
+    return true;
+  }
+}
+
+//! --------------------------------------------------------------------------
+//! -------------------------- INTERFACE
+//! --------------------------------------------------------------------------
+
+namespace uploader
+{
+  int start(SDL_Window* _window)
+  {
+    if(running)
+      return EXIT_SUCCESS;
+
+    window = _window;
+    SDL_GLContext main_context = SDL_GL_GetCurrentContext();
+
+    // Create a second context sharing textures with the current one; this
+    // makes it current, so give the render thread its context back
+    SDL_GL_SetAttribute(SDL_GL_SHARE_WITH_CURRENT_CONTEXT, 1);
+    context = SDL_GL_CreateContext(window);
+    SDL_GL_SetAttribute(SDL_GL_SHARE_WITH_CURRENT_CONTEXT, 0);
+    SDL_GL_MakeCurrent(window, main_context);
+    ASSERT_SDL(context, "Creating shared loader context");
+
+    running = true;
+    loader = thread(work);
+    return EXIT_SUCCESS;
+  }
+
+  int stop()
+  {
+    if(!running)
+      return EXIT_SUCCESS;
+
+    {
+      lock_guard<mutex> lock(jobs_mutex);
+      running = false;
+    }
+    wake.notify_one();
+    loader.join();
+
+    // Hand over whatever is left: every fence has been flushed already
+    while(busy())
+      update();
+
+    SDL_GL_DeleteContext(context);
+    context = nullptr;
+    return EXIT_SUCCESS;
+  }
+
+  int load(const char* filepath, Texture& target, function<void(int)> done)
+  {
+    return load(hashid::intern(filepath), filepath, target, done);
+  }
+
+  int load(hashid_t id, const char* filepath, Texture& target,
+           function<void(int)> done)
+  {
+    // No loader thread: do it now
+    if(!running)
+    {
+      int result = target.load(id, filepath);
+      if(done)
+        done(result);
+      return result;
+    }
+
+    HEAP_SCOPE(heap::GRAPHICS);
+    job_t* job = jobs.create();
+    job->id = id;
+    job->filepath = filepath;
+    job->target = &target;
+    job->done = done;
+    job->result = EXIT_FAILURE;
+    job->fence = nullptr;
+
+    {
+      lock_guard<mutex> lock(jobs_mutex);
+      pending.push_back(job);
+    }
+    wake.notify_one();
+    in_flight++;
+    return EXIT_SUCCESS;
+  }
+
+  void update()
+  {
+    {
+      lock_guard<mutex> lock(jobs_mutex);
+      fencing.insert(fencing.end(), uploaded.begin(), uploaded.end());
+      uploaded.clear();
+    }
+
+    // Hand over what's ready, in order, and close up the gaps as we go
+    size_t kept = 0;
+    for(size_t i = 0; i < fencing.size(); i++)
+    {
+      job_t* job = fencing[i];
+      if(!is_ready(job))
+      {
+        fencing[kept++] = job;
+        continue;
+      }
+
+      // Hand over the handle: Texture copies share it
+      if(job->result == EXIT_SUCCESS)
+      {
+        if(job->target->isLoaded())
+          job->target->unload();
+        (*job->target) = job->staging;
+      }
+      if(job->done)
+        job->done(job->result);
+
+      jobs.destroy(job);
+      in_flight--;
+    }
+    fencing.resize(kept);
+
+    stats::set("uploader.in_flight", in_flight);
+  }
+
+  bool busy()
+  {
+    return (in_flight > 0);
+  }
+}
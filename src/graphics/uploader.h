@@ -0,0 +1,38 @@
+#pragma once
+
+#include <functional>
+
+#include "SDL.h"                    // Needed for SDL_Window
+
+#include "../hashid.h"
+
+class Texture;
+
+// Optional loader thread with its own OpenGL context, shared with the main
+// one, so that decoding and glTexImage2D never stall the render thread.
+// Finished textures are handed over once a fence says the GPU has them.
+// Without the thread (or without context sharing) loads are synchronous.
+
+namespace uploader
+{
+  // create the shared context and start the thread: call from the render
+  // thread while its context is current
+  int start(SDL_Window* window);
+
+  // finish the queue and destroy the shared context
+  int stop();
+
+  // load 'filepath' into 'target'; 'done' is called on the render thread
+  // (from update) with EXIT_SUCCESS or EXIT_FAILURE once it's ready to draw
+  int load(const char* filepath, Texture& target,
+           std::function<void(int)> done = nullptr);
+  // the same, with the path's id worked out beforehand ("assets/..."_id)
+  int load(hashid_t id, const char* filepath, Texture& target,
+           std::function<void(int)> done = nullptr);
+
+  // hand over finished textures, call once per frame on the render thread
+  void update();
+
+  // are there loads still in flight?
+  bool busy();
+}
@@ -0,0 +1,88 @@
+//! --------------------------------------------------------------------------
+//! -------------------------- INCLUDES
+//! --------------------------------------------------------------------------
+
+#include "hashid.h"
+
+#include <cstdlib>
+
+#ifdef DEBUG
+  #include <string>
+  #include <unordered_map>
+  #include <mutex>
+  #include "debug/log.h"
+#endif // DEBUG
+
+using namespace std;
+
+//! --------------------------------------------------------------------------
+//! -------------------------- WORKSPACE
+//! --------------------------------------------------------------------------
+
+#ifdef DEBUG
+
+namespace
+{
+  // Names for logging: shared by every thread that loads anything
+  static mutex names_mutex;
+  static unordered_map<hashid_t, string> names;
+}
+
+#endif // DEBUG
+
+// Literals hash when compiling, to the published FNV-1a values
+static_assert(""_id == HASHID_OFFSET && "a"_id == 0xaf63dc4c8601ec8cULL,
+              "hashid::of isn't 64-bit FNV-1a");
+
+//! --------------------------------------------------------------------------
+//! -------------------------- INTERFACE
+//! --------------------------------------------------------------------------
+
+namespace hashid
+{
+  hashid_t hash(const char* text)
+  {
+    hashid_t result = HASHID_OFFSET;
+    for(const unsigned char* c = (const unsigned char*)text; *c; c++)
+      result = (result ^ *c) * HASHID_PRIME;
+    return result;
+  }
+
+  hashid_t hash(const void* data, size_t size, hashid_t result)
+  {
+    const unsigned char* bytes = (const unsigned char*)data;
+    for(size_t i = 0; i < size; i++)
+      result = (result ^ bytes[i]) * HASHID_PRIME;
+    return result;
+  }
+
+  hashid_t intern(const char* text)
+  {
+    hashid_t id = hash(text);
+
+#ifdef DEBUG
+    lock_guard<mutex> lock(names_mutex);
+    unordered_map<hashid_t, string>::iterator found = names.find(id);
+    if(found == names.end())
+      names[id] = text;
+    else if(found->second != text)
+      log(LOG_ERROR, "hashid::intern : \"%s\" and \"%s\" collide",
+          text, found->second.c_str());
+#endif // DEBUG
+
+    return id;
+  }
+
+  const char* name(hashid_t id)
+  {
+#ifdef DEBUG
+    // Names are never removed: the pointer stays valid
+    lock_guard<mutex> lock(names_mutex);
+    unordered_map<hashid_t, string>::iterator found = names.find(id);
+    if(found != names.end())
+      return found->second.c_str();
+#endif // DEBUG
+
+    return "?";
+  }
+}
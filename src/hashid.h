@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstddef>          // Needed for size_t
+#include <stdint.h>
+
+// 64-bit FNV-1a identifiers for asset paths and other names, so that lookups
+// compare one integer rather than strings. Literals hash at compile time:
+//
+//    pack::find("assets/font.png"_id)
+//
+// and strings only known at run time hash to the same value with
+// hashid::hash or hashid::intern. Debug builds remember the interned names
+// so identifiers can be logged (the asset pack interns all of its own);
+// release builds only have the number.
+
+typedef uint64_t hashid_t;
+
+#define HASHID_OFFSET 14695981039346656037ULL
+#define HASHID_PRIME 1099511628211ULL
+
+namespace hashid
+{
+  // C++11 constexpr: one return statement, so one character per call
+  constexpr hashid_t of(const char* text, size_t length,
+                        hashid_t hash = HASHID_OFFSET)
+  {
+    return length ? of(text + 1, length - 1,
+                       (hash ^ (unsigned char)*text) * HASHID_PRIME)
+                  : hash;
+  }
+
+  // the same at run time, for strings and for any other bytes
+  hashid_t hash(const char* text);
+  hashid_t hash(const void* data, size_t size, hashid_t hash = HASHID_OFFSET);
+
+  // hash, and remember the name in debug builds (warning on a collision)
+  hashid_t intern(const char* text);
+
+  // interned name for logging, "?" if unknown or not a debug build
+  const char* name(hashid_t id);
+}
+
+constexpr hashid_t operator"" _id(const char* text, size_t length)
+{
+  return hashid::of(text, length);
+}
@@ -0,0 +1,216 @@
+//! --------------------------------------------------------------------------
+//! -------------------------- INCLUDES
+//! --------------------------------------------------------------------------
+
+#include "input.h"
+
+#include <vector>
+
+#include "../debug/stats.h"
+
+using namespace std;
+
+//! --------------------------------------------------------------------------
+//! -------------------------- WORKSPACE
+//! --------------------------------------------------------------------------
+
+namespace
+{
+  struct binding_t
+  {
+    input::action_t action;
+    bool is_button;
+    int code;       // scancode or button
+  };
+
+  static vector<binding_t> bindings;
+  static input::snapshot_t snapshot;
+  static SDL_Event events[INPUT_BATCH];
+
+  // Fold a batch of events into the snapshot
+  void treat(const SDL_Event* batch, int n)
+  {
+    input::snapshot_t& s = snapshot;
+    for(int i = 0; i < n; i++)
+    {
+      const SDL_Event& event = batch[i];
+      switch(event.type)
+      {
+        case SDL_KEYDOWN:
+          // Held keys repeat: only the first one is a press
+          if(!event.key.repeat)
+          {
+            s.keys.set(event.key.keysym.scancode);
+            s.keys_pressed.set(event.key.keysym.scancode);
+          }
+        break;
+
+        case SDL_KEYUP:
+          s.keys.reset(event.key.keysym.scancode);
+          s.keys_released.set(event.key.keysym.scancode);
+        break;
+
+        case SDL_MOUSEMOTION:
+          s.mouse = iV2(event.motion.x, event.motion.y);
+          s.motion += iV2(event.motion.xrel, event.motion.yrel);
+        break;
+
+        case SDL_MOUSEBUTTONDOWN:
+          s.buttons |= SDL_BUTTON(event.button.button);
+          s.buttons_pressed |= SDL_BUTTON(event.button.button);
+          s.mouse = iV2(event.button.x, event.button.y);
+        break;
+
+        case SDL_MOUSEBUTTONUP:
+          s.buttons &= ~SDL_BUTTON(event.button.button);
+          s.buttons_released |= SDL_BUTTON(event.button.button);
+          s.mouse = iV2(event.button.x, event.button.y);
+        break;
+
+        case SDL_MOUSEWHEEL:
+          s.wheel += iV2(event.wheel.x, event.wheel.y);
+        break;
+
+        case SDL_WINDOWEVENT:
+          s.window_changed = true;
+          if(event.window.event == SDL_WINDOWEVENT_FOCUS_GAINED)
+            s.focused = true;
+          else if(event.window.event == SDL_WINDOWEVENT_FOCUS_LOST)
+            s.focused = false;
+        break;
+
+        case SDL_QUIT:
+          s.quit = true;
+        break;
+
+        default:
+          // not all possible inputs are needed
+        break;
+      }
+    }
+  }
+
+  // Work out the actions from the keys and buttons
+  void map_actions()
+  {
+    input::snapshot_t& s = snapshot;
+    s.actions = s.actions_pressed = s.actions_released = 0;
+    for(size_t i = 0; i < bindings.size(); i++)
+    {
+      const binding_t& b = bindings[i];
+      bool down, pressed, released;
+      if(b.is_button)
+      {
+        down = s.buttons & SDL_BUTTON(b.code);
+        pressed = s.buttons_pressed & SDL_BUTTON(b.code);
+        released = s.buttons_released & SDL_BUTTON(b.code);
+      }
+      else
+      {
+        down = s.keys[b.code];
+        pressed = s.keys_pressed[b.code];
+        released = s.keys_released[b.code];
+      }
+
+      uint32_t bit = 1u << b.action;
+      if(down)
+        s.actions |= bit;
+      if(pressed)
+        s.actions_pressed |= bit;
+      if(released)
+        s.actions_released |= bit;
+    }
+  }
+}
+
+//! --------------------------------------------------------------------------
+//! -------------------------- SNAPSHOT
+//! --------------------------------------------------------------------------
+
+namespace input
+{
+  bool snapshot_t::isDown(action_t action) const
+  {
+    return (actions >> action) & 1;
+  }
+
+  bool snapshot_t::wasPressed(action_t action) const
+  {
+    return (actions_pressed >> action) & 1;
+  }
+
+  bool snapshot_t::wasReleased(action_t action) const
+  {
+    return (actions_released >> action) & 1;
+  }
+}
+
+//! --------------------------------------------------------------------------
+//! -------------------------- INTERFACE
+//! --------------------------------------------------------------------------
+
+namespace input
+{
+  void bind(action_t action, SDL_Scancode key)
+  {
+    if(action >= INPUT_MAX_ACTIONS || key < 0 || key >= SDL_NUM_SCANCODES)
+      return;
+    binding_t b = { action, false, key };
+    bindings.push_back(b);
+  }
+
+  void bind_button(action_t action, Uint8 button)
+  {
+    if(action >= INPUT_MAX_ACTIONS || !button
+    || button > INPUT_MOUSE_BUTTONS)
+      return;
+    binding_t b = { action, true, button };
+    bindings.push_back(b);
+  }
+
+  void unbind(action_t action)
+  {
+    for(size_t i = 0; i < bindings.size(); )
+    {
+      if(bindings[i].action == action)
+      {
+        bindings[i] = bindings.back();
+        bindings.pop_back();
+      }
+      else
+        i++;
+    }
+  }
+
+  const snapshot_t& poll()
+  {
+    // Edges and sums only last one tick, the rest carries over
+    snapshot.keys_pressed.reset();
+    snapshot.keys_released.reset();
+    snapshot.buttons_pressed = snapshot.buttons_released = 0;
+    snapshot.motion = snapshot.wheel = iV2(0, 0);
+    snapshot.quit = snapshot.window_changed = false;
+    snapshot.n_events = 0;
+
+    // Pull everything queued, a batch at a time
+    SDL_PumpEvents();
+    int n;
+    while((n = SDL_PeepEvents(events, INPUT_BATCH, SDL_GETEVENT,
+                              SDL_FIRSTEVENT, SDL_LASTEVENT)) > 0)
+    {
+      treat(events, n);
+      snapshot.n_events += n;
+      if(n < INPUT_BATCH)
+        break;
+    }
+
+    map_actions();
+    stats::count("input.events", snapshot.n_events);
+    return snapshot;
+  }
+
+  const snapshot_t& get()
+  {
+    return snapshot;
+  }
+}
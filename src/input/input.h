@@ -0,0 +1,64 @@
+#pragma once
+
+#include <bitset>
+#include <stdint.h>
+
+#include "SDL.h"
+
+#include "../math/V2.hpp"
+
+// Input is read once per tick rather than handed out event by event: every
+// pending SDL event is pulled in batches and folded into a snapshot (what
+// is held down, what went down or up during the tick, where the mouse is
+// and how far it moved). Games then ask about actions rather than keys:
+// each action is bound to any number of keys and mouse buttons.
+
+#define INPUT_BATCH 64            // events pulled from SDL at a time
+#define INPUT_MAX_ACTIONS 32
+#define INPUT_MOUSE_BUTTONS 8
+
+namespace input
+{
+  typedef unsigned int action_t;
+
+  struct snapshot_t
+  {
+    // keys by scancode: held now, went down or up during the tick
+    std::bitset<SDL_NUM_SCANCODES> keys, keys_pressed, keys_released;
+    // mouse buttons by SDL_BUTTON mask, the same way
+    uint32_t buttons, buttons_pressed, buttons_released;
+    // actions, one bit each, the same way
+    uint32_t actions, actions_pressed, actions_released;
+    // axes
+    iV2 mouse;        // position in the window
+    iV2 motion;       // summed over the tick
+    iV2 wheel;        // summed over the tick
+    // everything else
+    bool quit;
+    bool window_changed;
+    bool focused;     // does the window have keyboard focus?
+    unsigned int n_events;
+
+    snapshot_t() :
+    buttons(0), buttons_pressed(0), buttons_released(0),
+    actions(0), actions_pressed(0), actions_released(0),
+    quit(false), window_changed(false), focused(true), n_events(0) {}
+
+    // queries: held, went down, went up (a tap within one tick counts as
+    // both pressed and released)
+    bool isDown(action_t action) const;
+    bool wasPressed(action_t action) const;
+    bool wasReleased(action_t action) const;
+  };
+
+  // map an action to a key or a mouse button (SDL_BUTTON_LEFT, ...)
+  void bind(action_t action, SDL_Scancode key);
+  void bind_button(action_t action, Uint8 button);
+  void unbind(action_t action);
+
+  // pull every pending event and build this tick's snapshot
+  const snapshot_t& poll();
+
+  // the snapshot built by the last poll
+  const snapshot_t& get();
+}
@@ -0,0 +1,134 @@
+//! --------------------------------------------------------------------------
+//! -------------------------- INCLUDES
+//! --------------------------------------------------------------------------
+
+#include "MappedFile.hpp"
+
+#include <cstdlib>
+
+#ifdef WIN32
+  #include <windows.h>
+#else
+  #include <sys/mman.h>
+  #include <sys/stat.h>
+  #include <fcntl.h>
+  #include <unistd.h>
+#endif // WIN32
+
+#include "../debug/warn.h"
+
+//! --------------------------------------------------------------------------
+//! -------------------------- CONSTRUCTORS, DESTRUCTOR
+//! --------------------------------------------------------------------------
+
+MappedFile::MappedFile() :
+bytes(nullptr),
+length(0)
+#ifdef WIN32
+, file(INVALID_HANDLE_VALUE),
+mapping(nullptr)
+#endif // WIN32
+{
+}
+
+int MappedFile::open(const char* filepath)
+{
+  // Free any previous mapping
+  if(bytes)
+    close();
+
+#ifdef WIN32
+
+  file = CreateFileA(filepath, GENERIC_READ, FILE_SHARE_READ, nullptr,
+                     OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+  if(file == INVALID_HANDLE_VALUE)
+    WARN_RTN("MappedFile::open()", "Could not open file", EXIT_FAILURE);
+
+  LARGE_INTEGER file_size;
+  GetFileSizeEx(file, &file_size);
+  length = (size_t)file_size.QuadPart;
+
+  mapping = length ? CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0,
+                                        nullptr) : nullptr;
+  if(mapping)
+    bytes = (const unsigned char*)MapViewOfFile(mapping, FILE_MAP_READ,
+                                                0, 0, 0);
+  if(!bytes)
+  {
+    close();
+    WARN_RTN("MappedFile::open()", "Could not map file", EXIT_FAILURE);
+  }
+
+#else
+
+  int descriptor = ::open(filepath, O_RDONLY);
+  if(descriptor < 0)
+    WARN_RTN("MappedFile::open()", "Could not open file", EXIT_FAILURE);
+
+  struct stat status;
+  void* address = MAP_FAILED;
+  if(fstat(descriptor, &status) == 0 && status.st_size > 0)
+  {
+    length = (size_t)status.st_size;
+    address = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, descriptor, 0);
+  }
+
+  // The mapping stays valid once the descriptor is closed
+  ::close(descriptor);
+
+  if(address == MAP_FAILED)
+  {
+    length = 0;
+    WARN_RTN("MappedFile::open()", "Could not map file", EXIT_FAILURE);
+  }
+  bytes = (const unsigned char*)address;
+
+#endif // WIN32
+
+  return EXIT_SUCCESS;
+}
+
+int MappedFile::close()
+{
+#ifdef WIN32
+  if(bytes)
+    UnmapViewOfFile(bytes);
+  if(mapping)
+    CloseHandle(mapping);
+  if(file != INVALID_HANDLE_VALUE)
+    CloseHandle(file);
+  mapping = nullptr;
+  file = INVALID_HANDLE_VALUE;
+#else
+  if(bytes)
+    munmap((void*)bytes, length);
+#endif // WIN32
+
+  bytes = nullptr;
+  length = 0;
+  return EXIT_SUCCESS;
+}
+
+MappedFile::~MappedFile()
+{
+  close();
+}
+
+//! --------------------------------------------------------------------------
+//! -------------------------- ACCESSORS
+//! --------------------------------------------------------------------------
+
+bool MappedFile::isOpen() const
+{
+  return (bytes != nullptr);
+}
+
+const unsigned char* MappedFile::getData() const
+{
+  return bytes;
+}
+
+size_t MappedFile::getSize() const
+{
+  return length;
+}
@@ -0,0 +1,39 @@
+#ifndef MAPPEDFILE_HPP_INCLUDED
+#define MAPPEDFILE_HPP_INCLUDED
+
+#include <cstddef>          // Needed for size_t
+
+// Read-only view of a whole file mapped into memory (mmap on POSIX,
+// CreateFileMapping on Windows). The pages are only read from disk when
+// touched, and nothing is copied.
+
+class MappedFile
+{
+  /// ATTRIBUTES
+private:
+  const unsigned char* bytes;
+  size_t length;
+#ifdef WIN32
+  void* file;
+  void* mapping;
+#endif // WIN32
+
+  /// METHODS
+public:
+  // constructors, destructors
+  MappedFile();
+  int open(const char* filepath);
+  int close();
+  ~MappedFile();
+  // accessors
+  bool isOpen() const;
+  const unsigned char* getData() const;
+  size_t getSize() const;
+
+private:
+  // a mapping can't be shared: don't copy
+  MappedFile(const MappedFile&);
+  MappedFile& operator=(const MappedFile&);
+};
+
+#endif // MAPPEDFILE_HPP_INCLUDED
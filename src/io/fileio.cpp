@@ -0,0 +1,572 @@
+//! --------------------------------------------------------------------------
+//! -------------------------- INCLUDES
+//! --------------------------------------------------------------------------
+
+#include "fileio.h"
+
+#include <cstdlib>
+#include <cstdio>
+#include <cstring>
+#include <climits>
+#include <string>
+#include <deque>
+#include <vector>
+#include <mutex>
+#include <condition_variable>
+
+#include <fcntl.h>
+#ifdef WIN32
+  #include <io.h>
+#else
+  #include <unistd.h>
+#endif // WIN32
+
+// The operations used are only all there from Linux 5.6: older headers
+// don't even name them, so build without io_uring against those
+#ifdef __linux__
+  #include <linux/version.h>
+  #if LINUX_VERSION_CODE >= KERNEL_VERSION(5, 6, 0)
+    #include <linux/io_uring.h>
+    #include <sys/syscall.h>
+    #include <sys/mman.h>
+    #include <cerrno>
+    #define FILEIO_URING
+  #endif
+#endif // __linux__
+
+#include "../threads/WorkerPool.hpp"
+#include "../memory/Pool.hpp"
+#include "../math/wjd_math.h"       // Needed for MIN and MAX
+#include "../debug/warn.h"
+#include "../debug/stats.h"
+
+using namespace std;
+
+//! --------------------------------------------------------------------------
+//! -------------------------- REQUESTS
+//! --------------------------------------------------------------------------
+
+namespace
+{
+  enum stage_t
+  {
+    QUEUED,     // waiting for room in the backend
+    OPENING,
+    READING,
+    FINISHED
+  };
+
+  struct request_t
+  {
+    string filepath;
+    void* buffer;
+    size_t size;
+    uint64_t offset;
+    fileio::done_t done;
+    int descriptor;
+    long result;
+    stage_t stage;
+  };
+
+  static fileio::backend_t active = fileio::NONE;
+
+  // main thread only
+  static Pool<request_t> requests;
+  static deque<request_t*> queued;
+  static vector<request_t*> finished;
+  static unsigned int in_flight = 0;    // queued included
+
+  // The whole read as blocking calls: for worker threads and NONE
+  void read_now(request_t* request)
+  {
+#ifdef WIN32
+    int descriptor = _open(request->filepath.c_str(), _O_RDONLY | _O_BINARY);
+#else
+    int descriptor = open(request->filepath.c_str(), O_RDONLY | O_CLOEXEC);
+#endif // WIN32
+    request->result = -1;
+    if(descriptor < 0)
+      return;
+
+#ifdef WIN32
+    if(_lseeki64(descriptor, request->offset, SEEK_SET) >= 0)
+      request->result = _read(descriptor, request->buffer,
+                              (unsigned int)MIN(request->size, INT_MAX));
+    _close(descriptor);
+#else
+    long total = 0;
+    while((size_t)total < request->size)
+    {
+      ssize_t n = pread(descriptor, (char*)request->buffer + total,
+                        request->size - total, request->offset + total);
+      if(n < 0)
+        total = -1;
+      if(n <= 0)
+        break;
+      total += n;
+    }
+    request->result = total;
+    close(descriptor);
+#endif // WIN32
+  }
+
+  // Callbacks may queue more reads: only touch the list of finished ones
+  int call_back()
+  {
+    if(finished.empty())
+      return 0;
+
+    vector<request_t*> ready;
+    ready.swap(finished);
+    for(size_t i = 0; i < ready.size(); i++)
+    {
+      request_t* request = ready[i];
+      in_flight--;
+      if(request->result > 0)
+        stats::count("fileio.read.kb", request->result/1024.0);
+      else if(request->result < 0)
+        stats::count("fileio.failed");
+      if(request->done)
+        request->done(request->result);
+      requests.destroy(request);
+    }
+    return ready.size();
+  }
+}
+
+//! --------------------------------------------------------------------------
+//! -------------------------- IO_URING BACKEND
+//! --------------------------------------------------------------------------
+
+#ifdef FILEIO_URING
+
+namespace
+{
+  // No liburing: the rings are mapped and driven by hand
+  static int ring = -1;
+  static unsigned int depth = 0;
+  static unsigned int in_ring = 0;      // submitted but not reaped
+  static unsigned int to_submit = 0;    // prepared but not submitted
+  static void* sq_map = MAP_FAILED;
+  static void* cq_map = MAP_FAILED;
+  static size_t sq_map_size = 0, cq_map_size = 0, sqes_size = 0;
+  static unsigned *sq_tail, *sq_mask, *sq_array;
+  static unsigned *cq_head, *cq_tail, *cq_mask;
+  static io_uring_sqe* sqes = (io_uring_sqe*)MAP_FAILED;
+  static io_uring_cqe* cqes;
+
+  int uring_close()
+  {
+    if(sqes != MAP_FAILED)
+      munmap(sqes, sqes_size);
+    if(cq_map != MAP_FAILED && cq_map != sq_map)
+      munmap(cq_map, cq_map_size);
+    if(sq_map != MAP_FAILED)
+      munmap(sq_map, sq_map_size);
+    if(ring >= 0)
+      close(ring);
+    sqes = (io_uring_sqe*)MAP_FAILED;
+    sq_map = cq_map = MAP_FAILED;
+    ring = -1;
+    in_ring = to_submit = 0;
+    return EXIT_SUCCESS;
+  }
+
+  // Every operation we use must be there (5.6 or later)
+  bool uring_supports()
+  {
+    size_t size = sizeof(io_uring_probe) + 256*sizeof(io_uring_probe_op);
+    vector<unsigned char> memory(size, 0);
+    io_uring_probe* probe = (io_uring_probe*)&memory[0];
+    if(syscall(__NR_io_uring_register, ring, IORING_REGISTER_PROBE, probe,
+               256) < 0)
+      return false;
+
+    const int needed[] =
+      { IORING_OP_OPENAT, IORING_OP_READ, IORING_OP_CLOSE };
+    for(size_t i = 0; i < sizeof(needed)/sizeof(int); i++)
+      if(needed[i] > probe->last_op
+      || !(probe->ops[needed[i]].flags & IO_URING_OP_SUPPORTED))
+        return false;
+    return true;
+  }
+
+  int uring_open(unsigned int entries)
+  {
+    io_uring_params parameters;
+    memset(&parameters, 0, sizeof(parameters));
+    ring = syscall(__NR_io_uring_setup, entries, &parameters);
+    if(ring < 0)
+      return EXIT_FAILURE;
+    if(!uring_supports())
+    {
+      uring_close();
+      return EXIT_FAILURE;
+    }
+    depth = parameters.sq_entries;
+
+    // Both rings in one mapping if the kernel allows it
+    sq_map_size = parameters.sq_off.array + depth*sizeof(unsigned);
+    cq_map_size = parameters.cq_off.cqes
+                + parameters.cq_entries*sizeof(io_uring_cqe);
+    bool single = (parameters.features & IORING_FEAT_SINGLE_MMAP);
+    if(single)
+      sq_map_size = cq_map_size = MAX(sq_map_size, cq_map_size);
+
+    sq_map = mmap(nullptr, sq_map_size, PROT_READ | PROT_WRITE,
+                  MAP_SHARED | MAP_POPULATE, ring, IORING_OFF_SQ_RING);
+    cq_map = (single || sq_map == MAP_FAILED) ? sq_map
+      : mmap(nullptr, cq_map_size, PROT_READ | PROT_WRITE,
+             MAP_SHARED | MAP_POPULATE, ring, IORING_OFF_CQ_RING);
+    sqes_size = depth*sizeof(io_uring_sqe);
+    if(cq_map != MAP_FAILED)
+      sqes = (io_uring_sqe*)mmap(nullptr, sqes_size, PROT_READ | PROT_WRITE,
+                                 MAP_SHARED | MAP_POPULATE, ring,
+                                 IORING_OFF_SQES);
+    if(sqes == MAP_FAILED)
+    {
+      uring_close();
+      return EXIT_FAILURE;
+    }
+
+    unsigned char* sq = (unsigned char*)sq_map;
+    sq_tail = (unsigned*)(sq + parameters.sq_off.tail);
+    sq_mask = (unsigned*)(sq + parameters.sq_off.ring_mask);
+    sq_array = (unsigned*)(sq + parameters.sq_off.array);
+    unsigned char* cq = (unsigned char*)cq_map;
+    cq_head = (unsigned*)(cq + parameters.cq_off.head);
+    cq_tail = (unsigned*)(cq + parameters.cq_off.tail);
+    cq_mask = (unsigned*)(cq + parameters.cq_off.ring_mask);
+    cqes = (io_uring_cqe*)(cq + parameters.cq_off.cqes);
+    return EXIT_SUCCESS;
+  }
+
+  // At most 'depth' operations in the kernel: the submission ring always has
+  // room and the completion ring (twice as large) can't overflow
+  io_uring_sqe* uring_prepare(uint8_t opcode, int descriptor,
+                              request_t* request)
+  {
+    unsigned tail = *sq_tail, index = tail & *sq_mask;
+    io_uring_sqe* sqe = &sqes[index];
+    memset(sqe, 0, sizeof(*sqe));
+    sqe->opcode = opcode;
+    sqe->fd = descriptor;
+    sqe->user_data = (uint64_t)(uintptr_t)request;
+    sq_array[index] = index;
+    __atomic_store_n(sq_tail, tail + 1, __ATOMIC_RELEASE);
+    to_submit++;
+    in_ring++;
+    return sqe;
+  }
+
+  void uring_open_file(request_t* request)
+  {
+    io_uring_sqe* sqe = uring_prepare(IORING_OP_OPENAT, AT_FDCWD, request);
+    sqe->addr = (uint64_t)(uintptr_t)request->filepath.c_str();
+    sqe->open_flags = O_RDONLY | O_CLOEXEC;
+    request->stage = OPENING;
+  }
+
+  // Whatever is left to read, after the 'result' bytes already read
+  void uring_read(request_t* request)
+  {
+    io_uring_sqe* sqe = uring_prepare(IORING_OP_READ, request->descriptor,
+                                      request);
+    size_t done = (size_t)request->result;
+    sqe->addr = (uint64_t)(uintptr_t)((char*)request->buffer + done);
+    sqe->len = (uint32_t)MIN(request->size - done, (size_t)UINT_MAX);
+    sqe->off = request->offset + done;
+    request->stage = READING;
+  }
+
+  // Nobody waits for a close: no request attached
+  void uring_close_file(int descriptor)
+  {
+    uring_prepare(IORING_OP_CLOSE, descriptor, nullptr);
+  }
+
+  // Move queued reads into the ring while there's room
+  void uring_fill()
+  {
+    while(!queued.empty() && in_ring < depth)
+    {
+      uring_open_file(queued.front());
+      queued.pop_front();
+    }
+  }
+
+  int uring_enter(unsigned int wait_for)
+  {
+    while(true)
+    {
+      int result = syscall(__NR_io_uring_enter, ring, to_submit, wait_for,
+                           wait_for ? IORING_ENTER_GETEVENTS : 0, nullptr, 0);
+      if(result >= 0)
+      {
+        to_submit -= result;
+        return EXIT_SUCCESS;
+      }
+      if(errno != EINTR && errno != EAGAIN && errno != EBUSY)
+        WARN_RTN("fileio::enter", strerror(errno), EXIT_FAILURE);
+    }
+  }
+
+  // Each completion moves its request on: opened files get read, read files
+  // get closed (and the request is finished)
+  void uring_reap()
+  {
+    unsigned head = *cq_head,
+             tail = __atomic_load_n(cq_tail, __ATOMIC_ACQUIRE);
+    for(; head != tail; head++)
+    {
+      const io_uring_cqe& cqe = cqes[head & *cq_mask];
+      request_t* request = (request_t*)(uintptr_t)cqe.user_data;
+      in_ring--;
+      if(!request)
+        continue;
+
+      if(request->stage == OPENING)
+      {
+        if(cqe.res < 0)
+        {
+          request->result = -1;
+          request->stage = FINISHED;
+          finished.push_back(request);
+        }
+        else
+        {
+          // The completion just freed the slot this takes
+          request->descriptor = cqe.res;
+          request->result = 0;
+          uring_read(request);
+        }
+      }
+      else
+      {
+        // Reads can come back short (signals, large sizes, some file
+        // systems): carry on from there until done or at the end of file
+        if(cqe.res < 0)
+          request->result = -1;
+        else
+        {
+          request->result += cqe.res;
+          if(cqe.res > 0 && (size_t)request->result < request->size)
+          {
+            stats::count("fileio.short");
+            uring_read(request);
+            continue;
+          }
+        }
+        request->stage = FINISHED;
+        uring_close_file(request->descriptor);
+        finished.push_back(request);
+      }
+    }
+    __atomic_store_n(cq_head, head, __ATOMIC_RELEASE);
+  }
+
+  int uring_update(unsigned int wait_for)
+  {
+    // Never wait on an empty ring
+    uring_fill();
+    if(!in_ring)
+      wait_for = 0;
+    if(uring_enter(wait_for) != EXIT_SUCCESS)
+      return EXIT_FAILURE;
+    uring_reap();
+
+    // Reads and closes that followed from the completions go straight out
+    uring_fill();
+    if(to_submit)
+      return uring_enter(0);
+    return EXIT_SUCCESS;
+  }
+}
+
+#endif // FILEIO_URING
+
+//! --------------------------------------------------------------------------
+//! -------------------------- THREAD BACKEND
+//! --------------------------------------------------------------------------
+
+namespace
+{
+  // Only created if something actually gets read this way
+  static WorkerPool* workers = nullptr;
+
+  // shared with the workers, protected by the mutex
+  static mutex done_mutex;
+  static condition_variable done_wake;
+  static vector<request_t*> done;
+
+  void threads_submit()
+  {
+    if(!workers)
+      workers = new WorkerPool();
+
+    while(!queued.empty())
+    {
+      request_t* request = queued.front();
+      queued.pop_front();
+      request->stage = READING;
+      workers->submit([request]()
+      {
+        read_now(request);
+        {
+          lock_guard<mutex> lock(done_mutex);
+          done.push_back(request);
+        }
+        done_wake.notify_one();
+      });
+    }
+  }
+
+  void threads_collect(bool block)
+  {
+    unique_lock<mutex> lock(done_mutex);
+    if(block)
+      done_wake.wait(lock, []() { return !done.empty(); });
+    for(size_t i = 0; i < done.size(); i++)
+      done[i]->stage = FINISHED;
+    finished.insert(finished.end(), done.begin(), done.end());
+    done.clear();
+  }
+}
+
+//! --------------------------------------------------------------------------
+//! -------------------------- INTERFACE
+//! --------------------------------------------------------------------------
+
+namespace fileio
+{
+  int start(backend_t preferred)
+  {
+    if(active != NONE)
+      stop();
+
+#ifdef FILEIO_URING
+    if(preferred == URING && uring_open(FILEIO_DEPTH) == EXIT_SUCCESS)
+    {
+      active = URING;
+      return EXIT_SUCCESS;
+    }
+#endif // FILEIO_URING
+
+    active = THREADS;
+    return EXIT_SUCCESS;
+  }
+
+  int stop()
+  {
+    wait();
+
+#ifdef FILEIO_URING
+    // Closes are still in the ring even with every read called back
+    while(active == URING && in_ring)
+      if(uring_update(1) != EXIT_SUCCESS)
+        break;
+    if(active == URING)
+      uring_close();
+#endif // FILEIO_URING
+    delete workers;
+    workers = nullptr;
+    active = NONE;
+    return EXIT_SUCCESS;
+  }
+
+  backend_t backend()
+  {
+    return active;
+  }
+
+  int read(const char* filepath, void* buffer, size_t size, done_t done,
+           uint64_t offset)
+  {
+    request_t* request = requests.create();
+    request->filepath = filepath;
+    request->buffer = buffer;
+    request->size = size;
+    request->offset = offset;
+    request->done = done;
+    request->descriptor = -1;
+    request->result = -1;
+    request->stage = QUEUED;
+    queued.push_back(request);
+    in_flight++;
+    return EXIT_SUCCESS;
+  }
+
+  int submit()
+  {
+    switch(active)
+    {
+#ifdef FILEIO_URING
+      case URING:
+        uring_fill();
+        return to_submit ? uring_enter(0) : EXIT_SUCCESS;
+#endif // FILEIO_URING
+
+      case THREADS:
+        threads_submit();
+      break;
+
+      default:
+        // Not started: block here rather than in the callback
+        while(!queued.empty())
+        {
+          read_now(queued.front());
+          queued.front()->stage = FINISHED;
+          finished.push_back(queued.front());
+          queued.pop_front();
+        }
+      break;
+    }
+    return EXIT_SUCCESS;
+  }
+
+  int update()
+  {
+#ifdef FILEIO_URING
+    if(active == URING)
+      uring_update(0);
+    else
+#endif // FILEIO_URING
+    {
+      submit();
+      if(active == THREADS)
+        threads_collect(false);
+    }
+
+    int n_done = call_back();
+    stats::set("fileio.in_flight", in_flight);
+    return n_done;
+  }
+
+  void wait()
+  {
+    while(busy())
+    {
+      // Sleep until at least one read finishes
+#ifdef FILEIO_URING
+      if(active == URING)
+      {
+        if(uring_update(finished.empty() ? 1 : 0) != EXIT_SUCCESS)
+          break;
+      }
+      else
+#endif // FILEIO_URING
+      {
+        submit();
+        if(active == THREADS)
+          threads_collect(finished.empty());
+      }
+      call_back();
+    }
+    stats::set("fileio.in_flight", in_flight);
+  }
+
+  bool busy()
+  {
+    return (in_flight > 0);
+  }
+}
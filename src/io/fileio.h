@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstddef>          // Needed for size_t
+#include <functional>
+#include <stdint.h>
+
+// Asynchronous file reads, queued from the main loop and finished there too:
+// read() only queues, submit() sends everything queued in one go and
+// update() calls back whoever's reads are done. On Linux (built against 5.6
+// headers or later) the reads go through io_uring (open, read and close all
+// queued in the kernel, no thread blocked); otherwise a few worker threads
+// do the blocking calls.
+// Not thread-safe: call everything from the same thread.
+
+#define FILEIO_DEPTH 256    // reads in the kernel at once
+
+namespace fileio
+{
+  enum backend_t
+  {
+    NONE,       // not started: reads are done on the spot
+    URING,
+    THREADS
+  };
+
+  // number of bytes read, or -1 if the file couldn't be read
+  typedef std::function<void(long)> done_t;
+
+  // use 'preferred' if this system has it, THREADS otherwise
+  int start(backend_t preferred = URING);
+
+  // finish the reads in flight and release the backend
+  int stop();
+
+  backend_t backend();
+
+  // queue a read of up to 'size' bytes at 'offset' into 'buffer', which must
+  // stay valid until 'done' is called (from update, never from here)
+  int read(const char* filepath, void* buffer, size_t size, done_t done,
+           uint64_t offset = 0);
+
+  // send the queued reads without waiting for any
+  int submit();
+
+  // submit, then call back the reads that finished: once per frame on the
+  // main loop; the number called back
+  int update();
+
+  // update until nothing is left in flight
+  void wait();
+
+  // are there reads queued or in flight?
+  bool busy();
+}
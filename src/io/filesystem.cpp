@@ -0,0 +1,118 @@
+#include "filesystem.h"
+
+#include <cstdlib>
+#include <cstdio>
+#include <cerrno>
+#include <cstring>
+#include <sys/stat.h>
+
+#ifdef WIN32
+  #include <direct.h>       // for _mkdir
+  #include <windows.h>      // for MoveFileEx, FindFirstFile
+#else
+  #include <dirent.h>       // for opendir
+#endif // WIN32
+
+using namespace std;
+
+#ifdef WIN32
+  // 1970-01-01 in FILETIME ticks
+  #define FILETIME_UNIX_EPOCH 116444736000000000LL
+#endif // WIN32
+
+namespace filesystem
+{
+  int status(const char* filepath, int64_t& mtime, uint64_t& size)
+  {
+#ifdef WIN32
+    // stat() only has seconds here: FILETIMEs count 100 ns from 1601
+    WIN32_FILE_ATTRIBUTE_DATA result;
+    if(!GetFileAttributesExA(filepath, GetFileExInfoStandard, &result))
+      return EXIT_FAILURE;
+
+    uint64_t ticks = ((uint64_t)result.ftLastWriteTime.dwHighDateTime << 32)
+                   | result.ftLastWriteTime.dwLowDateTime;
+    mtime = ((int64_t)ticks - FILETIME_UNIX_EPOCH) * 100;
+    size = ((uint64_t)result.nFileSizeHigh << 32) | result.nFileSizeLow;
+#else
+    struct stat result;
+    if(stat(filepath, &result) != 0)
+      return EXIT_FAILURE;
+
+  #ifdef __APPLE__
+    const struct timespec& modified = result.st_mtimespec;
+  #else
+    const struct timespec& modified = result.st_mtim;
+  #endif // __APPLE__
+    mtime = (int64_t)modified.tv_sec * 1000000000 + modified.tv_nsec;
+    size = (uint64_t)result.st_size;
+#endif // WIN32
+    return EXIT_SUCCESS;
+  }
+
+  int make_directory(const char* path)
+  {
+#ifdef WIN32
+    int result = _mkdir(path);
+#else
+    int result = mkdir(path, 0755);
+#endif // WIN32
+    return (result == 0 || errno == EEXIST) ? EXIT_SUCCESS : EXIT_FAILURE;
+  }
+
+  int replace(const char* from, const char* to)
+  {
+#ifdef WIN32
+    // rename() refuses to overwrite on Windows
+    if(!MoveFileExA(from, to, MOVEFILE_REPLACE_EXISTING))
+      return EXIT_FAILURE;
+#else
+    if(rename(from, to) != 0)
+      return EXIT_FAILURE;
+#endif // WIN32
+    return EXIT_SUCCESS;
+  }
+
+  int list(const char* path, vector<string>& files)
+  {
+#ifdef WIN32
+    WIN32_FIND_DATAA found;
+    HANDLE search = FindFirstFileA((string(path) + "/*").c_str(), &found);
+    if(search == INVALID_HANDLE_VALUE)
+      return EXIT_FAILURE;
+    do
+    {
+      const char* name = found.cFileName;
+      if(!strcmp(name, ".") || !strcmp(name, ".."))
+        continue;
+      string child = string(path) + "/" + name;
+      if(found.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)
+        list(child.c_str(), files);
+      else
+        files.push_back(child);
+    }
+    while(FindNextFileA(search, &found));
+    FindClose(search);
+#else
+    DIR* directory = opendir(path);
+    if(!directory)
+      return EXIT_FAILURE;
+    while(dirent* found = readdir(directory))
+    {
+      const char* name = found->d_name;
+      if(!strcmp(name, ".") || !strcmp(name, ".."))
+        continue;
+      string child = string(path) + "/" + name;
+      struct stat result;
+      if(stat(child.c_str(), &result) != 0)
+        continue;
+      if(S_ISDIR(result.st_mode))
+        list(child.c_str(), files);
+      else if(S_ISREG(result.st_mode))
+        files.push_back(child);
+    }
+    closedir(directory);
+#endif // WIN32
+    return EXIT_SUCCESS;
+  }
+}
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+// Small portable wrappers around the bits of the file system we need
+
+namespace filesystem
+{
+  // modification time (nanoseconds since 1970, as precise as the file
+  // system keeps it) and size in bytes, EXIT_FAILURE if missing
+  int status(const char* filepath, int64_t& mtime, uint64_t& size);
+
+  // create a directory if it doesn't already exist
+  int make_directory(const char* path);
+
+  // atomically replace 'to' by 'from'
+  int replace(const char* from, const char* to);
+
+  // append the regular files below a directory, recursively, as "path/name"
+  int list(const char* path, std::vector<std::string>& files);
+}
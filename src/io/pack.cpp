@@ -0,0 +1,273 @@
+//! --------------------------------------------------------------------------
+//! -------------------------- INCLUDES
+//! --------------------------------------------------------------------------
+
+#include "pack.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <climits>
+#include <string>
+
+#include "SDL.h"                    // Needed for SDL_RWops
+#include "zlib.h"                   // Needed for uncompress
+
+#include "MappedFile.hpp"
+#include "filesystem.h"
+#include "../debug/warn.h"
+#include "../debug/stats.h"
+
+using namespace std;
+
+//! --------------------------------------------------------------------------
+//! -------------------------- UTILITIES
+//! --------------------------------------------------------------------------
+
+namespace
+{
+  // Only written by open() and close(), before and after any lookup
+  static MappedFile mapping;
+  static const pack::entry_t* entries = nullptr;
+  static const char* names = nullptr;
+  static uint32_t count = 0;
+  static string base_path;
+
+  // Whatever the pack says, never read outside the mapping
+  bool validate(const pack::header_t& header)
+  {
+    uint64_t size = mapping.getSize();
+    if(header.index > size
+    || header.count > (size - header.index) / sizeof(pack::entry_t)
+    || header.names < header.index + header.count*sizeof(pack::entry_t)
+    || header.names > size)
+      return false;
+
+    const pack::entry_t* index =
+      (const pack::entry_t*)(mapping.getData() + header.index);
+    uint64_t names_size = size - header.names;
+    for(uint32_t i = 0; i < header.count; i++)
+    {
+      // Stored entries are handed out as they are, and nothing inflates to
+      // more than SDL can stream (it counts in ints)
+      bool deflated = (index[i].flags & pack::DEFLATED);
+      if(index[i].offset > size || index[i].size > size - index[i].offset
+      || (!deflated && index[i].original_size != index[i].size)
+      || (deflated && index[i].original_size > INT_MAX)
+      || index[i].name >= names_size
+      || !memchr(mapping.getData() + header.names + index[i].name, '\0',
+                 names_size - index[i].name)
+      || (i > 0 && index[i - 1].id >= index[i].id))
+        return false;
+    }
+    return true;
+  }
+
+  int inflate(const pack::entry_t& entry, unsigned char* destination)
+  {
+    uLongf inflated = (uLongf)entry.original_size;
+    if(uncompress(destination, &inflated, mapping.getData() + entry.offset,
+                  (uLong)entry.size) != Z_OK
+    || inflated != entry.original_size)
+      WARN_RTN("pack::inflate", "Corrupt entry", EXIT_FAILURE);
+    return EXIT_SUCCESS;
+  }
+
+  // Inflated entries live in a buffer of their own that goes with the stream
+  int SDLCALL close_inflated(SDL_RWops* stream)
+  {
+    free(stream->hidden.mem.base);
+    SDL_FreeRW(stream);
+    return 0;
+  }
+}
+
+//! --------------------------------------------------------------------------
+//! -------------------------- INTERFACE
+//! --------------------------------------------------------------------------
+
+namespace pack
+{
+  int open(const char* filepath)
+  {
+    // Free any previous pack
+    if(isOpen())
+      close();
+
+    char* executable_path = SDL_GetBasePath();
+    if(executable_path)
+    {
+      base_path = executable_path;
+      SDL_free(executable_path);
+    }
+
+    // Quietly: without a pack, the loose files are used
+    string path = loose(filepath);
+    int64_t mtime;
+    uint64_t size;
+    if(filesystem::status(path.c_str(), mtime, size) != EXIT_SUCCESS
+    || mapping.open(path.c_str()) != EXIT_SUCCESS)
+      return EXIT_FAILURE;
+
+    header_t header;
+    if(mapping.getSize() < sizeof(header))
+    {
+      mapping.close();
+      WARN_RTN("pack::open", "Truncated pack", EXIT_FAILURE);
+    }
+    memcpy(&header, mapping.getData(), sizeof(header));
+    if(memcmp(header.magic, PACK_MAGIC, 4) || header.version != PACK_VERSION
+    || !validate(header))
+    {
+      mapping.close();
+      WARN_RTN("pack::open", "Invalid pack", EXIT_FAILURE);
+    }
+
+    entries = (const entry_t*)(mapping.getData() + header.index);
+    names = (const char*)(mapping.getData() + header.names);
+    count = header.count;
+
+    // So that every asset's identifier can be logged by name
+#ifdef DEBUG
+    for(uint32_t i = 0; i < count; i++)
+      hashid::intern(names + entries[i].name);
+#endif // DEBUG
+    return EXIT_SUCCESS;
+  }
+
+  int close()
+  {
+    entries = nullptr;
+    names = nullptr;
+    count = 0;
+    return mapping.close();
+  }
+
+  bool isOpen()
+  {
+    return (entries != nullptr);
+  }
+
+  const entry_t* find(hashid_t id)
+  {
+    if(!isOpen())
+      return nullptr;
+
+    uint32_t first = 0, last = count;
+    while(first < last)
+    {
+      uint32_t middle = first + (last - first)/2;
+      if(entries[middle].id < id)
+        first = middle + 1;
+      else
+        last = middle;
+    }
+    return (first < count && entries[first].id == id) ? &entries[first]
+                                                      : nullptr;
+  }
+
+  const entry_t* find(const char* path)
+  {
+    return find(hashid::hash(path));
+  }
+
+  int view(hashid_t id, span_t& span)
+  {
+    const entry_t* entry = find(id);
+    if(!entry || (entry->flags & DEFLATED))
+      return EXIT_FAILURE;
+
+    span.data = mapping.getData() + entry->offset;
+    span.size = (size_t)entry->size;
+    stats::count("pack.view");
+    return EXIT_SUCCESS;
+  }
+
+  int view(const char* path, span_t& span)
+  {
+    return view(hashid::hash(path), span);
+  }
+
+  string loose(const char* path)
+  {
+    int64_t mtime;
+    uint64_t size;
+    if(filesystem::status(path, mtime, size) != EXIT_SUCCESS
+    && !base_path.empty())
+    {
+      string beside = base_path + path;
+      if(filesystem::status(beside.c_str(), mtime, size) == EXIT_SUCCESS)
+        return beside;
+    }
+    return path;
+  }
+
+  int read(const char* path, vector<unsigned char>& contents)
+  {
+    return read(hashid::hash(path), path, contents);
+  }
+
+  int read(hashid_t id, const char* path, vector<unsigned char>& contents)
+  {
+    const entry_t* entry = find(id);
+    if(entry)
+    {
+      contents.resize((size_t)entry->original_size);
+      if(!(entry->flags & DEFLATED))
+      {
+        memcpy(contents.data(), mapping.getData() + entry->offset,
+               contents.size());
+        stats::count("pack.read");
+        return EXIT_SUCCESS;
+      }
+      stats::count("pack.inflate");
+      return inflate(*entry, contents.data());
+    }
+
+    // Not in the pack: fall back to the loose file
+    MappedFile file;
+    if(file.open(loose(path).c_str()) != EXIT_SUCCESS)
+      return EXIT_FAILURE;
+    contents.assign(file.getData(), file.getData() + file.getSize());
+    stats::count("pack.loose");
+    return EXIT_SUCCESS;
+  }
+
+  SDL_RWops* open_rw(const char* path)
+  {
+    return open_rw(hashid::hash(path), path);
+  }
+
+  SDL_RWops* open_rw(hashid_t id, const char* path)
+  {
+    const entry_t* entry = find(id);
+    if(!entry)
+    {
+      stats::count("pack.loose");
+      return SDL_RWFromFile(loose(path).c_str(), "rb");
+    }
+
+    // Stored: read straight from the mapped pages
+    if(!(entry->flags & DEFLATED))
+    {
+      stats::count("pack.view");
+      return SDL_RWFromConstMem(mapping.getData() + entry->offset,
+                                (int)entry->size);
+    }
+
+    // Deflated: the stream owns the inflated copy
+    stats::count("pack.inflate");
+    unsigned char* inflated =
+      (unsigned char*)malloc(entry->original_size ? entry->original_size : 1);
+    SDL_RWops* stream = inflated ?
+      SDL_RWFromConstMem(inflated, (int)entry->original_size) : nullptr;
+    if(!stream || inflate(*entry, inflated) != EXIT_SUCCESS)
+    {
+      if(stream)
+        SDL_FreeRW(stream);
+      free(inflated);
+      return nullptr;
+    }
+    stream->close = close_inflated;
+    return stream;
+  }
+}
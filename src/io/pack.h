@@ -0,0 +1,90 @@
+#pragma once
+
+#include <cstddef>          // Needed for size_t
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+#include "../hashid.h"
+
+struct SDL_RWops;
+
+// Read-only archive of assets (".pak"), written offline by the pack tool and
+// mapped into memory once at start-up. Entries keep the relative path they
+// had on disk ("assets/font.png") and are found by binary search on its
+// hashid, comparing integers only: the pack tool refuses paths that collide.
+// Stored entries are handed out in place, without a copy; deflated ones are
+// inflated on demand. Anything missing from the pack is read from the loose
+// file instead. Data is little-endian.
+//
+//    header_t | data (each entry PACK_ALIGN-aligned) | entry_t[count] | names
+
+#define PACK_MAGIC "RPAK"
+#define PACK_VERSION 2
+// entries start on a page boundary so the mapping can feed GL directly
+#define PACK_ALIGN 4096
+
+namespace pack
+{
+  enum flag_t
+  {
+    DEFLATED = 1      // zlib stream, 'size' bytes inflate to 'original_size'
+  };
+
+  struct header_t
+  {
+    char magic[4];
+    uint32_t version;
+    uint32_t count;         // number of entries
+    uint32_t flags;         // unused for now
+    uint64_t index;         // offset of the entries, sorted by id
+    uint64_t names;         // offset of the path names, '\0'-terminated
+  };
+
+  struct entry_t
+  {
+    hashid_t id;            // of the path
+    uint64_t offset;        // of the data from the start of the pack
+    uint64_t size;          // number of bytes stored
+    uint64_t original_size; // number of bytes once inflated
+    uint64_t content_hash;  // hashid::hash of the bytes once inflated
+    uint32_t flags;
+    uint32_t name;          // offset of the path from the start of the names
+  };
+
+  // A view into the mapped pack: valid until close()
+  struct span_t
+  {
+    const unsigned char* data;
+    size_t size;
+  };
+
+  // map the pack, looking next to the executable if the working directory
+  // doesn't have it
+  int open(const char* filepath);
+  int close();
+  bool isOpen();
+
+  // entry for this path, or nullptr if the pack doesn't have it
+  const entry_t* find(hashid_t id);
+  const entry_t* find(const char* path);
+
+  // stored entries without any copy, EXIT_FAILURE if missing or deflated
+  int view(hashid_t id, span_t& span);
+  int view(const char* path, span_t& span);
+
+  // where the loose file is: next to the executable if the working
+  // directory doesn't have it, the path as it is otherwise
+  std::string loose(const char* path);
+
+  // contents from the pack (inflated if needed) or from the loose file;
+  // given the path's id, nothing is hashed unless the pack lacks it
+  int read(const char* path, std::vector<unsigned char>& contents);
+  int read(hashid_t id, const char* path,
+           std::vector<unsigned char>& contents);
+
+  // stream for SDL (IMG_Load_RW and friends) over the mapped memory, or over
+  // the loose file if the pack doesn't have it: nullptr if neither exists
+  SDL_RWops* open_rw(const char* path);
+  SDL_RWops* open_rw(hashid_t id, const char* path);
+}
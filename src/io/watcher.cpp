@@ -0,0 +1,203 @@
+//! --------------------------------------------------------------------------
+//! -------------------------- INCLUDES
+//! --------------------------------------------------------------------------
+
+#include "watcher.h"
+
+#include <cstdlib>
+#include <algorithm>
+#include <map>
+#include <set>
+#include <stdint.h>
+
+#ifdef __linux__
+  #include <sys/inotify.h>
+  #include <poll.h>
+  #include <unistd.h>
+#else
+  #include <thread>
+  #include <chrono>
+#endif // __linux__
+
+#include "filesystem.h"
+#include "../debug/warn.h"
+
+using namespace std;
+
+//! --------------------------------------------------------------------------
+//! -------------------------- UTILITIES
+//! --------------------------------------------------------------------------
+
+namespace
+{
+  // Only report each path once per call
+  void append(vector<string>& changed, size_t first, const string& path)
+  {
+    if(find(changed.begin() + first, changed.end(), path) == changed.end())
+      changed.push_back(path);
+  }
+
+#ifdef __linux__
+
+  static int descriptor = -1;
+  static map<int, string> directories;    // by watch descriptor
+
+#else
+
+  struct status_t
+  {
+    int64_t mtime;
+    uint64_t size;
+    bool operator!=(const status_t& other) const
+      { return mtime != other.mtime || size != other.size; }
+  };
+  static string root;
+  static map<string, status_t> files;
+  static bool watching = false;
+
+  void scan(map<string, status_t>& result)
+  {
+    vector<string> paths;
+    filesystem::list(root.c_str(), paths);
+    for(size_t i = 0; i < paths.size(); i++)
+    {
+      status_t status;
+      if(filesystem::status(paths[i].c_str(), status.mtime, status.size)
+          == EXIT_SUCCESS)
+        result[paths[i]] = status;
+    }
+  }
+
+#endif // __linux__
+}
+
+//! --------------------------------------------------------------------------
+//! -------------------------- INTERFACE
+//! --------------------------------------------------------------------------
+
+namespace watcher
+{
+#ifdef __linux__
+
+  int start(const char* directory)
+  {
+    stop();
+
+    vector<string> paths;
+    if(filesystem::list(directory, paths) != EXIT_SUCCESS)
+      WARN_RTN("watcher::start", "Could not list directory", EXIT_FAILURE);
+
+    descriptor = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if(descriptor < 0)
+      WARN_RTN("watcher::start", "Could not create inotify instance",
+               EXIT_FAILURE);
+
+    // inotify isn't recursive: watch every directory that has files
+    set<string> watched;
+    watched.insert(directory);
+    for(size_t i = 0; i < paths.size(); i++)
+      watched.insert(paths[i].substr(0, paths[i].rfind('/')));
+
+    // Editors either write in place or write elsewhere and rename over
+    for(set<string>::iterator i = watched.begin(); i != watched.end(); i++)
+    {
+      int watch = inotify_add_watch(descriptor, i->c_str(),
+                                    IN_CLOSE_WRITE | IN_MOVED_TO);
+      if(watch < 0)
+      {
+        stop();
+        WARN_RTN("watcher::start", "Could not watch directory",
+                 EXIT_FAILURE);
+      }
+      directories[watch] = *i;
+    }
+    return EXIT_SUCCESS;
+  }
+
+  int stop()
+  {
+    if(descriptor >= 0)
+      close(descriptor);
+    descriptor = -1;
+    directories.clear();
+    return EXIT_SUCCESS;
+  }
+
+  int wait(vector<string>& changed, int timeout_ms)
+  {
+    if(descriptor < 0)
+      return 0;
+
+    pollfd readable = { descriptor, POLLIN, 0 };
+    if(poll(&readable, 1, timeout_ms) <= 0)
+      return 0;
+
+    // Take everything that's queued: a save is often several events
+    size_t first = changed.size();
+    char buffer[4096]
+      __attribute__ ((aligned(__alignof__(struct inotify_event))));
+    ssize_t length;
+    while((length = read(descriptor, buffer, sizeof(buffer))) > 0)
+    {
+      for(char* i = buffer; i < buffer + length; )
+      {
+        const inotify_event* event = (const inotify_event*)i;
+        i += sizeof(inotify_event) + event->len;
+
+        map<int, string>::iterator directory = directories.find(event->wd);
+        if(event->len == 0 || (event->mask & IN_ISDIR)
+        || directory == directories.end())
+          continue;
+        append(changed, first, directory->second + "/" + event->name);
+      }
+    }
+    return changed.size() - first;
+  }
+
+#else
+
+  int start(const char* directory)
+  {
+    stop();
+
+    int64_t mtime;
+    uint64_t size;
+    if(filesystem::status(directory, mtime, size) != EXIT_SUCCESS)
+      WARN_RTN("watcher::start", "Could not find directory", EXIT_FAILURE);
+
+    root = directory;
+    scan(files);
+    watching = true;
+    return EXIT_SUCCESS;
+  }
+
+  int stop()
+  {
+    files.clear();
+    watching = false;
+    return EXIT_SUCCESS;
+  }
+
+  int wait(vector<string>& changed, int timeout_ms)
+  {
+    if(!watching)
+      return 0;
+
+    // No notifications here: look again once the time is up
+    this_thread::sleep_for(chrono::milliseconds(timeout_ms));
+
+    size_t first = changed.size();
+    map<string, status_t> now;
+    scan(now);
+    for(map<string, status_t>::iterator i = now.begin(); i != now.end(); i++)
+    {
+      map<string, status_t>::iterator before = files.find(i->first);
+      if(before == files.end() || before->second != i->second)
+        append(changed, first, i->first);
+    }
+    files.swap(now);
+    return changed.size() - first;
+  }
+
+#endif // __linux__
+}
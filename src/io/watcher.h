@@ -0,0 +1,22 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+// Tells when files below a directory are written to: inotify on Linux, a
+// comparison of modification times elsewhere. Only one directory (and the
+// sub-directories it has when watching starts) is watched at a time, and
+// only from one thread.
+
+namespace watcher
+{
+  // start watching, EXIT_FAILURE if the directory can't be watched
+  int start(const char* directory);
+
+  // stop watching
+  int stop();
+
+  // wait up to 'timeout_ms' for changes and append the paths of the files
+  // that changed, as "directory/name", each once: the number appended
+  int wait(std::vector<std::string>& changed, int timeout_ms);
+}
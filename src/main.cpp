@@ -3,17 +3,46 @@
 //! --------------------------------------------------------------------------
 
 #include <cstdlib>
+#include <cstdio>
 #include <SDL.h>
 #include <ctime>
 
 #include "debug/assert.h"
+#include "debug/stats.h"
+#include "debug/warn.h"
 
 #include "graphics/opengl.h"
 #include "graphics/Texture.hpp"
+#include "graphics/extensions.h"
+#include "graphics/uploader.h"
+#include "graphics/DirtyRegion.hpp"
+#include "graphics/RenderQueue.hpp"
+#include "graphics/Camera.hpp"
+#include "graphics/Animator.hpp"
+#include "graphics/DynamicResolution.hpp"
+#include "graphics/Layer.hpp"
+#include "graphics/glstate.h"
+#include "graphics/capture.h"
+#include "graphics/pacing.h"
+#include "graphics/hotreload.h"
+#include "graphics/Font.hpp"
+#include "graphics/Text.hpp"
+
+#include "input/input.h"
+#include "io/pack.h"
+#include "io/fileio.h"
+
+#include "memory/frame.h"
+#include "memory/heap.h"
+#include "memory/vram.h"
+
+#include "events/events.h"
 
 #include "math/wjd_math.h"
 
 #include "global.hpp"
+#include "gamestates.h"
+#include "startup.h"
 
 #include <functional>
 
@@ -23,11 +52,31 @@ using namespace std;
 //! -------------------------- CONSTANTS
 //! --------------------------------------------------------------------------
 
+// How long to sleep waiting for input when there's nothing to draw
+#define IDLE_WAIT_MS 100
+
+// Say so if the window takes longer than this to show after launching
+#define WINDOW_VISIBLE_MS 100
+
+// Size of the floor tiles in game
+#define TILE_SIZE 64
+
+// How finely the title's movements are sampled, in keys per second
+#define TITLE_KEYS 32
+
 // --------------------------------------------------------------------------
-// EVENTS
+// ACTIONS
 // --------------------------------------------------------------------------
 
-#define EVENT_QUIT 0b00000001
+enum
+{
+  ACTION_CONFIRM,
+  ACTION_BACK,
+  ACTION_OVERLAY,     // statistics
+  ACTION_SCREENSHOT,
+  ACTION_RECORD,      // start/stop
+  ACTION_RAW          // held while starting to record: raw frames
+};
 
 //! --------------------------------------------------------------------------
 //! -------------------------- WORKSPACE
@@ -36,86 +85,169 @@ using namespace std;
 
 
 static SDL_Window *window;
+static SDL_GLContext context;
+
+// Number of frames to redraw in full (one per buffer)
+static int full_redraws = 2;
+
+// Gamestates submit their sprites here rather than drawing them directly
+static RenderQueue render_queue;
+
+// What part of the world is on screen
+static Camera camera;
+
+// Every sprite animation, advanced together once per update
+static Animator animator;
+
+// Scales the world's resolution to keep the frame-rate up
+static DynamicResolution resolution;
+
+// The ingame floor, rendered once rather than a tile at a time every frame
+static Layer ground;
+
+// When the current frame started, to measure the CPU's share of it
+static double frame_start;
+
+// Statistics drawn over the game, toggled with F3
+static Font font;
+static Text overlay(font);
+static bool show_overlay = false;
+static const fV2 overlay_position(8, 8);
+
+// Set by the first events::QUIT dispatched
+static bool quitting = false;
 
 //! --------------------------------------------------------------------------
 //! -------------------------- GAME STATES
 //! --------------------------------------------------------------------------
 
-// --------------------------------------------------------------------------
-// GAMESTATE STRUCTURE
-// --------------------------------------------------------------------------
-
-struct gamestate_t
-{
-    function<int(float)> update;
-    function<int()> draw;
-    function<int(SDL_Event &event)> treatEvent;
-    function<int(gamestate_t &previous)> enter;
-    function<int(gamestate_t &next)> leave;
-};
 // --------------------------------------------------------------------------
 // TITLE GAMESTATE
 // --------------------------------------------------------------------------
-gamestate_t title, ingame, &current_state=title;
+gamestate_t title, ingame;
 
 int createStates(){
 
     {
 
-    float t = 0.0f;
-
-    float entering = -1.0f;
-    float exiting = -1.0f;
-    Texture texture;
-    fRect sprite(0, 0, 256, 256);
-
-    title.update = [&entering, &exiting, &t, &sprite](float dt)
+    // Static: the lambdas below keep referring to these after we return
+    static enum { WAITING, ENTERING, BOBBING, EXITING } phase = WAITING;
+    static gamestate_t* leaving_to = nullptr;  // quit if null
+    static Texture texture;
+    static int loading = 0;
+    static fRect sprite(0, 0, 256, 256), drawn;
+
+    // The animator moves the title: in, up and down, then off to the right
+    static uint32_t entering = ANIMATOR_NO_SEQUENCE, bobbing, exiting;
+    static handle_t motion = NO_HANDLE;
+    static iV2 keyed_for;         // size of the screen the keys were made for
+    static float exit_size = 256; // the title shrinks from this when leaving
+
+    // Sample the movements into keys, for the whole screen
+    static auto keys = []()
     {
-        log("Title update %f", dt);
+        const float vw = global::viewport.x, vh = global::viewport.y;
+        fRect in[TITLE_KEYS + 1], out[TITLE_KEYS + 1], bob[TITLE_KEYS];
+        for(int k = 0; k <= TITLE_KEYS; k++)
+        {
+          float p = (float)k/TITLE_KEYS;
+          p *= p; // quadratic
 
+          float s = 256*p;
+          in[k] = fRect(vw*0.5f*p - s*0.5f, vh*0.5f - s*0.5f, s, s);
 
-      // EXIT HAS STARTED
-      if(exiting >= 0)
-      {
-        exiting += dt;
+          s = exit_size*(1.0f - p);
+          out[k] = fRect(vw*(0.5f + 0.5f*p) + s*0.5f*p - s*0.5f,
+                         vh*0.5f - s*0.5f, s, s);
+        }
+        for(int k = 0; k < TITLE_KEYS; k++)
+        {
+          float wheel = sin(PI*2*k/TITLE_KEYS);
+          float s = 196 + 64*wheel;
+          bob[k] = fRect(vw*0.5f - s*0.5f, vh*0.5f - s*0.5f + 0.2f*s*wheel,
+                         s, s);
+        }
 
-        float s = 256*(1.0f - exiting);
-        log("viewport %f",global::viewport.x);
-        /*sprite.x = global::viewport.x * (0.5f + 0.5f * exiting) + s*0.5f*exiting - s*0.5f;
-        sprite.y = global::viewport.y * 0.5f - s*0.5f;
-        sprite.w = sprite.h = s;*/
+        if(entering == ANIMATOR_NO_SEQUENCE)
+        {
+          entering = animator.addMotion(in, TITLE_KEYS + 1, TITLE_KEYS);
+          bobbing = animator.addMotion(bob, TITLE_KEYS, TITLE_KEYS,
+                                       Animator::LOOP);
+          exiting = animator.addMotion(out, TITLE_KEYS + 1, TITLE_KEYS);
+        }
+        else
+        {
+          animator.setKeys(entering, in);
+          animator.setKeys(bobbing, bob);
+          animator.setKeys(exiting, out);
+        }
+        keyed_for = global::viewport;
+    };
 
-        if(exiting > 1)
-          return EVENT_QUIT;
-      }
+    // Switch to another movement, leaving the last one
+    static auto animate = [](uint32_t sequence)
+    {
+        if(motion != NO_HANDLE)
+          animator.stop(motion);
+        motion = animator.play(sequence);
+        sprite = animator.getRect(motion);
+    };
 
-      // ENTER HAS STARTED
-      else if(entering >= 0 && entering < 1)
-      {
-        entering += dt;
+    static auto fly_off = [](gamestate_t* next)
+    {
+        leaving_to = next;
+        phase = EXITING;
+        // Shrink from wherever the title was in its bobbing
+        exit_size = sprite.w;
+        keys();
+        animate(exiting);
+    };
 
-        float s = 256*entering;
+    title.update = [](float dt)
+    {
+      // WAITING FOR ENTER: nothing moves
+      if(phase == WAITING)
+        return EVENT_IDLE;
 
-        /*sprite.x = global::viewport.x * 0.5f * entering - s*0.5f;
-        sprite.y = global::viewport.y * 0.5f - s*0.5f;
-        sprite.w = sprite.h = s;*/
+      if(keyed_for.x != global::viewport.x
+      || keyed_for.y != global::viewport.y)
+        keys();
 
-        if(entering > 1)
-          entering = 1;
-      }
+      // The animator has already moved on for this update
+      const vector<Animator::event_t>& reached = animator.getEvents();
+      for(size_t i = 0; i < reached.size(); i++)
+      {
+        if(reached[i].type != Animator::FINISHED
+        || reached[i].instance != motion)
+          continue;
 
+        // ENTER HAS FINISHED
+        if(phase == ENTERING)
+        {
+          phase = BOBBING;
+          animate(bobbing);
+        }
 
+        // EXIT HAS FINISHED
+        else if(phase == EXITING)
+        {
+          events::publish(leaving_to ? events::STATE_LEFT : events::QUIT);
+          return 0;
+        }
+      }
+      sprite = animator.getRect(motion);
 
-        //All okay
-        return 0;
+      //All okay
+      return 0;
     };
 
-    title.draw = [entering, exiting, &texture, &sprite]()
+    title.draw = []()
     {
         // Only draw if enter has begun
-        if(entering > 0 && exiting <1)
+        if(phase != WAITING && sprite.w > 0)
         {
-            texture.draw(nullptr, &sprite);
+            render_queue.push(RenderQueue::key(0, true, texture.getHandle(), 0),
+                              texture, nullptr, sprite);
         }
 
 
@@ -123,61 +255,187 @@ int createStates(){
         return 0;
     };
 
-    title.treatEvent = [&entering, &exiting](SDL_Event &event)
+    title.damage = [](DirtyRegion &region)
     {
+        // Wherever the sprite was, and wherever it is now
+        region.add(drawn);
+        region.add(sprite);
+        drawn = sprite;
+    };
 
-        switch (event.type)
+    title.treatInput = [](const input::snapshot_t &input)
+    {
+        if(input.wasPressed(ACTION_CONFIRM))
         {
-          // Exit if the window is closed (ex: pressing the cross at the top)
-          case SDL_QUIT:
-            return EVENT_QUIT;
-          break;
-
-          // Check for key-presses
-          case SDL_KEYDOWN:
-            switch (event.key.keysym.sym)
+            if(phase == WAITING)
             {
-              case SDLK_RETURN:
-                if(entering < 0)
-                  entering = 0;
-              break;
-
-              case SDLK_ESCAPE:
-                if(entering >= 1 && exiting < 0)
-                  exiting = 0;
-              default:
-                break;
+              phase = ENTERING;
+              animate(entering);
             }
-          break;
-
-          default:
-            // not all possible inputs are needed, so we DO want a default break
-          break;
+            // Start loading the game while the title flies off
+            else if(phase == BOBBING
+            && gamestates::replace(ingame) == EXIT_SUCCESS)
+              fly_off(&ingame);
+        }
+        else if(input.wasPressed(ACTION_BACK))
+        {
+            if(phase == BOBBING)
+              fly_off(nullptr);
         }
         return 0;
     };
-    title.leave = [&texture](gamestate_t &next)
+    title.leave = [](gamestate_t &next)
     {
         log("Leaving title");
 
+        if(motion != NO_HANDLE)
+          animator.stop(motion);
+        motion = NO_HANDLE;
         texture.unload();
         return 0;
     };
-    title.enter = [&texture](gamestate_t &previous)
+    title.prepare = []()
+    {
+        //load all the assets we need, in the background
+        loading++;
+        return uploader::load("assets/eye_of_draining.png"_id,
+                              "assets/eye_of_draining.png", texture,
+                              [](int result)
+        {
+            WARN_IF(result != EXIT_SUCCESS, "Opening texture",
+                    "assets/eye_of_draining.png");
+            loading--;
+        });
+    };
+    title.ready = []()
+    {
+        return (loading == 0);
+    };
+    title.enter = [](gamestate_t &previous)
     {
         log("Entering title");
 
-        //load all the assets we need
-        ASSERT(texture.load("assets/eye_of_draining.png") == EXIT_SUCCESS, "Opening texture");
+        // Start over, waiting for enter
+        phase = WAITING;
+        leaving_to = nullptr;
+        keys();
+        return 0;
+    };
+
+    }
+
+    // --------------------------------------------------------------------------
+    // INGAME GAMESTATE
+    // --------------------------------------------------------------------------
+
+    {
+
+    static Texture ice, lava;
+    static iV2 ground_size;    // of the screen the ground layer was made for
+    static int loading = 0;
+
+    // Checkerboard of ice and lava over the whole screen: drawn straight
+    // away into the ground layer, or queued tile by tile without one
+    static auto tiles = [](bool queued)
+    {
+        for(int y = 0; y*TILE_SIZE < global::viewport.y; y++)
+        for(int x = 0; x*TILE_SIZE < global::viewport.x; x++)
+        {
+            Texture& tile = ((x + y) % 2) ? lava : ice;
+            fRect dst(x*TILE_SIZE, y*TILE_SIZE, TILE_SIZE, TILE_SIZE);
+            if(queued)
+              render_queue.push(RenderQueue::key(0, false, tile.getHandle(),
+                                                 0), tile, nullptr, dst);
+            else
+              tile.draw(nullptr, &dst);
+        }
+    };
+
+    ingame.update = [](float dt)
+    {
+        // The floor doesn't move
+        return EVENT_IDLE;
+    };
+
+    ingame.draw = []()
+    {
+        // A layer the size of the screen, made again if that changes
+        if(ground_size.x != global::viewport.x
+        || ground_size.y != global::viewport.y)
+        {
+          ground.create(global::viewport.x, global::viewport.y,
+                        []() { tiles(false); });
+          ground_size = global::viewport;
+        }
 
+        // One quad for the whole floor (opaque, so the layer's premultiplied
+        // colours blend as usual) unless there are no framebuffer objects
+        if(ground.update())
+        {
+          RenderTarget& target = ground.getTarget();
+          fRect area(target.getUsed());
+          render_queue.push(RenderQueue::key(0, false, target.getHandle(), 0),
+                            target, &area, area);
+        }
+        else
+          tiles(true);
+        return 0;
+    };
+
+    ingame.damage = [](DirtyRegion &region)
+    {
+        // Nothing ever changes once it's on screen
+    };
+
+    ingame.treatInput = [](const input::snapshot_t &input)
+    {
+        // Back to the title, nothing to animate on the way out
+        if(input.wasPressed(ACTION_BACK)
+        && gamestates::replace(title) == EXIT_SUCCESS)
+          events::publish(events::STATE_LEFT);
+        return 0;
+    };
+
+    ingame.prepare = []()
+    {
+        // Called while the title is still leaving
+        auto done = [](int result)
+        {
+            WARN_IF(result != EXIT_SUCCESS, "Opening texture", "ingame tiles");
+            loading--;
+        };
+        loading += 2;
+        uploader::load("assets/ice0.png"_id, "assets/ice0.png", ice, done);
+        uploader::load("assets/lava0.png"_id, "assets/lava0.png", lava, done);
+        return EXIT_SUCCESS;
+    };
+
+    ingame.ready = []()
+    {
+        return (loading == 0);
+    };
+
+    ingame.enter = [](gamestate_t &previous)
+    {
+        log("Entering game");
+        return 0;
+    };
+
+    ingame.leave = [](gamestate_t &next)
+    {
+        log("Leaving game");
+
+        ground.destroy();
+        ground_size = iV2(0, 0);
+        ice.unload();
+        lava.unload();
         return 0;
     };
 
     }
 
-    //initialise initial state
-    current_state.enter(current_state);
-    return EXIT_SUCCESS;
+    //start loading the initial state
+    return gamestates::preload(title);
 }
 
 //! --------------------------------------------------------------------------
@@ -191,73 +449,169 @@ int update(float dt)
   if(dt > MAX_DT)
     dt = MAX_DT;
 
+  // Animations first: the states read where they got to
+  animator.update(dt);
+
     //Update, accumulate event flags
-  int flags = current_state.update(dt);
-// Static to avoid reallocating it ever time we run the function
-  static SDL_Event event;
+  gamestate_t* previous_state = gamestates::top();
+  int flags = gamestates::update(dt);
 
-    float p = exiting*exiting; // quadratic
+  // Read all the input of this tick at once
+  const input::snapshot_t& input = input::poll();
+  flags |= gamestates::treatInput(input);
 
-    float wheel = sin(PI*2*t);
+  // Exit if the window is closed (ex: pressing the cross at the top)
+  if(input.quit)
+    events::publish(events::QUIT);
 
-    float s = (196 + 64*wheel)*(1.0f - p);
+  // The window was exposed, resized, ...: its contents are lost
+  if(input.window_changed)
+    full_redraws = 2;
 
-    sprite.x = global::viewport.x * (0.5f + 0.5f * p) + s*0.5f*p - s*0.5f;
-    sprite.y = global::viewport.y * 0.5f - s*0.5f;
-    sprite.w = sprite.h = s;
+  // Nobody's watching: no need to go flat out
+  pacing::focus(input.focused);
 
-  while (SDL_PollEvent(&event))
+  if(input.wasPressed(ACTION_OVERLAY))
   {
-  /*      flags |= current_state.treatEvent(event);
+    show_overlay = !show_overlay;
+    full_redraws = 2;
   }
+  if(input.wasPressed(ACTION_SCREENSHOT))
+    capture::screenshot();
+  if(input.wasPressed(ACTION_RECORD))
+    capture::record(!capture::recording(), input.isDown(ACTION_RAW)
+                                           ? capture::RAW : capture::PNG);
 
-  // No event
-  return flags;*/
-
-    entering += dt;
+  // Handle what the states and other threads published, switches included
+  events::dispatch();
 
-    float p = entering*entering; // quadratic
+  // Images saved since the last frame are already in their textures
+  if(hotreload::update())
+  {
+    ground.invalidate();
+    full_redraws = 2;
+  }
 
-    float s = 256*p;
+  // A new state has nothing on screen yet
+  if(gamestates::top() != previous_state)
+    full_redraws = 2;
 
-    sprite.x = global::viewport.x * 0.5f * p - s*0.5f;
-    sprite.y = global::viewport.y * 0.5f - s*0.5f;
-    sprite.w = sprite.h = s;
+  // Any input may have changed something; recordings and animations need
+  // every frame
+  if(input.n_events || full_redraws || capture::busy()
+  || animator.isPlaying())
+    flags &= ~EVENT_IDLE;
 
-    if(entering > 1)
-      entering = 1;
-  }
-
-  // ENTER HAS FINISHED
-  else
-  {
-    t += dt;
-    if(t > 1)
-      t -= 1;
-    float wheel = sin(PI*2*t);
+  return flags;
+}
 
-    float s = 196 + 64*wheel;
-    sprite.x = global::viewport.x * 0.5f - s*0.5f;
-    sprite.y = global::viewport.y * 0.5f - s*0.5 + 0.2f*s*wheel;
-    sprite.h = sprite.w = s;
+void update_overlay()
+{
+  // Only laid out again when one of the numbers actually changes
+  char line[256];
+  snprintf(line, sizeof(line),
+           "busy     %6.2f ms\n"
+           "sprites  %6.0f (%.0f culled)\n"
+           "gl calls %6.0f (%.0f skipped)\n"
+           "heap     %6.0f allocations\n"
+           "memory   %6.1f MB (%.1f MB textures)\n"
+           "scale    %6.2f",
+           stats::get("frame.busy"),
+           stats::get("render.commands"), stats::get("render.culled"),
+           stats::get("gl.issued"), stats::get("gl.skipped"),
+           stats::get("heap.allocations"),
+           stats::get("memory.heap.kb")/1024.0,
+           stats::get("memory.vram.kb")/1024.0,
+           resolution.isActive() ? resolution.getScale() : 1.0);
+  overlay.set(line);
+}
 
-  }
+void draw_overlay()
+{
+  if(!show_overlay)
+    return;
 
-  // Treat input events
-  return treatEvents();
+  // Screen space, whatever the camera is doing
+  glstate::matrix_mode(GL_MODELVIEW);
+  glPushMatrix();
+  glLoadIdentity();
+  font.print(overlay, overlay_position);
+  font.flush();
+  glPopMatrix();
 }
 
 int draw()
 {
-  // Clear and reset
-  glClear(GL_DEPTH_BUFFER_BIT | GL_COLOR_BUFFER_BIT);
-  glMatrixMode(GL_MODELVIEW);
-
-  // Only draw if enter has begun
-  if(entering > 0 && exiting < 1)
+  camera.apply();
+
+  // Collect this frame's sprites, keep the visible ones in order, once
+  render_queue.clear();
+  gamestates::draw();
+  render_queue.cull(camera);
+  render_queue.sort();
+  if(show_overlay)
+    update_overlay();
+
+  // Redraw only what changed if the states can tell us
+  static DirtyRegion previous;
+  iRect screen(global::viewport);
+  DirtyRegion damaged(screen);
+  if(resolution.isActive())
+  {
+    // Every pixel of the target is stretched across the screen: no dirty
+    // rectangles here, the whole thing is redrawn
+    resolution.begin();
+    camera.apply();
+    glClear(GL_COLOR_BUFFER_BIT);
+    render_queue.submit();
+    resolution.end();
+    draw_overlay();
+  }
+  else if(DIRTY_RECTS && gamestates::damage(damaged))
+  {
+    DirtyRegion region(screen);
+    if(show_overlay)
+      damaged.add(fRect(overlay_position, overlay.getSize()));
+
+    // The back buffer still holds the frame before last (we assume the
+    // buffers are exchanged, not copied): catch up on its changes too
+    region.add(previous);
+    region.add(damaged);
+    previous = damaged;
+    if(full_redraws)
+      region.addAll();
+
+    glstate::enable(GL_SCISSOR_TEST);
+    const vector<iRect>& rects = region.getRects();
+    for(size_t i = 0; i < rects.size(); i++)
+    {
+      // NB - scissor coordinates start at the bottom-left
+      glScissor(rects[i].x, global::viewport.y - rects[i].y - rects[i].h,
+                rects[i].w, rects[i].h);
+      glClear(GL_COLOR_BUFFER_BIT);
+      render_queue.submit();
+      draw_overlay();
+    }
+    glstate::disable(GL_SCISSOR_TEST);
+    stats::count("draw.dirty.pixels", region.getArea());
+  }
+  else
   {
-    texture.draw(nullptr, &sprite);
+    // Clear and reset
+    glClear(GL_DEPTH_BUFFER_BIT | GL_COLOR_BUFFER_BIT);
+    render_queue.submit();
+    draw_overlay();
   }
+
+  if(full_redraws)
+    full_redraws--;
+
+  // Read back the frame for capture, if wanted, without waiting for it
+  capture::frame();
+
+  // Adapt the resolution to how long this took, before waiting on v-sync
+  resolution.update(stats::now() - frame_start);
+
   // Flip the buffers to update the screen
   SDL_GL_SwapWindow(window);
 
@@ -272,72 +626,192 @@ using namespace std;
 // Main must have exactly this signature or SDL2 will be sad
 int main(int argc, char *argv[])
 {
+  // Measure start-up time (cold and warm texture cache)
+  double launch_time = stats::now();
+
   // Initialise random numbers
   srand(time(NULL));
 
+  // Say when a subsystem takes more than it should
+  heap::budget(heap::GRAPHICS, BUDGET_GRAPHICS_MB << 20);
+  heap::budget(heap::ECS, BUDGET_ECS_MB << 20);
+  heap::budget(heap::EVENTS, BUDGET_EVENTS_MB << 20);
+  heap::budget(heap::CAPTURE, BUDGET_CAPTURE_MB << 20);
+  vram::budget(BUDGET_VRAM_MB << 20);
+
+  // Memory for per-frame temporaries
+  WARN_IF(frame::start() != EXIT_SUCCESS, "Creating frame arenas",
+          "Temporaries will go to the heap");
+
   // --------------------------------------------------------------------------
-  // START SDL
+  // START SUBSYSTEMS
   // --------------------------------------------------------------------------
 
-  // Set up SDL (create window and context for OpenGL)
-	window = SDL_CreateWindow(APP_NAME, SDL_WINDOWPOS_UNDEFINED,
-                           SDL_WINDOWPOS_UNDEFINED, WINDOW_DEFAULT_W,
-                           WINDOW_DEFAULT_H, SDL_WINDOW_OPENGL|SDL_WINDOW_SHOWN);
-  ASSERT_SDL(window, "Opening SDL2.0 application window");
-
-  // Since the window size can be overriden, check what it is actually
-  SDL_GetWindowSize(window, &global::viewport.x, &global::viewport.y);
-  global::scale.x = global::scale.y = 1.0f;
+  // SDL, windows and OpenGL stay on the main thread; files start meanwhile
+  // on workers (see startup.h). A task that names one that doesn't exist is
+  // dropped, so each must be added for start-up to go on
 
-  // Create the OpenGL context for the window we just opened
-  auto context = SDL_GL_CreateContext(window);
-  SDL_GL_MakeCurrent(window, context);
+  // Nothing else in SDL works before this
+  ASSERT(startup::add("sdl", {}, startup::MAIN_THREAD, []()
+  {
+    ASSERT_SDL(SDL_Init(SDL_INIT_VIDEO) == 0, "Starting SDL video");
+    return EXIT_SUCCESS;
+  }) == EXIT_SUCCESS, "Adding start-up task sdl");
 
-  // Configure SDL/OpenGL interface
-  ASSERT_SDL(SDL_GL_SetSwapInterval(1) != -1, "Activating SDL V-sync");
-  SDL_GL_SetAttribute(SDL_GL_CONTEXT_MAJOR_VERSION, GL_V_MAJOR);
-  SDL_GL_SetAttribute(SDL_GL_CONTEXT_MINOR_VERSION, GL_V_MINOR);
-  SDL_GL_SetAttribute(SDL_GL_DOUBLEBUFFER, 1);
+  // Assets in one mapping rather than a file each
+  ASSERT(startup::add("pack", {}, startup::ANY_THREAD, []()
+  {
+    WARN_IF(pack::open(ASSET_PACK) != EXIT_SUCCESS, "Opening " ASSET_PACK,
+            "Assets will be read from loose files");
+    return EXIT_SUCCESS;
+  }) == EXIT_SUCCESS, "Adding start-up task pack");
 
-  // --------------------------------------------------------------------------
-  // START OPENGL
-  // --------------------------------------------------------------------------
+  // Reads without a blocked thread each, if the system can: only used from
+  // the main thread once start-up is over
+  ASSERT(startup::add("fileio", {}, startup::ANY_THREAD, []()
+  {
+    fileio::start();
+    return EXIT_SUCCESS;
+  }) == EXIT_SUCCESS, "Adding start-up task fileio");
 
+  // See changes to the assets without restarting
+  ASSERT(startup::add("hotreload", {"sdl"}, startup::ANY_THREAD, []()
   {
+    WARN_IF(hotreload::start(HOT_RELOAD_DIR) != EXIT_SUCCESS,
+            "Watching " HOT_RELOAD_DIR, "Assets won't be reloaded");
+    return EXIT_SUCCESS;
+  }) == EXIT_SUCCESS, "Adding start-up task hotreload");
 
-  // Define viewport
-  glViewport(0, 0, WINDOW_DEFAULT_W, WINDOW_DEFAULT_H);
+  // Set up SDL (create window and context for OpenGL)
+  ASSERT(startup::add("window", {"sdl"}, startup::MAIN_THREAD, []()
+  {
+    // Only taken into account by windows and contexts created afterwards
+    SDL_GL_SetAttribute(SDL_GL_CONTEXT_MAJOR_VERSION, GL_V_MAJOR);
+    SDL_GL_SetAttribute(SDL_GL_CONTEXT_MINOR_VERSION, GL_V_MINOR);
+    SDL_GL_SetAttribute(SDL_GL_DOUBLEBUFFER, 1);
+
+    window = SDL_CreateWindow(APP_NAME, SDL_WINDOWPOS_UNDEFINED,
+                              SDL_WINDOWPOS_UNDEFINED, WINDOW_DEFAULT_W,
+                              WINDOW_DEFAULT_H,
+                              SDL_WINDOW_OPENGL|SDL_WINDOW_SHOWN);
+    ASSERT_SDL(window, "Opening SDL2.0 application window");
+
+    // Since the window size can be overriden, check what it is actually
+    SDL_GetWindowSize(window, &global::viewport.x, &global::viewport.y);
+
+    // Start with world coordinates matching screen pixels
+    camera.setSize(fV2(global::viewport));
+    camera.setPosition(fV2(global::viewport)*0.5f);
+    return EXIT_SUCCESS;
+  }) == EXIT_SUCCESS, "Adding start-up task window");
 
-  // Black background by default
-  glClearColor(0, 0, 0, 255);
+  // Create the OpenGL context for the window we just opened
+  ASSERT(startup::add("opengl", {"window"}, startup::MAIN_THREAD, [&]()
+  {
+    context = SDL_GL_CreateContext(window);
+    ASSERT_SDL(context, "Creating OpenGL context");
+    SDL_GL_MakeCurrent(window, context);
+    ASSERT(extensions::load() == EXIT_SUCCESS, "Loading OpenGL extensions");
+
+    // Configure SDL/OpenGL interface
+    pacing::start(window, MAX_FPS);
+
+    // Define viewport
+    glstate::viewport(0, 0, WINDOW_DEFAULT_W, WINDOW_DEFAULT_H);
+
+    // Black background by default
+    glstate::clear_colour(0, 0, 0, 255);
+
+    // Texturing
+    glstate::enable(GL_TEXTURE_2D);
+
+    // Blending and anti-aliasing
+    glstate::enable(GL_BLEND);
+    glstate::blend_func(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    glHint(GL_LINE_SMOOTH_HINT, GL_NICEST);
+
+    // Disable depth-testing
+    glstate::disable(GL_DEPTH_TEST);
+    glstate::disable(GL_CULL_FACE);
+
+    // Disable lighting
+    glDisable(GL_LIGHTING);
+    glDisable(GL_LIGHT0);
+    glDisable(GL_LIGHT1);
+
+    // Set up viewport
+    glstate::matrix_mode(GL_PROJECTION);
+    glLoadIdentity();
+    glOrtho(0, WINDOW_DEFAULT_W, WINDOW_DEFAULT_H, 0, -1, 1);
+
+    // Clean the slate
+    glstate::matrix_mode(GL_MODELVIEW);
+    glLoadIdentity();
+
+    // Put something on screen now rather than after the assets: most
+    // systems only show the window once it has been drawn into
+    glClear(GL_COLOR_BUFFER_BIT);
+    SDL_GL_SwapWindow(window);
+    double visible = stats::now() - launch_time;
+    stats::set("startup.window.ms", visible);
+    log("Window visible after %.1f ms", visible);
+    WARN_IF(visible > WINDOW_VISIBLE_MS, "Showing the window",
+            "Slower than it should be");
+    return EXIT_SUCCESS;
+  }) == EXIT_SUCCESS, "Adding start-up task opengl");
 
-  // Texturing
-  glEnable(GL_TEXTURE_2D);
+  // Upload textures from a second, shared context if we can
+  ASSERT(startup::add("uploader", {"opengl"}, startup::MAIN_THREAD, []()
+  {
+    WARN_IF(uploader::start(window) != EXIT_SUCCESS, "Starting loader thread",
+            "Textures will be uploaded synchronously");
+    return EXIT_SUCCESS;
+  }) == EXIT_SUCCESS, "Adding start-up task uploader");
 
-  // Blending and anti-aliasing
-  glEnable(GL_BLEND);
-  glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-  glHint(GL_LINE_SMOOTH_HINT, GL_NICEST);
+  // The first state's assets load on the loader thread while the rest of
+  // the main thread tasks go on
+  ASSERT(startup::add("states", {"uploader", "pack"}, startup::MAIN_THREAD, []()
+  {
+    return createStates();
+  }) == EXIT_SUCCESS, "Adding start-up task states");
 
-  // Disable depth-testing
-  glDisable(GL_DEPTH_TEST);
-  glDisable(GL_CULL_FACE);
+  // Text for the statistics overlay
+  ASSERT(startup::add("font", {"opengl", "pack"}, startup::MAIN_THREAD, []()
+  {
+    WARN_IF(font.load("assets/font.png"_id, "assets/font.png", iV2(8, 16))
+            != EXIT_SUCCESS, "Loading font", "No statistics overlay");
+    return EXIT_SUCCESS;
+  }) == EXIT_SUCCESS, "Adding start-up task font");
 
-	// Disable lighting
-	glDisable(GL_LIGHTING);
-	glDisable(GL_LIGHT0);
-	glDisable(GL_LIGHT1);
+  // Screenshots and recordings
+  ASSERT(startup::add("capture", {"opengl"}, startup::MAIN_THREAD, []()
+  {
+    WARN_IF(capture::start(global::viewport) != EXIT_SUCCESS,
+            "Starting frame capture", "Screenshots disabled");
+    return EXIT_SUCCESS;
+  }) == EXIT_SUCCESS, "Adding start-up task capture");
 
-  // Set up viewport
-  glMatrixMode(GL_PROJECTION);
-  glLoadIdentity();
-  glOrtho(0, WINDOW_DEFAULT_W, WINDOW_DEFAULT_H, 0, -1, 1);
+  // Render to a scaled target if we can, straight to the screen otherwise
+  ASSERT(startup::add("resolution", {"opengl"}, startup::MAIN_THREAD, []()
+  {
+    if(DYNAMIC_RESOLUTION)
+      WARN_IF(resolution.create(iRect(global::viewport),
+                                resolution_settings_t()) != EXIT_SUCCESS
+              || !resolution.isActive(), "Creating dynamic resolution target",
+              "Rendering at fixed resolution");
+    return EXIT_SUCCESS;
+  }) == EXIT_SUCCESS, "Adding start-up task resolution");
 
-  // Clean the slate
-  glMatrixMode(GL_MODELVIEW);
-  glLoadIdentity();
+  // SDL subsystems are started from the thread that started video (some
+  // audio drivers want the window too): last, as nothing else waits for it
+  ASSERT(startup::add("audio", {"window"}, startup::MAIN_THREAD, []()
+  {
+    WARN_IF(SDL_InitSubSystem(SDL_INIT_AUDIO) != 0, "Starting SDL audio",
+            SDL_GetError());
+    return EXIT_SUCCESS;
+  }) == EXIT_SUCCESS, "Adding start-up task audio");
 
-  } // start opengl
+  ASSERT(startup::run() == EXIT_SUCCESS, "Starting up");
 
   // --------------------------------------------------------------------------
   // LOAD AN IMAGE
@@ -346,7 +820,30 @@ int main(int argc, char *argv[])
 
 
 
-  ASSERT(createStates() == EXIT_SUCCESS, "Creating states");
+  // Keys (and buttons) for each action
+  input::bind(ACTION_CONFIRM, SDL_SCANCODE_RETURN);
+  input::bind_button(ACTION_CONFIRM, SDL_BUTTON_LEFT);
+  input::bind(ACTION_BACK, SDL_SCANCODE_ESCAPE);
+  input::bind(ACTION_OVERLAY, SDL_SCANCODE_F3);
+  input::bind(ACTION_SCREENSHOT, SDL_SCANCODE_F12);
+  input::bind(ACTION_RECORD, SDL_SCANCODE_F11);
+  input::bind(ACTION_RAW, SDL_SCANCODE_LSHIFT);
+  input::bind(ACTION_RAW, SDL_SCANCODE_RSHIFT);
+
+  // What the main loop does with events published by others
+  events::subscribe(events::QUIT, [](const events::event_t &event)
+  {
+    quitting = true;
+  });
+  events::subscribe(events::CAPTURE_SAVED, [](const events::event_t &event)
+  {
+    // Only screenshots: recordings would fill the log
+    const capture::saved_t &saved = event.as<capture::saved_t>();
+    if(saved.result == EXIT_SUCCESS && !capture::recording())
+      log("Saved %s", saved.filepath);
+  });
+
+  ASSERT(gamestates::start(title) == EXIT_SUCCESS, "Starting first state");
   // --------------------------------------------------------------------------
   // START THE GAME LOOP
   // --------------------------------------------------------------------------
@@ -354,18 +851,62 @@ int main(int argc, char *argv[])
   {
 
   float prev_tick, this_tick = SDL_GetTicks();
-  bool stop = false;
+  bool stop = false, first_frame = true;
   do
   {
     // Get the current time-stamp
     prev_tick = this_tick;
     this_tick = SDL_GetTicks();
 
+    double busy_start = stats::now();
+    frame_start = busy_start;
+
     // Update, check for exit events
-    stop = (update((this_tick - prev_tick)/1000.0f) & EVENT_QUIT);
+    int flags = update((this_tick - prev_tick)/1000.0f);
+    stop = quitting;
+
+    // Collect textures loaded in the background, files read asynchronously
+    uploader::update();
+    fileio::update();
+    if(uploader::busy() || fileio::busy())
+      flags &= ~EVENT_IDLE;
+
+    // Redraw everything, game objects included, unless nothing changed
+    bool drawn = !(flags & EVENT_IDLE) || first_frame;
+    if(drawn)
+      draw();
+    else
+    {
+      // Sleep until something happens rather than spinning
+      stats::count("frame.skipped");
+      stats::time("frame.busy", stats::now() - busy_start);
+      SDL_WaitEventTimeout(NULL, IDLE_WAIT_MS);
+      busy_start = stats::now();
+    }
+
+    // Only now release textures unloaded during the frame
+    Texture::collect();
+    stats::time("frame.busy", stats::now() - busy_start);
 
-    // Redraw everything, game objects included
-    draw();
+    // Hold the frame-rate steady
+    if(drawn)
+      pacing::wait();
+    else
+      pacing::idle();
+
+    if(first_frame)
+    {
+      stats::set("startup.first_frame.ms", stats::now() - launch_time);
+      log("First frame after %.1f ms", stats::now() - launch_time);
+      first_frame = false;
+    }
+
+    // Close the frame's statistics, recycle its temporary memory
+    glstate::report();
+    heap::frame();
+    vram::frame();
+    frame::end();
+    stats::frame();
   }
   while(!stop);
 
@@ -375,6 +916,24 @@ int main(int argc, char *argv[])
   // SHUT DOWN
   // --------------------------------------------------------------------------
 
+  pacing::report();
+
+  // Stop loading, release what's left
+  gamestates::stop();
+  capture::stop();
+  hotreload::stop();
+  fileio::stop();
+  font.unload();
+  resolution.destroy();
+  uploader::stop();
+  Texture::collect();
+  frame::stop();
+  pack::close();
+
+  // Whatever is still held now was leaked
+  vram::report();
+  heap::report();
+
   // Destroy context
   SDL_GL_MakeCurrent(NULL, NULL);
   SDL_GL_DeleteContext(context);
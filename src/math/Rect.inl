@@ -165,6 +165,51 @@ inline Rect<T> Rect<T>::operator-(V2<T> const& move) const
 }
 
 
+/// REMOVAL OF A SECTION OF A RECTANGLE
+
+// The part of 'other' overlapping this rectangle is cut away if what remains
+// is still a rectangle (the overlap spans a whole side). Otherwise the result
+// would be L- or U-shaped, so the rectangle is left as it is: it still covers
+// everything it covered before, only not as tightly.
+template <typename T>
+inline Rect<T>& Rect<T>::operator-=(Rect<T> const& other)
+{
+    Rect<T> inter = getInter(other);
+    if(!inter)
+        return (*this);
+
+    bool full_w = (inter.x == x && inter.w == w),
+         full_h = (inter.y == y && inter.h == h);
+
+    if(full_w && full_h)
+        x = y = w = h = 0;
+    else if(full_w && inter.y == y)
+    {
+        y += inter.h;
+        h -= inter.h;
+    }
+    else if(full_w && inter.y + inter.h == y + h)
+        h -= inter.h;
+    else if(full_h && inter.x == x)
+    {
+        x += inter.w;
+        w -= inter.w;
+    }
+    else if(full_h && inter.x + inter.w == x + w)
+        w -= inter.w;
+
+    return (*this);
+}
+
+template <typename T>
+inline Rect<T> Rect<T>::operator-(Rect<T> const& other) const
+{
+    Rect<T> copy(*this);
+    copy -= other;
+    return copy;
+}
+
+
 /// UNIFORM STRETCHING (BY SCALAR)
 
 template <typename T>
@@ -0,0 +1,124 @@
+//! --------------------------------------------------------------------------
+//! -------------------------- INCLUDES
+//! --------------------------------------------------------------------------
+
+#include "Arena.hpp"
+
+#include <cstdlib>
+#include <stdint.h>
+
+#include "../debug/assert.h"
+#include "../debug/warn.h"
+
+using namespace std;
+
+//! --------------------------------------------------------------------------
+//! -------------------------- CONSTRUCTORS, DESTRUCTOR
+//! --------------------------------------------------------------------------
+
+Arena::Arena() :
+block(nullptr),
+capacity(0),
+offset(0),
+overflow_mutex(),
+overflow(),
+overflow_bytes(0)
+{
+}
+
+Arena::~Arena()
+{
+  destroy();
+}
+
+int Arena::create(size_t _capacity)
+{
+  destroy();
+
+  block = (char*)malloc(_capacity);
+  ASSERT(block, "Allocating arena");
+  capacity = _capacity;
+  offset.store(0);
+  return EXIT_SUCCESS;
+}
+
+int Arena::destroy()
+{
+  reset();
+  free(block);
+  block = nullptr;
+  capacity = 0;
+  return EXIT_SUCCESS;
+}
+
+//! --------------------------------------------------------------------------
+//! -------------------------- ALLOCATION
+//! --------------------------------------------------------------------------
+
+void* Arena::allocate(size_t size, size_t align)
+{
+  void* p = tryAllocate(size, align);
+  if(p)
+    return p;
+
+  // Full: the heap will have to do until the next reset (malloc is aligned
+  // enough for anything up to ARENA_ALIGN)
+  p = malloc(size ? size : 1);
+  ASSERT_RTN(p, "Allocating arena overflow", nullptr);
+  lock_guard<mutex> lock(overflow_mutex);
+  overflow.push_back(p);
+  overflow_bytes.fetch_add(size, memory_order_relaxed);
+  return p;
+}
+
+void* Arena::tryAllocate(size_t size, size_t align)
+{
+  // Reserve enough to align whatever we get; once full, stay full without
+  // pushing the offset any further
+  size_t reserved = size + align - 1;
+  if(offset.load(memory_order_relaxed) + reserved > capacity)
+    return nullptr;
+  size_t start = offset.fetch_add(reserved, memory_order_relaxed);
+  if(start + reserved > capacity)
+    return nullptr;
+
+  uintptr_t p = (uintptr_t)(block + start);
+  return (void*)((p + align - 1) & ~(uintptr_t)(align - 1));
+}
+
+void Arena::reset()
+{
+  {
+    lock_guard<mutex> lock(overflow_mutex);
+    for(size_t i = 0; i < overflow.size(); i++)
+      free(overflow[i]);
+    overflow.clear();
+  }
+  overflow_bytes.store(0);
+  offset.store(0);
+}
+
+//! --------------------------------------------------------------------------
+//! -------------------------- ACCESSORS
+//! --------------------------------------------------------------------------
+
+bool Arena::owns(const void* p) const
+{
+  return (p >= block && p < block + capacity);
+}
+
+size_t Arena::getUsed() const
+{
+  size_t used = offset.load(memory_order_relaxed);
+  return (used < capacity) ? used : capacity;
+}
+
+size_t Arena::getCapacity() const
+{
+  return capacity;
+}
+
+size_t Arena::getOverflow() const
+{
+  return overflow_bytes.load(memory_order_relaxed);
+}
@@ -0,0 +1,51 @@
+#ifndef ARENA_HPP_INCLUDED
+#define ARENA_HPP_INCLUDED
+
+#include <atomic>
+#include <mutex>
+#include <vector>
+#include <cstddef>
+
+// Linear allocator: one block, carved up by bumping an offset, released all
+// at once by reset(). Allocating is a single atomic add so any thread may do
+// it; individual allocations are never freed. Whatever doesn't fit goes to
+// the heap and is counted as overflow, to be freed on reset as well.
+
+#define ARENA_ALIGN 16      // default alignment, enough for anything
+
+class Arena
+{
+  /// ATTRIBUTES
+private:
+  char* block;
+  size_t capacity;
+  std::atomic<size_t> offset;
+  std::mutex overflow_mutex;
+  std::vector<void*> overflow;
+  std::atomic<size_t> overflow_bytes;
+
+  /// METHODS
+public:
+  // constructors, destructors
+  Arena();
+  ~Arena();
+  int create(size_t capacity);
+  int destroy();
+  // allocation: never fails, but may overflow to the heap
+  void* allocate(size_t size, size_t align = ARENA_ALIGN);
+  // the same without the heap: nullptr if it doesn't fit
+  void* tryAllocate(size_t size, size_t align = ARENA_ALIGN);
+  // forget everything allocated: not while anyone is still allocating
+  void reset();
+  // accessors
+  bool owns(const void* p) const;
+  size_t getUsed() const;
+  size_t getCapacity() const;
+  size_t getOverflow() const;
+
+private:
+  Arena(const Arena&);
+  Arena& operator=(const Arena&);
+};
+
+#endif // ARENA_HPP_INCLUDED
@@ -0,0 +1,46 @@
+#ifndef FRAMEALLOCATOR_HPP_INCLUDED
+#define FRAMEALLOCATOR_HPP_INCLUDED
+
+#include <cstddef>
+#include <vector>
+
+#include "frame.h"
+
+// Standard library allocator taking its memory from the frame arenas, for
+// containers that don't outlive the next frame. Freeing does nothing: it
+// all goes at once two frames later.
+
+template <typename T>
+class FrameAllocator
+{
+public:
+  typedef T value_type;
+
+  FrameAllocator() {}
+  template <typename U>
+  FrameAllocator(const FrameAllocator<U>&) {}
+
+  T* allocate(size_t n) { return frame::allocate<T>(n); }
+  void deallocate(T*, size_t) {}
+
+  template <typename U>
+  struct rebind { typedef FrameAllocator<U> other; };
+};
+
+template <typename T, typename U>
+bool operator==(const FrameAllocator<T>&, const FrameAllocator<U>&)
+{
+  return true;
+}
+
+template <typename T, typename U>
+bool operator!=(const FrameAllocator<T>&, const FrameAllocator<U>&)
+{
+  return false;
+}
+
+// the usual scratch container
+template <typename T>
+using frame_vector = std::vector<T, FrameAllocator<T>>;
+
+#endif // FRAMEALLOCATOR_HPP_INCLUDED
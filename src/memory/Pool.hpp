@@ -0,0 +1,58 @@
+#ifndef POOL_HPP_INCLUDED
+#define POOL_HPP_INCLUDED
+
+#include <cstddef>
+#include <vector>
+#include <type_traits>
+
+// Fixed-size objects allocated from blocks of POOL_BLOCK at a time, with
+// freed slots kept on a list threaded through the slots themselves: creating
+// and destroying are a couple of pointer moves, and objects of a kind sit
+// next to each other. Memory only goes back when the pool does. Not
+// thread-safe: each pool belongs to one thread.
+
+#define POOL_BLOCK 64
+
+template <typename T, size_t BLOCK = POOL_BLOCK>
+class Pool
+{
+  /// NESTING
+private:
+  union slot_t
+  {
+    slot_t* next;
+    typename std::aligned_storage<sizeof(T), alignof(T)>::type storage;
+  };
+
+  /// ATTRIBUTES
+private:
+  std::vector<slot_t*> blocks;
+  slot_t* free_list;
+  size_t count;
+
+  /// METHODS
+public:
+  // constructors, destructors: objects left in the pool aren't destroyed
+  Pool();
+  ~Pool();
+  // objects
+  template <typename... Args>
+  T* create(Args&&... args);
+  void destroy(T* object);
+  // make room for 'n' objects in all
+  void reserve(size_t n);
+  // accessors
+  size_t size() const;
+  size_t capacity() const;
+
+private:
+  void grow();
+  Pool(const Pool&);
+  Pool& operator=(const Pool&);
+};
+
+// NB - "Inline" files are implementations that are included rather than
+// compiled. They are especially useful for templates.
+#include "Pool.inl"
+
+#endif // POOL_HPP_INCLUDED
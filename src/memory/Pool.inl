@@ -0,0 +1,89 @@
+// Inline file: a special implementation that is included rather than compiled
+
+#include <new>
+#include <utility>
+
+//! --------------------------------------------------------------------------
+//! -------------------------- CONSTRUCTORS, DESTRUCTOR
+//! --------------------------------------------------------------------------
+
+template <typename T, size_t BLOCK>
+Pool<T, BLOCK>::Pool() :
+blocks(),
+free_list(nullptr),
+count(0)
+{
+}
+
+template <typename T, size_t BLOCK>
+Pool<T, BLOCK>::~Pool()
+{
+  for(size_t i = 0; i < blocks.size(); i++)
+    delete[] blocks[i];
+}
+
+//! --------------------------------------------------------------------------
+//! -------------------------- OBJECTS
+//! --------------------------------------------------------------------------
+
+template <typename T, size_t BLOCK>
+template <typename... Args>
+T* Pool<T, BLOCK>::create(Args&&... args)
+{
+  if(!free_list)
+    grow();
+
+  slot_t* slot = free_list;
+  free_list = slot->next;
+  count++;
+  return new(&slot->storage) T(std::forward<Args>(args)...);
+}
+
+template <typename T, size_t BLOCK>
+void Pool<T, BLOCK>::destroy(T* object)
+{
+  if(!object)
+    return;
+
+  object->~T();
+  slot_t* slot = reinterpret_cast<slot_t*>(object);
+  slot->next = free_list;
+  free_list = slot;
+  count--;
+}
+
+template <typename T, size_t BLOCK>
+void Pool<T, BLOCK>::reserve(size_t n)
+{
+  while(capacity() < n)
+    grow();
+}
+
+template <typename T, size_t BLOCK>
+void Pool<T, BLOCK>::grow()
+{
+  slot_t* block = new slot_t[BLOCK];
+  blocks.push_back(block);
+
+  // Thread the new slots onto the free list, first slot first
+  for(size_t i = 0; i + 1 < BLOCK; i++)
+    block[i].next = &block[i + 1];
+  block[BLOCK - 1].next = free_list;
+  free_list = block;
+}
+
+//! --------------------------------------------------------------------------
+//! -------------------------- ACCESSORS
+//! --------------------------------------------------------------------------
+
+template <typename T, size_t BLOCK>
+size_t Pool<T, BLOCK>::size() const
+{
+  return count;
+}
+
+template <typename T, size_t BLOCK>
+size_t Pool<T, BLOCK>::capacity() const
+{
+  return blocks.size()*BLOCK;
+}
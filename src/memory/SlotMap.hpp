@@ -0,0 +1,86 @@
+#ifndef SLOTMAP_HPP_INCLUDED
+#define SLOTMAP_HPP_INCLUDED
+
+#include <cstddef>
+#include <vector>
+#include <stdint.h>
+
+// Values stored contiguously, for iterating, and reached from the outside
+// through handles that stay valid however the storage is rearranged. Each
+// handle carries the generation of its slot, which changes whenever the
+// value in it is erased: a handle kept after that is recognised as stale
+// instead of pointing at whatever took its place.
+//
+// Erasing moves the last value into the hole, so values may change order
+// (and address) but never leave gaps.
+
+struct handle_t
+{
+  uint32_t index;
+  uint32_t generation;    // 0 is never valid
+
+  bool operator==(const handle_t& other) const
+  {
+    return index == other.index && generation == other.generation;
+  }
+  bool operator!=(const handle_t& other) const
+  {
+    return !(*this == other);
+  }
+};
+
+#define NO_HANDLE (handle_t { 0, 0 })
+
+template <typename T>
+class SlotMap
+{
+  /// NESTING
+private:
+  struct slot_t
+  {
+    uint32_t dense;         // where the value is, if it's alive
+    uint32_t generation;
+  };
+
+  /// ATTRIBUTES
+private:
+  std::vector<T> values;
+  std::vector<uint32_t> owners;     // value -> slot
+  std::vector<slot_t> slots;        // slot -> value
+  std::vector<uint32_t> free_slots;
+
+  /// METHODS
+public:
+  // constructors, destructors
+  SlotMap();
+  // values
+  handle_t insert(const T& value);
+  template <typename... Args>
+  handle_t emplace(Args&&... args);
+  bool erase(handle_t handle);
+  void clear();
+  void reserve(size_t n);
+  // null if the handle is stale
+  T* get(handle_t handle);
+  const T* get(handle_t handle) const;
+  bool contains(handle_t handle) const;
+  // dense access, for iterating
+  size_t size() const;
+  bool empty() const;
+  T& operator[](size_t i);
+  const T& operator[](size_t i) const;
+  handle_t getHandle(size_t i) const;
+  typename std::vector<T>::iterator begin();
+  typename std::vector<T>::iterator end();
+  typename std::vector<T>::const_iterator begin() const;
+  typename std::vector<T>::const_iterator end() const;
+
+private:
+  handle_t allocate();
+};
+
+// NB - "Inline" files are implementations that are included rather than
+// compiled. They are especially useful for templates.
+#include "SlotMap.inl"
+
+#endif // SLOTMAP_HPP_INCLUDED
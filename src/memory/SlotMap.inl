@@ -0,0 +1,186 @@
+// Inline file: a special implementation that is included rather than compiled
+
+#include <utility>
+
+//! --------------------------------------------------------------------------
+//! -------------------------- CONSTRUCTORS, DESTRUCTOR
+//! --------------------------------------------------------------------------
+
+template <typename T>
+SlotMap<T>::SlotMap() :
+values(),
+owners(),
+slots(),
+free_slots()
+{
+}
+
+//! --------------------------------------------------------------------------
+//! -------------------------- VALUES
+//! --------------------------------------------------------------------------
+
+template <typename T>
+handle_t SlotMap<T>::allocate()
+{
+  handle_t handle;
+  if(free_slots.empty())
+  {
+    slot_t s = { 0, 1 };
+    handle.index = slots.size();
+    slots.push_back(s);
+  }
+  else
+  {
+    handle.index = free_slots.back();
+    free_slots.pop_back();
+  }
+
+  slot_t& s = slots[handle.index];
+  s.dense = values.size();
+  handle.generation = s.generation;
+  owners.push_back(handle.index);
+  return handle;
+}
+
+template <typename T>
+handle_t SlotMap<T>::insert(const T& value)
+{
+  handle_t handle = allocate();
+  values.push_back(value);
+  return handle;
+}
+
+template <typename T>
+template <typename... Args>
+handle_t SlotMap<T>::emplace(Args&&... args)
+{
+  handle_t handle = allocate();
+  values.emplace_back(std::forward<Args>(args)...);
+  return handle;
+}
+
+template <typename T>
+bool SlotMap<T>::erase(handle_t handle)
+{
+  if(!contains(handle))
+    return false;
+
+  // Fill the hole with the last value
+  slot_t& s = slots[handle.index];
+  uint32_t last = values.size() - 1;
+  if(s.dense != last)
+  {
+    values[s.dense] = std::move(values[last]);
+    owners[s.dense] = owners[last];
+    slots[owners[last]].dense = s.dense;
+  }
+  values.pop_back();
+  owners.pop_back();
+
+  // Outdate every handle to this slot
+  if(!(++s.generation))
+    s.generation = 1;
+  free_slots.push_back(handle.index);
+  return true;
+}
+
+template <typename T>
+void SlotMap<T>::clear()
+{
+  for(size_t i = 0; i < owners.size(); i++)
+  {
+    slot_t& s = slots[owners[i]];
+    if(!(++s.generation))
+      s.generation = 1;
+    free_slots.push_back(owners[i]);
+  }
+  values.clear();
+  owners.clear();
+}
+
+template <typename T>
+void SlotMap<T>::reserve(size_t n)
+{
+  values.reserve(n);
+  owners.reserve(n);
+  slots.reserve(n);
+}
+
+template <typename T>
+T* SlotMap<T>::get(handle_t handle)
+{
+  return contains(handle) ? &values[slots[handle.index].dense] : nullptr;
+}
+
+template <typename T>
+const T* SlotMap<T>::get(handle_t handle) const
+{
+  return contains(handle) ? &values[slots[handle.index].dense] : nullptr;
+}
+
+template <typename T>
+bool SlotMap<T>::contains(handle_t handle) const
+{
+  // Erasing moves a slot on to the next generation
+  return handle.index < slots.size()
+    && slots[handle.index].generation == handle.generation;
+}
+
+//! --------------------------------------------------------------------------
+//! -------------------------- DENSE ACCESS
+//! --------------------------------------------------------------------------
+
+template <typename T>
+size_t SlotMap<T>::size() const
+{
+  return values.size();
+}
+
+template <typename T>
+bool SlotMap<T>::empty() const
+{
+  return values.empty();
+}
+
+template <typename T>
+T& SlotMap<T>::operator[](size_t i)
+{
+  return values[i];
+}
+
+template <typename T>
+const T& SlotMap<T>::operator[](size_t i) const
+{
+  return values[i];
+}
+
+template <typename T>
+handle_t SlotMap<T>::getHandle(size_t i) const
+{
+  handle_t handle = { owners[i], slots[owners[i]].generation };
+  return handle;
+}
+
+template <typename T>
+typename std::vector<T>::iterator SlotMap<T>::begin()
+{
+  return values.begin();
+}
+
+template <typename T>
+typename std::vector<T>::iterator SlotMap<T>::end()
+{
+  return values.end();
+}
+
+template <typename T>
+typename std::vector<T>::const_iterator SlotMap<T>::begin() const
+{
+  return values.begin();
+}
+
+template <typename T>
+typename std::vector<T>::const_iterator SlotMap<T>::end() const
+{
+  return values.end();
+}
@@ -0,0 +1,110 @@
+//! --------------------------------------------------------------------------
+//! -------------------------- INCLUDES
+//! --------------------------------------------------------------------------
+
+#include "frame.h"
+
+#include <cstdlib>
+#include <stdint.h>
+#include <atomic>
+
+#include "../debug/log.h"
+#include "../debug/stats.h"
+
+using namespace std;
+
+//! --------------------------------------------------------------------------
+//! -------------------------- WORKSPACE
+//! --------------------------------------------------------------------------
+
+namespace
+{
+  struct sub_arena_t
+  {
+    char* cursor;
+    char* end;
+    unsigned int frame;
+  };
+
+  static Arena arenas[2];
+  static atomic<unsigned int> current(0);
+
+  // the part of the current arena each thread has to itself
+  static thread_local sub_arena_t local = { nullptr, nullptr, 0 };
+
+  bool refill(Arena& arena, unsigned int frame)
+  {
+    // Never a sub-arena from the heap: it would cost a block for one small
+    // allocation, and never be freed if the thread didn't come back for it
+    char* block = (char*)arena.tryAllocate(FRAME_SUB_ARENA);
+    if(!block)
+      return false;
+    local.cursor = block;
+    local.end = block + FRAME_SUB_ARENA;
+    local.frame = frame;
+    return true;
+  }
+}
+
+//! --------------------------------------------------------------------------
+//! -------------------------- INTERFACE
+//! --------------------------------------------------------------------------
+
+namespace frame
+{
+  int start(size_t capacity)
+  {
+    for(int i = 0; i < 2; i++)
+      if(arenas[i].create(capacity) != EXIT_SUCCESS)
+        return EXIT_FAILURE;
+    log("Frame arenas of %u KB each", (unsigned int)(capacity >> 10));
+    return EXIT_SUCCESS;
+  }
+
+  int stop()
+  {
+    for(int i = 0; i < 2; i++)
+      arenas[i].destroy();
+    return EXIT_SUCCESS;
+  }
+
+  void* allocate(size_t size, size_t align)
+  {
+    unsigned int frame = current.load(memory_order_relaxed);
+    Arena& arena = arenas[frame & 1];
+
+    // Big things go straight to the shared arena
+    if(size > FRAME_SUB_ARENA/4)
+      return arena.allocate(size, align);
+
+    // Small ones come out of this thread's own piece of it
+    uintptr_t p = (uintptr_t)local.cursor;
+    p = (p + align - 1) & ~(uintptr_t)(align - 1);
+    if(local.frame != frame || !local.cursor || p + size > (uintptr_t)local.end)
+    {
+      if(!refill(arena, frame))
+        return arena.allocate(size, align);
+      p = (uintptr_t)local.cursor;
+      p = (p + align - 1) & ~(uintptr_t)(align - 1);
+    }
+    local.cursor = (char*)(p + size);
+    return (void*)p;
+  }
+
+  void end()
+  {
+    unsigned int frame = current.load();
+    Arena& used = arenas[frame & 1];
+    stats::set("frame.arena.kb", used.getUsed()/1024.0);
+    stats::set("frame.arena.overflow.kb", used.getOverflow()/1024.0);
+
+    // What was allocated two frames ago is no longer needed
+    arenas[(frame + 1) & 1].reset();
+    current.store(frame + 1);
+  }
+
+  unsigned int number()
+  {
+    return current.load();
+  }
+}
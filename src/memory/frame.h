@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstddef>
+
+#include "Arena.hpp"
+
+// Memory for things that only live for a frame or so: render lists, query
+// results, scratch buffers. There are two arenas, used on alternate frames,
+// so what was allocated during a frame stays valid until the end of the
+// next one and the frame after that gets it back wholesale, without a
+// single free.
+//
+// Each thread takes FRAME_SUB_ARENA bytes at a time from the shared arena
+// and allocates small things from that by itself, so workers don't fight
+// over the same offset. end() must not run while other threads allocate.
+//
+// Nothing needs to be started for allocating to work: it just all goes to
+// the heap until start() (still released by end()).
+
+#define FRAME_ARENA_SIZE (4 << 20)    // per buffer
+#define FRAME_SUB_ARENA (16 << 10)    // taken by each thread at a time
+
+namespace frame
+{
+  // create both arenas
+  int start(size_t capacity = FRAME_ARENA_SIZE);
+
+  // release them
+  int stop();
+
+  // any thread: valid until the end of the next frame
+  void* allocate(size_t size, size_t align = ARENA_ALIGN);
+
+  template <typename T>
+  T* allocate(size_t n)
+  {
+    return static_cast<T*>(allocate(n*sizeof(T), alignof(T)));
+  }
+
+  // close the frame: report, and recycle the arena of the one before
+  void end();
+
+  // frames closed so far
+  unsigned int number();
+}
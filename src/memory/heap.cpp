@@ -0,0 +1,237 @@
+//! --------------------------------------------------------------------------
+//! -------------------------- INCLUDES
+//! --------------------------------------------------------------------------
+
+#include "heap.h"
+
+#include <cstdlib>
+#include <stdint.h>
+#include <atomic>
+#include <new>
+
+#include "../debug/log.h"
+#include "../debug/warn.h"
+#include "../debug/stats.h"
+
+using namespace std;
+
+//! --------------------------------------------------------------------------
+//! -------------------------- NAMES
+//! --------------------------------------------------------------------------
+
+namespace heap
+{
+  const char* name(tag_t tag)
+  {
+    static const char* names[N_TAGS] =
+      { "general", "graphics", "ecs", "events", "capture" };
+    return (tag < N_TAGS) ? names[tag] : "?";
+  }
+}
+
+#if MEMORY_TRACKING
+
+//! --------------------------------------------------------------------------
+//! -------------------------- WORKSPACE
+//! --------------------------------------------------------------------------
+
+namespace
+{
+  // Put in front of every allocation so that delete knows what it's freeing;
+  // 16 bytes so that what follows is as aligned as malloc made it
+  struct header_t
+  {
+    size_t size;
+    uint32_t tag;
+    uint32_t magic;
+  };
+  static_assert(sizeof(header_t) == 16, "Heap header must stay 16 bytes");
+
+  #define HEAP_MAGIC 0x4ea9a110
+
+  static atomic<size_t> n_allocations(0), n_frees(0);
+  static atomic<size_t> bytes[heap::N_TAGS], counts[heap::N_TAGS];
+
+  // NB - trivial, so usable from operator new however early it's called
+  static thread_local heap::tag_t current = heap::GENERAL;
+
+  // main thread only
+  static size_t last_allocations = 0, last_frees = 0;
+  static size_t budgets[heap::N_TAGS];
+  static bool over[heap::N_TAGS];
+
+  void* counted_new(size_t size)
+  {
+    header_t* h = (header_t*)malloc(sizeof(header_t) + size);
+    if(!h)
+      throw bad_alloc();
+    h->size = size;
+    h->tag = current;
+    h->magic = HEAP_MAGIC;
+
+    n_allocations.fetch_add(1, memory_order_relaxed);
+    bytes[h->tag].fetch_add(size, memory_order_relaxed);
+    counts[h->tag].fetch_add(1, memory_order_relaxed);
+    return h + 1;
+  }
+
+  void counted_delete(void* p)
+  {
+    if(!p)
+      return;
+    header_t* h = (header_t*)p - 1;
+    if(h->magic != HEAP_MAGIC)
+    {
+      // Not ours (or already freed): the least bad thing is to leave it
+      log(LOG_ERROR, "Heap : freeing %p, which operator new didn't return", p);
+      return;
+    }
+    h->magic = 0;
+
+    n_frees.fetch_add(1, memory_order_relaxed);
+    bytes[h->tag].fetch_sub(h->size, memory_order_relaxed);
+    counts[h->tag].fetch_sub(1, memory_order_relaxed);
+    free(h);
+  }
+}
+
+//! --------------------------------------------------------------------------
+//! -------------------------- GLOBAL OPERATORS
+//! --------------------------------------------------------------------------
+
+void* operator new(size_t size)
+{
+  return counted_new(size);
+}
+
+void* operator new[](size_t size)
+{
+  return counted_new(size);
+}
+
+void* operator new(size_t size, const nothrow_t&) noexcept
+{
+  try { return counted_new(size); }
+  catch(...) { return nullptr; }
+}
+
+void* operator new[](size_t size, const nothrow_t&) noexcept
+{
+  try { return counted_new(size); }
+  catch(...) { return nullptr; }
+}
+
+void operator delete(void* p) noexcept
+{
+  counted_delete(p);
+}
+
+void operator delete[](void* p) noexcept
+{
+  counted_delete(p);
+}
+
+void operator delete(void* p, const nothrow_t&) noexcept
+{
+  counted_delete(p);
+}
+
+void operator delete[](void* p, const nothrow_t&) noexcept
+{
+  counted_delete(p);
+}
+
+//! --------------------------------------------------------------------------
+//! -------------------------- INTERFACE
+//! --------------------------------------------------------------------------
+
+namespace heap
+{
+  Scope::Scope(tag_t tag) :
+  previous(current)
+  {
+    current = tag;
+  }
+
+  Scope::~Scope()
+  {
+    current = previous;
+  }
+
+  size_t allocations()
+  {
+    return n_allocations.load(memory_order_relaxed);
+  }
+
+  size_t frees()
+  {
+    return n_frees.load(memory_order_relaxed);
+  }
+
+  size_t used(tag_t tag)
+  {
+    return bytes[tag].load(memory_order_relaxed);
+  }
+
+  size_t live(tag_t tag)
+  {
+    return counts[tag].load(memory_order_relaxed);
+  }
+
+  void budget(tag_t tag, size_t _bytes)
+  {
+    budgets[tag] = _bytes;
+    over[tag] = false;
+  }
+
+  void frame()
+  {
+    size_t a = allocations(), f = frees();
+    stats::set("heap.allocations", a - last_allocations);
+    stats::set("heap.frees", f - last_frees);
+    last_allocations = a;
+    last_frees = f;
+
+    static const char* gauges[N_TAGS] =
+      { "memory.general.kb", "memory.graphics.kb", "memory.ecs.kb",
+        "memory.events.kb", "memory.capture.kb" };
+    size_t total = 0;
+    for(int t = 0; t < N_TAGS; t++)
+    {
+      size_t held = used((tag_t)t);
+      total += held;
+      stats::set(gauges[t], held/1024.0);
+
+      // Say so once when going over, again if it happens again later
+      bool is_over = budgets[t] && held > budgets[t];
+      if(is_over && !over[t])
+        log(LOG_WARN, "Memory budget : %s holds %.1f MB, budget is %.1f MB",
+            name((tag_t)t), held/1048576.0, budgets[t]/1048576.0);
+      over[t] = is_over;
+    }
+    stats::set("memory.heap.kb", total/1024.0);
+  }
+
+  void report()
+  {
+    log("Heap at exit: %u allocation(s), %u free(s)",
+        (unsigned int)allocations(), (unsigned int)frees());
+    for(int t = 0; t < N_TAGS; t++)
+    {
+      size_t n = live((tag_t)t);
+      if(!n)
+        continue;
+
+      // Statics only go after main returns: general is expected to hold
+      // something, nothing else should
+      if(t == GENERAL)
+        log("  %-10s %8u allocation(s) %10.1f KB (statics included)",
+            name((tag_t)t), (unsigned int)n, used((tag_t)t)/1024.0);
+      else
+        log(LOG_WARN, "  %-10s %8u allocation(s) %10.1f KB leaked",
+            name((tag_t)t), (unsigned int)n, used((tag_t)t)/1024.0);
+    }
+  }
+}
+
+#endif // MEMORY_TRACKING
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstddef>
+
+#include "../global.hpp"            // Needed for MEMORY_TRACKING
+
+// Tracks what goes through the global operator new and delete: how many
+// allocations each frame still makes, and how much each subsystem holds
+// against its budget. An allocation belongs to whichever HEAP_SCOPE is
+// active on the thread that makes it (GENERAL outside of any).
+//
+// With MEMORY_TRACKING at 0 the operators aren't even replaced and all of
+// this compiles down to nothing.
+
+namespace heap
+{
+  enum tag_t
+  {
+    GENERAL,
+    GRAPHICS,
+    ECS,
+    EVENTS,
+    CAPTURE,
+    N_TAGS
+  };
+
+  const char* name(tag_t tag);
+
+#if MEMORY_TRACKING
+
+  // allocations made in this scope, on this thread, belong to 'tag'
+  class Scope
+  {
+  private:
+    tag_t previous;
+  public:
+    Scope(tag_t tag);
+    ~Scope();
+  };
+
+  // counts since the program started
+  size_t allocations();
+  size_t frees();
+
+  // held right now
+  size_t used(tag_t tag);
+  size_t live(tag_t tag);
+
+  // warn (once each time) when 'tag' goes over 'bytes': 0 for no limit
+  void budget(tag_t tag, size_t bytes);
+
+  // publish this frame's numbers (heap.*, memory.*.kb), check budgets
+  void frame();
+
+  // list what's still allocated: call last thing before exiting
+  void report();
+
+#else
+
+  class Scope { public: Scope(tag_t) {} };
+  inline size_t allocations() { return 0; }
+  inline size_t frees() { return 0; }
+  inline size_t used(tag_t) { return 0; }
+  inline size_t live(tag_t) { return 0; }
+  inline void budget(tag_t, size_t) {}
+  inline void frame() {}
+  inline void report() {}
+
+#endif
+}
+
+#if MEMORY_TRACKING
+  #define HEAP_CONCAT_AUX(a, b) a##b
+  #define HEAP_CONCAT(a, b) HEAP_CONCAT_AUX(a, b)
+  #define HEAP_SCOPE(tag) \
+    heap::Scope HEAP_CONCAT(heap_scope_, __LINE__)(tag)
+#else
+  #define HEAP_SCOPE(tag)
+#endif
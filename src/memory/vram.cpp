@@ -0,0 +1,121 @@
+//! --------------------------------------------------------------------------
+//! -------------------------- INCLUDES
+//! --------------------------------------------------------------------------
+
+#include "vram.h"
+
+#include <map>
+#include <mutex>
+
+#include "../debug/log.h"
+#include "../debug/stats.h"
+
+using namespace std;
+
+//! --------------------------------------------------------------------------
+//! -------------------------- ESTIMATES
+//! --------------------------------------------------------------------------
+
+namespace vram
+{
+  size_t estimate(int w, int h, int n_colours)
+  {
+    return (size_t)w*h*((n_colours == 3) ? 4 : n_colours);
+  }
+}
+
+#if MEMORY_TRACKING
+
+//! --------------------------------------------------------------------------
+//! -------------------------- WORKSPACE
+//! --------------------------------------------------------------------------
+
+namespace
+{
+  struct texture_t
+  {
+    size_t bytes;
+    int w, h;
+  };
+
+  // the loader thread uploads too
+  static mutex textures_mutex;
+  static map<unsigned int, texture_t> textures;
+  static size_t total = 0;
+
+  // main thread only
+  static size_t limit = 0;
+  static bool over = false;
+}
+
+//! --------------------------------------------------------------------------
+//! -------------------------- INTERFACE
+//! --------------------------------------------------------------------------
+
+namespace vram
+{
+  void add(unsigned int handle, size_t bytes, int w, int h)
+  {
+    lock_guard<mutex> lock(textures_mutex);
+    texture_t& t = textures[handle];
+    total += bytes - t.bytes;
+    t.bytes = bytes;
+    t.w = w;
+    t.h = h;
+  }
+
+  void remove(unsigned int handle)
+  {
+    lock_guard<mutex> lock(textures_mutex);
+    auto i = textures.find(handle);
+    if(i == textures.end())
+      return;
+    total -= i->second.bytes;
+    textures.erase(i);
+  }
+
+  size_t used()
+  {
+    lock_guard<mutex> lock(textures_mutex);
+    return total;
+  }
+
+  size_t count()
+  {
+    lock_guard<mutex> lock(textures_mutex);
+    return textures.size();
+  }
+
+  void budget(size_t bytes)
+  {
+    limit = bytes;
+    over = false;
+  }
+
+  void frame()
+  {
+    size_t held = used();
+    stats::set("memory.vram.kb", held/1024.0);
+
+    bool is_over = limit && held > limit;
+    if(is_over && !over)
+      log(LOG_WARN, "Memory budget : textures take %.1f MB, budget is %.1f MB",
+          held/1048576.0, limit/1048576.0);
+    over = is_over;
+  }
+
+  void report()
+  {
+    lock_guard<mutex> lock(textures_mutex);
+    if(textures.empty())
+      return;
+
+    log(LOG_WARN, "%u texture(s) never unloaded, %.1f KB of video memory:",
+        (unsigned int)textures.size(), total/1024.0);
+    for(auto i = textures.begin(); i != textures.end(); i++)
+      log(LOG_WARN, "  texture %4u  %4dx%-4d %10.1f KB", i->first,
+          i->second.w, i->second.h, i->second.bytes/1024.0);
+  }
+}
+
+#endif // MEMORY_TRACKING
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstddef>
+
+#include "../global.hpp"            // Needed for MEMORY_TRACKING
+
+// Estimates of what textures take up in video memory: the driver won't say,
+// so each texture is registered with its size when uploaded and forgotten
+// when its handle is really deleted. Whatever is still registered at exit
+// was never unloaded. Compiles down to nothing with MEMORY_TRACKING at 0.
+
+namespace vram
+{
+  // bytes for a w x h texture with 'n_colours' 8-bit channels (3 counts
+  // as 4: that's how drivers store it)
+  size_t estimate(int w, int h, int n_colours);
+
+#if MEMORY_TRACKING
+
+  // any thread: (re)register a texture handle
+  void add(unsigned int handle, size_t bytes, int w, int h);
+  void remove(unsigned int handle);
+
+  // held right now
+  size_t used();
+  size_t count();
+
+  // warn (once each time) when going over 'bytes': 0 for no limit
+  void budget(size_t bytes);
+
+  // publish memory.vram.kb, check the budget
+  void frame();
+
+  // list the textures that were never unloaded
+  void report();
+
+#else
+
+  inline void add(unsigned int, size_t, int, int) {}
+  inline void remove(unsigned int) {}
+  inline size_t used() { return 0; }
+  inline size_t count() { return 0; }
+  inline void budget(size_t) {}
+  inline void frame() {}
+  inline void report() {}
+
+#endif
+}
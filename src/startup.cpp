@@ -0,0 +1,233 @@
+//! --------------------------------------------------------------------------
+//! -------------------------- INCLUDES
+//! --------------------------------------------------------------------------
+
+#include "startup.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include <algorithm>
+#include <mutex>
+#include <condition_variable>
+
+#include "threads/WorkerPool.hpp"
+#include "debug/log.h"
+#include "debug/stats.h"
+
+using namespace std;
+
+//! --------------------------------------------------------------------------
+//! -------------------------- WORKSPACE
+//! --------------------------------------------------------------------------
+
+namespace
+{
+  enum state_t
+  {
+    WAITING,
+    RUNNING,
+    SUCCEEDED,
+    FAILED,
+    SKIPPED     // something it waits for failed
+  };
+
+  struct task_info_t
+  {
+    const char* name;
+    vector<size_t> after;
+    startup::thread_t thread;
+    startup::task_t run;
+    state_t state;
+    double start, duration;   // from the start of run(), in milliseconds
+  };
+
+  static vector<task_info_t> tasks;
+
+  // shared with the workers while running, protected by the mutex
+  static mutex tasks_mutex;
+  static condition_variable finished;
+  static size_t running = 0;
+
+  // can't start yet (WAITING), can (RUNNING) or never will (SKIPPED)
+  state_t readiness(const task_info_t& task)
+  {
+    state_t result = RUNNING;
+    for(size_t i = 0; i < task.after.size(); i++)
+      switch(tasks[task.after[i]].state)
+      {
+        case SUCCEEDED:
+        break;
+
+        case FAILED:
+        case SKIPPED:
+          return SKIPPED;
+
+        default:
+          result = WAITING;
+        break;
+      }
+    return result;
+  }
+
+  // any thread: the task's own state is only written under the lock
+  void execute(size_t index, double origin)
+  {
+    task_info_t& task = tasks[index];
+    double start = stats::now();
+    int result = task.run();
+    double end = stats::now();
+
+    lock_guard<mutex> lock(tasks_mutex);
+    task.start = start - origin;
+    task.duration = end - start;
+    task.state = (result == EXIT_SUCCESS) ? SUCCEEDED : FAILED;
+    running--;
+    finished.notify_all();
+  }
+
+  bool earlier(const task_info_t* a, const task_info_t* b)
+  {
+    return (a->start < b->start);
+  }
+
+  void report(double total)
+  {
+    vector<const task_info_t*> order;
+    for(size_t i = 0; i < tasks.size(); i++)
+      order.push_back(&tasks[i]);
+    stable_sort(order.begin(), order.end(), earlier);
+
+    double work = 0;
+    log("Start-up tasks (start, duration):");
+    for(size_t i = 0; i < order.size(); i++)
+    {
+      const task_info_t& task = *order[i];
+      if(task.state == SKIPPED)
+      {
+        log("  %-12s skipped", task.name);
+        continue;
+      }
+      log("  %-12s %-6s %7.1f ms %7.1f ms%s", task.name,
+          (task.thread == startup::MAIN_THREAD) ? "main" : "worker",
+          task.start, task.duration,
+          (task.state == FAILED) ? "  FAILED" : "");
+      work += task.duration;
+    }
+
+    stats::set("startup.tasks.ms", total);
+    log("Start-up tasks took %.1f ms (%.1f ms of work, %.1fx overlap)",
+        total, work, (total > 0) ? work/total : 1.0);
+  }
+}
+
+//! --------------------------------------------------------------------------
+//! -------------------------- INTERFACE
+//! --------------------------------------------------------------------------
+
+namespace startup
+{
+  int add(const char* name, initializer_list<const char*> after,
+          thread_t thread, task_t task)
+  {
+    task_info_t info;
+    info.name = name;
+    info.thread = thread;
+    info.run = task;
+    info.state = WAITING;
+    info.start = info.duration = 0;
+
+    // Only earlier tasks: a task can't end up waiting for itself
+    for(initializer_list<const char*>::iterator i = after.begin();
+        i != after.end(); i++)
+    {
+      size_t t = 0;
+      while(t < tasks.size() && strcmp(tasks[t].name, *i))
+        t++;
+      if(t == tasks.size())
+      {
+        log(LOG_ERROR, "Adding start-up task %s : no task %s before it",
+            name, *i);
+        return EXIT_FAILURE;
+      }
+      info.after.push_back(t);
+    }
+
+    tasks.push_back(info);
+    return EXIT_SUCCESS;
+  }
+
+  int run()
+  {
+    // A worker per task that can use one, whatever the number of cores:
+    // these mostly wait on the disk or on drivers, and there are only a few
+    unsigned int n_workers = 0;
+    for(size_t i = 0; i < tasks.size(); i++)
+      if(tasks[i].thread == ANY_THREAD)
+        n_workers++;
+
+    double origin = stats::now();
+    int result = EXIT_SUCCESS;
+    {
+      WorkerPool workers(n_workers ? n_workers : 1);
+      unique_lock<mutex> lock(tasks_mutex);
+      while(true)
+      {
+        // Hand out everything that can start, noting what never will; the
+        // tasks something waits for come before it so one pass is enough
+        size_t on_main = tasks.size();
+        for(size_t i = 0; i < tasks.size(); i++)
+        {
+          task_info_t& task = tasks[i];
+          if(task.state != WAITING)
+            continue;
+
+          state_t ready = readiness(task);
+          if(ready == SKIPPED)
+          {
+            task.state = SKIPPED;
+            result = EXIT_FAILURE;
+          }
+          else if(ready == WAITING)
+            continue;
+          else if(task.thread == MAIN_THREAD)
+          {
+            if(on_main == tasks.size())
+              on_main = i;
+          }
+          else
+          {
+            task.state = RUNNING;
+            running++;
+            workers.submit([i, origin]() { execute(i, origin); });
+          }
+        }
+
+        // The first main thread task that can go runs here, meanwhile
+        if(on_main < tasks.size())
+        {
+          tasks[on_main].state = RUNNING;
+          running++;
+          lock.unlock();
+          execute(on_main, origin);
+          lock.lock();
+          continue;
+        }
+
+        // Nothing left to hand out or wait for
+        if(!running)
+          break;
+        size_t before = running;
+        finished.wait(lock, [before]() { return running < before; });
+      }
+    }
+
+    for(size_t i = 0; i < tasks.size(); i++)
+      if(tasks[i].state == FAILED)
+        result = EXIT_FAILURE;
+
+    report(stats::now() - origin);
+    tasks.clear();
+    return result;
+  }
+}
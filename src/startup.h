@@ -0,0 +1,35 @@
+#pragma once
+
+#include <functional>
+#include <initializer_list>
+
+// Start-up as a set of named tasks, each waiting only for the tasks it
+// names, so that what doesn't depend on anything else (opening the asset
+// pack, watching the assets) goes on while the window and the OpenGL context
+// are created. Tasks that must stay on the main thread (SDL subsystems,
+// windows, the context and anything drawing with it) run there, in the order
+// they were added; the others go to a few worker threads. A task can only
+// wait for tasks added before it, which rules out cycles.
+//
+// When every task is done, when each one started and how long it took is
+// written to the log, so the critical path is plain to see.
+
+namespace startup
+{
+  enum thread_t
+  {
+    ANY_THREAD,
+    MAIN_THREAD
+  };
+
+  // EXIT_SUCCESS, or EXIT_FAILURE to skip whatever waits for it
+  typedef std::function<int()> task_t;
+
+  // declare a task, to run once all of 'after' have succeeded
+  int add(const char* name, std::initializer_list<const char*> after,
+          thread_t thread, task_t task);
+
+  // run every task declared, from the main thread, then forget them:
+  // EXIT_FAILURE if any failed or was skipped
+  int run();
+}
@@ -0,0 +1,61 @@
+#ifndef MPSCQUEUE_HPP_INCLUDED
+#define MPSCQUEUE_HPP_INCLUDED
+
+#include <atomic>
+#include <cstddef>
+#include <stdint.h>
+
+// Bounded lock-free queue for any number of producers and one consumer.
+// Every cell carries a sequence number saying whose turn it is: producers
+// claim a position with a compare-and-swap on the tail, fill the cell, then
+// publish it by bumping its sequence; the consumer only ever reads cells
+// that have been published. Nothing is allocated after construction, and a
+// full queue makes push() fail rather than wait.
+
+#define MPSC_CACHE_LINE 64
+
+template <typename T>
+class MpscQueue
+{
+  /// NESTING
+private:
+  struct cell_t
+  {
+    std::atomic<size_t> sequence;
+    T value;
+  };
+
+  /// ATTRIBUTES
+private:
+  cell_t* cells;
+  size_t mask;
+  // producers and consumer each get their own cache line (padded rather
+  // than aligned so the queue can still be allocated with plain new)
+  char padding0[MPSC_CACHE_LINE];
+  std::atomic<size_t> tail;
+  char padding1[MPSC_CACHE_LINE - sizeof(std::atomic<size_t>)];
+  size_t head;
+  char padding2[MPSC_CACHE_LINE - sizeof(size_t)];
+
+  /// METHODS
+public:
+  // constructors, destructors: the capacity is rounded up to a power of 2
+  MpscQueue(size_t capacity);
+  ~MpscQueue();
+  // any thread: false if the queue is full
+  bool push(const T& value);
+  // consumer thread only: false if the queue is empty
+  bool pop(T& value);
+  // accessors
+  size_t capacity() const;
+
+private:
+  MpscQueue(const MpscQueue&);
+  MpscQueue& operator=(const MpscQueue&);
+};
+
+// NB - "Inline" files are implementations that are included rather than
+// compiled. They are especially useful for templates.
+#include "MpscQueue.inl"
+
+#endif // MPSCQUEUE_HPP_INCLUDED
@@ -0,0 +1,90 @@
+// Inline file: a special implementation that is included rather than compiled
+
+//! --------------------------------------------------------------------------
+//! -------------------------- CONSTRUCTORS, DESTRUCTOR
+//! --------------------------------------------------------------------------
+
+template <typename T>
+MpscQueue<T>::MpscQueue(size_t capacity) :
+cells(nullptr),
+mask(0),
+tail(0),
+head(0)
+{
+  size_t size = 2;
+  while(size < capacity)
+    size <<= 1;
+  mask = size - 1;
+
+  // Cell i is free for the producer that claims position i
+  cells = new cell_t[size];
+  for(size_t i = 0; i < size; i++)
+    cells[i].sequence.store(i, std::memory_order_relaxed);
+}
+
+template <typename T>
+MpscQueue<T>::~MpscQueue()
+{
+  delete[] cells;
+}
+
+//! --------------------------------------------------------------------------
+//! -------------------------- PUSH AND POP
+//! --------------------------------------------------------------------------
+
+template <typename T>
+bool MpscQueue<T>::push(const T& value)
+{
+  cell_t* cell;
+  size_t position = tail.load(std::memory_order_relaxed);
+  while(true)
+  {
+    cell = &cells[position & mask];
+    size_t sequence = cell->sequence.load(std::memory_order_acquire);
+    intptr_t difference = (intptr_t)sequence - (intptr_t)position;
+
+    // Free: try to claim it (on failure 'position' is reloaded for us)
+    if(!difference)
+    {
+      if(tail.compare_exchange_weak(position, position + 1,
+                                    std::memory_order_relaxed))
+        break;
+    }
+    // Not consumed since last time round: full
+    else if(difference < 0)
+      return false;
+    // Someone else got there first
+    else
+      position = tail.load(std::memory_order_relaxed);
+  }
+
+  cell->value = value;
+  cell->sequence.store(position + 1, std::memory_order_release);
+  return true;
+}
+
+template <typename T>
+bool MpscQueue<T>::pop(T& value)
+{
+  cell_t* cell = &cells[head & mask];
+  size_t sequence = cell->sequence.load(std::memory_order_acquire);
+  if(sequence != head + 1)
+    return false;
+
+  value = cell->value;
+
+  // Free the cell for the producer one lap ahead
+  cell->sequence.store(head + mask + 1, std::memory_order_release);
+  head++;
+  return true;
+}
+
+//! --------------------------------------------------------------------------
+//! -------------------------- ACCESSORS
+//! --------------------------------------------------------------------------
+
+template <typename T>
+size_t MpscQueue<T>::capacity() const
+{
+  return mask + 1;
+}
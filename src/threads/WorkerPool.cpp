@@ -0,0 +1,107 @@
+//! --------------------------------------------------------------------------
+//! -------------------------- INCLUDES
+//! --------------------------------------------------------------------------
+
+#include "WorkerPool.hpp"
+
+using namespace std;
+
+//! --------------------------------------------------------------------------
+//! -------------------------- CONSTRUCTORS, DESTRUCTOR
+//! --------------------------------------------------------------------------
+
+WorkerPool::WorkerPool(unsigned int n_threads) :
+threads(),
+tasks_mutex(),
+wake(),
+finished(),
+tasks(),
+unfinished(0),
+running(true)
+{
+  if(!n_threads)
+  {
+    // NB - may be 0 if unknown
+    unsigned int cores = thread::hardware_concurrency();
+    n_threads = (cores > 1) ? cores - 1 : 1;
+  }
+
+  for(unsigned int i = 0; i < n_threads; i++)
+    threads.push_back(thread(&WorkerPool::work, this));
+}
+
+WorkerPool::~WorkerPool()
+{
+  // Finish what was queued first
+  wait();
+
+  {
+    lock_guard<mutex> lock(tasks_mutex);
+    running = false;
+  }
+  wake.notify_all();
+  for(size_t i = 0; i < threads.size(); i++)
+    threads[i].join();
+}
+
+//! --------------------------------------------------------------------------
+//! -------------------------- TASKS
+//! --------------------------------------------------------------------------
+
+void WorkerPool::submit(function<void()> task)
+{
+  {
+    lock_guard<mutex> lock(tasks_mutex);
+    tasks.push_back(task);
+    unfinished++;
+  }
+  wake.notify_one();
+}
+
+void WorkerPool::wait()
+{
+  unique_lock<mutex> lock(tasks_mutex);
+  while(unfinished)
+  {
+    // Lend a hand, or sleep until the last tasks are done elsewhere
+    if(!runOne(lock))
+      finished.wait(lock, [this]() { return !unfinished || !tasks.empty(); });
+  }
+}
+
+bool WorkerPool::runOne(unique_lock<mutex>& lock)
+{
+  if(tasks.empty())
+    return false;
+
+  function<void()> task = move(tasks.front());
+  tasks.pop_front();
+  lock.unlock();
+  task();
+  lock.lock();
+
+  if(!(--unfinished))
+    finished.notify_all();
+  return true;
+}
+
+void WorkerPool::work()
+{
+  unique_lock<mutex> lock(tasks_mutex);
+  while(true)
+  {
+    wake.wait(lock, [this]() { return !running || !tasks.empty(); });
+    if(!running && tasks.empty())
+      break;
+    runOne(lock);
+  }
+}
+
+//! --------------------------------------------------------------------------
+//! -------------------------- ACCESSORS
+//! --------------------------------------------------------------------------
+
+size_t WorkerPool::size() const
+{
+  return threads.size();
+}
@@ -0,0 +1,44 @@
+#ifndef WORKERPOOL_HPP_INCLUDED
+#define WORKERPOOL_HPP_INCLUDED
+
+#include <deque>
+#include <vector>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+// A fixed set of threads working through a shared queue of tasks. The
+// thread that waits for the tasks to finish works on them too rather than
+// going to sleep, so a pool of N threads gets N + 1 workers when waited on.
+
+class WorkerPool
+{
+  /// ATTRIBUTES
+private:
+  std::vector<std::thread> threads;
+  std::mutex tasks_mutex;
+  std::condition_variable wake, finished;
+  std::deque<std::function<void()>> tasks;
+  size_t unfinished;    // queued or running
+  bool running;
+
+  /// METHODS
+public:
+  // constructors, destructors: by default one thread per core but one, for
+  // the thread that waits
+  WorkerPool(unsigned int n_threads = 0);
+  ~WorkerPool();
+  // queue a task
+  void submit(std::function<void()> task);
+  // help with the tasks until there are none left
+  void wait();
+  // accessors
+  size_t size() const;
+
+private:
+  void work();
+  bool runOne(std::unique_lock<std::mutex>& lock);
+};
+
+#endif // WORKERPOOL_HPP_INCLUDED
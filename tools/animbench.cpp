@@ -0,0 +1,210 @@
+//! --------------------------------------------------------------------------
+//! -------------------------- INCLUDES
+//! --------------------------------------------------------------------------
+
+#include <cstdlib>
+#include <cstdio>
+#include <cmath>
+#include <vector>
+#include <chrono>
+#include <functional>
+
+#include "../src/graphics/Animator.hpp"
+
+using namespace std;
+
+// Benchmark for the animator: advancing tens of thousands of animated
+// sprites each update, compared with what it replaced, a callback per
+// sprite doing its own float maths. Sprites play one of a few sequences of
+// an atlas on one of a few clocks; motions glide between keys.
+//
+//    animbench [instances=50000] [updates=600]
+
+//! --------------------------------------------------------------------------
+//! -------------------------- WORKSPACE
+//! --------------------------------------------------------------------------
+
+#define N_SEQUENCES 8
+#define N_FRAMES 8
+#define N_CLOCKS 4
+#define DT (1.0f/60.0f)
+
+// Never loaded: the animator only hands it back
+static Texture atlas;
+
+static double now()
+{
+  return chrono::duration<double, milli>(
+    chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static void report(const char* name, size_t updates, double ms)
+{
+  printf("%-28s %9.2f ms   %7.4f ms/update\n", name, ms, ms/updates);
+}
+
+//! --------------------------------------------------------------------------
+//! -------------------------- CONTENDERS
+//! --------------------------------------------------------------------------
+
+// A lambda per sprite, each with its own time, as the title used to be
+static double with_callbacks(size_t n, size_t updates, float& checksum)
+{
+  struct sprite_t
+  {
+    float t, speed;
+    fRect frame;
+  };
+  vector<sprite_t*> sprites;
+  vector<function<void(float)>> callbacks;
+  for(size_t i = 0; i < n; i++)
+  {
+    sprite_t* s = new sprite_t();
+    s->speed = 1.0f + (i % N_CLOCKS)*0.25f;
+    sprites.push_back(s);
+    callbacks.push_back([s](float dt)
+    {
+      s->t += dt*s->speed;
+      int frame = (int)(s->t*12) % N_FRAMES;
+      s->frame = fRect(frame*32, 0, 32, 32);
+    });
+  }
+
+  double start = now();
+  for(size_t u = 0; u < updates; u++)
+    for(size_t i = 0; i < callbacks.size(); i++)
+      callbacks[i](DT);
+  double ms = now() - start;
+
+  for(size_t i = 0; i < n; i++)
+  {
+    checksum += sprites[i]->frame.x;
+    delete sprites[i];
+  }
+  return ms;
+}
+
+static double with_sprites(size_t n, size_t updates, float& checksum)
+{
+  Animator animator;
+  fRect frames[N_FRAMES];
+  for(int f = 0; f < N_FRAMES; f++)
+    frames[f] = fRect(f*32, 0, 32, 32);
+  uint32_t sequences[N_SEQUENCES], clocks[N_CLOCKS];
+  for(int s = 0; s < N_SEQUENCES; s++)
+    sequences[s] = animator.addSequence(atlas, frames, N_FRAMES, 12,
+                                        (Animator::mode_t)(s % 3));
+  for(int c = 0; c < N_CLOCKS; c++)
+    clocks[c] = animator.addClock(1.0f + c*0.25f);
+
+  vector<handle_t> handles;
+  for(size_t i = 0; i < n; i++)
+    handles.push_back(animator.play(sequences[i % N_SEQUENCES],
+                                    clocks[i % N_CLOCKS]));
+
+  double start = now();
+  for(size_t u = 0; u < updates; u++)
+    animator.update(DT);
+  double ms = now() - start;
+
+  for(size_t i = 0; i < n; i++)
+    checksum += animator.getFrame(handles[i])->x;
+  return ms;
+}
+
+static double with_motions(size_t n, size_t updates, float& checksum)
+{
+  Animator animator;
+  fRect keys[N_FRAMES];
+  for(int k = 0; k < N_FRAMES; k++)
+    keys[k] = fRect(64*sin(k*0.8f), 64*cos(k*0.8f), 32, 32);
+  uint32_t motions[N_SEQUENCES];
+  for(int m = 0; m < N_SEQUENCES; m++)
+    motions[m] = animator.addMotion(keys, N_FRAMES, 12,
+                                    (Animator::mode_t)(m % 3));
+
+  vector<handle_t> handles;
+  for(size_t i = 0; i < n; i++)
+    handles.push_back(animator.play(motions[i % N_SEQUENCES]));
+
+  double start = now();
+  for(size_t u = 0; u < updates; u++)
+    animator.update(DT);
+  double ms = now() - start;
+
+  for(size_t i = 0; i < n; i++)
+    checksum += animator.getRect(handles[i]).x;
+  return ms;
+}
+
+// A hundredth of the sprites replaced every update, as effects come and go
+static double with_churn(size_t n, size_t updates, size_t& stale)
+{
+  Animator animator;
+  fRect frames[N_FRAMES];
+  for(int f = 0; f < N_FRAMES; f++)
+    frames[f] = fRect(f*32, 0, 32, 32);
+  uint32_t sequence = animator.addSequence(atlas, frames, N_FRAMES, 12,
+                                           Animator::ONCE);
+
+  vector<handle_t> handles, stopped;
+  for(size_t i = 0; i < n; i++)
+    handles.push_back(animator.play(sequence));
+
+  size_t replaced = n/100 ? n/100 : 1;
+  double start = now();
+  for(size_t u = 0; u < updates; u++)
+  {
+    for(size_t r = 0; r < replaced; r++)
+    {
+      size_t i = (u*replaced + r) % n;
+      animator.stop(handles[i]);
+      if(stopped.size() < n)
+        stopped.push_back(handles[i]);
+      handles[i] = animator.play(sequence);
+    }
+    animator.update(DT);
+  }
+  double ms = now() - start;
+
+  // Handles to stopped sprites must not find the ones that replaced them
+  stale = 0;
+  for(size_t i = 0; i < stopped.size(); i++)
+    if(!animator.getFrame(stopped[i]))
+      stale++;
+  return ms;
+}
+
+//! --------------------------------------------------------------------------
+//! -------------------------- BENCHMARKS
+//! --------------------------------------------------------------------------
+
+int main(int argc, char *argv[])
+{
+  size_t n = (argc > 1) ? strtoul(argv[1], nullptr, 10) : 50000;
+  size_t updates = (argc > 2) ? strtoul(argv[2], nullptr, 10) : 600;
+  if(!n || !updates)
+  {
+    fprintf(stderr, "Usage: animbench [instances] [updates]\n");
+    return EXIT_FAILURE;
+  }
+  printf("%llu instances, %llu updates\n", (unsigned long long)n,
+         (unsigned long long)updates);
+
+  // Twice each: the first run also pays for the pages the heap gets
+  float checksum = 0;
+  size_t stale = 0;
+  for(int run = 0; run < 2; run++)
+  {
+    report("callback per sprite", updates,
+           with_callbacks(n, updates, checksum));
+    report("Animator, sprites", updates, with_sprites(n, updates, checksum));
+    report("Animator, motions", updates, with_motions(n, updates, checksum));
+    report("Animator, 1% replaced", updates, with_churn(n, updates, stale));
+  }
+  // (printed so that none of the work can be optimised away)
+  printf("checksum %g, %llu stopped handle(s) detected as stale\n",
+         checksum, (unsigned long long)stale);
+
+  return EXIT_SUCCESS;
+}
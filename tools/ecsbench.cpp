@@ -0,0 +1,235 @@
+//! --------------------------------------------------------------------------
+//! -------------------------- INCLUDES
+//! --------------------------------------------------------------------------
+
+#include <cstdlib>
+#include <cstdio>
+#include <cmath>
+#include <memory>
+#include <vector>
+#include <chrono>
+
+#include "../src/ecs/World.hpp"
+#include "../src/ecs/Query.hpp"
+#include "../src/ecs/Scheduler.hpp"
+#include "../src/threads/WorkerPool.hpp"
+
+using namespace std;
+
+// Benchmark for the entity component system: moves a million entities with
+// a position and a velocity, compared with the two usual alternatives (an
+// array of structures, and heap-allocated objects with a virtual update).
+//
+//    ecsbench [entities] [repetitions]
+
+//! --------------------------------------------------------------------------
+//! -------------------------- COMPONENTS
+//! --------------------------------------------------------------------------
+
+struct position_t { float x, y; };
+struct velocity_t { float x, y; };
+struct health_t { float hit_points, regeneration; };
+struct sprite_t { uint32_t texture; float angle, scale, depth; };
+
+#define DT (1.0f/60.0f)
+
+//! --------------------------------------------------------------------------
+//! -------------------------- BASELINES
+//! --------------------------------------------------------------------------
+
+// What a game object typically looks like without components
+struct object_t
+{
+  position_t position;
+  velocity_t velocity;
+  health_t health;
+  sprite_t sprite;
+};
+
+class Object
+{
+public:
+  object_t data;
+  virtual ~Object() {}
+  virtual void update(float dt)
+  {
+    data.position.x += data.velocity.x*dt;
+    data.position.y += data.velocity.y*dt;
+  }
+};
+
+//! --------------------------------------------------------------------------
+//! -------------------------- TIMING
+//! --------------------------------------------------------------------------
+
+static double now()
+{
+  return chrono::duration<double, milli>(
+    chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Best and average of several runs, in milliseconds
+template <typename F>
+static void measure(const char* name, int repetitions, F f)
+{
+  double best = 1e9, total = 0;
+  for(int r = 0; r < repetitions; r++)
+  {
+    double start = now();
+    f();
+    double ms = now() - start;
+    total += ms;
+    if(ms < best)
+      best = ms;
+  }
+  printf("%-32s best %8.3f ms   average %8.3f ms\n", name, best,
+         total/repetitions);
+}
+
+static float velocity(size_t i)
+{
+  return (float)(i % 100) - 50.0f;
+}
+
+//! --------------------------------------------------------------------------
+//! -------------------------- MAIN
+//! --------------------------------------------------------------------------
+
+int main(int argc, char *argv[])
+{
+  size_t n = (argc > 1) ? strtoul(argv[1], nullptr, 10) : 1000000;
+  int repetitions = (argc > 2) ? atoi(argv[2]) : 20;
+  printf("%llu entities, %d repetitions\n", (unsigned long long)n,
+         repetitions);
+
+  // ------------------------------------------------------------------------
+  // ARRAY OF STRUCTURES
+  // ------------------------------------------------------------------------
+
+  vector<object_t> objects(n);
+  for(size_t i = 0; i < n; i++)
+  {
+    object_t o = { { 0, 0 }, { velocity(i), 1 }, { 100, 1 }, { 0, 0, 1, 0 } };
+    objects[i] = o;
+  }
+  measure("array of structures", repetitions, [&]()
+  {
+    for(size_t i = 0; i < n; i++)
+    {
+      objects[i].position.x += objects[i].velocity.x*DT;
+      objects[i].position.y += objects[i].velocity.y*DT;
+    }
+  });
+
+  // ------------------------------------------------------------------------
+  // POLYMORPHIC OBJECTS
+  // ------------------------------------------------------------------------
+
+  {
+    vector<unique_ptr<Object>> heap;
+    for(size_t i = 0; i < n; i++)
+    {
+      heap.push_back(unique_ptr<Object>(new Object()));
+      heap.back()->data = objects[i];
+    }
+    measure("heap objects, virtual update", repetitions, [&]()
+    {
+      for(size_t i = 0; i < n; i++)
+        heap[i]->update(DT);
+    });
+  }
+
+  // ------------------------------------------------------------------------
+  // ENTITY COMPONENT SYSTEM
+  // ------------------------------------------------------------------------
+
+  World world;
+  double start = now();
+  for(size_t i = 0; i < n; i++)
+  {
+    position_t p = { 0, 0 };
+    velocity_t v = { velocity(i), 1 };
+    health_t h = { 100, 1 };
+    sprite_t s = { 0, 0, 1, 0 };
+
+    // A few different archetypes, as in a real game
+    switch(i % 4)
+    {
+      case 0: world.create(p, v); break;
+      case 1: world.create(p, v, h); break;
+      case 2: world.create(p, v, s); break;
+      default: world.create(p, v, h, s); break;
+    }
+  }
+  printf("%-32s %8.3f ms\n", "creating entities", now() - start);
+
+  Query moving(world, components::mask<position_t, velocity_t>());
+  printf("%llu entities in %llu archetypes\n",
+         (unsigned long long)moving.size(),
+         (unsigned long long)moving.getMatches().size());
+
+  measure("query, each entity", repetitions, [&]()
+  {
+    moving.each<position_t, velocity_t>([](position_t& p, const velocity_t& v)
+    {
+      p.x += v.x*DT;
+      p.y += v.y*DT;
+    });
+  });
+
+  measure("query, whole chunks", repetitions, [&]()
+  {
+    moving.chunks<position_t, velocity_t>(
+      [](uint32_t count, position_t* p, const velocity_t* v)
+    {
+      for(uint32_t i = 0; i < count; i++)
+      {
+        p[i].x += v[i].x*DT;
+        p[i].y += v[i].y*DT;
+      }
+    });
+  });
+
+  // Two systems that don't touch the same data run side by side
+  WorkerPool pool;
+  Query living(world, components::mask<health_t>());
+  Scheduler scheduler(&pool);
+  scheduler.add("ecsbench.move", components::mask<velocity_t>(),
+                components::mask<position_t>(), [&](World&)
+  {
+    moving.chunks<position_t, velocity_t>(
+      [](uint32_t count, position_t* p, const velocity_t* v)
+    {
+      for(uint32_t i = 0; i < count; i++)
+      {
+        p[i].x += v[i].x*DT;
+        p[i].y += v[i].y*DT;
+      }
+    });
+  });
+  scheduler.add("ecsbench.regenerate", 0, components::mask<health_t>(),
+                [&](World&)
+  {
+    living.each<health_t>([](health_t& h)
+    {
+      h.hit_points += h.regeneration*DT;
+    });
+  });
+  printf("2 systems in %llu stage(s) on %llu worker thread(s)\n",
+         (unsigned long long)scheduler.getStageCount(),
+         (unsigned long long)(pool.size() + 1));
+  measure("scheduler, move + regenerate", repetitions, [&]()
+  {
+    scheduler.run(world);
+  });
+
+  // Check the ECS moved things like the baseline did (it ran 3 times more)
+  double error = 0;
+  moving.eachEntity<position_t>([&](entity_t e, const position_t& p)
+  {
+    error += fabs(p.y - 3*objects[0].position.y);
+  });
+  printf("position error: %g\n", error/n);
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,169 @@
+//! --------------------------------------------------------------------------
+//! -------------------------- INCLUDES
+//! --------------------------------------------------------------------------
+
+#include <cstdlib>
+#include <cstdio>
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "../src/events/events.h"
+
+using namespace std;
+
+// Benchmark for the event bus: how many events per second one thread can
+// publish and dispatch, then several producer threads publishing to a
+// consumer draining at the same time, compared with a queue behind a mutex.
+//
+//    eventbench [events per producer] [producers]
+
+//! --------------------------------------------------------------------------
+//! -------------------------- WORKSPACE
+//! --------------------------------------------------------------------------
+
+// A typical payload: who hit what, where
+struct collision_t
+{
+  uint32_t a, b;
+  float x, y;
+};
+
+#define BENCH_EVENT (events::USER + 0)
+
+static double now()
+{
+  return chrono::duration<double, milli>(
+    chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static void report(const char* name, size_t n, double ms)
+{
+  printf("%-36s %8.2f ms   %7.2f million events/s\n", name, ms,
+         n/ms/1000.0);
+}
+
+//! --------------------------------------------------------------------------
+//! -------------------------- BENCHMARKS
+//! --------------------------------------------------------------------------
+
+int main(int argc, char *argv[])
+{
+  size_t n = (argc > 1) ? strtoul(argv[1], nullptr, 10) : 4000000;
+  unsigned int producers = (argc > 2) ? atoi(argv[2]) : 3;
+  printf("%llu events per producer, %u producer(s)\n",
+         (unsigned long long)n, producers);
+
+  // ------------------------------------------------------------------------
+  // ONE THREAD
+  // ------------------------------------------------------------------------
+
+  uint64_t sum = 0;
+  events::subscribe(BENCH_EVENT, [&](const events::event_t& event)
+  {
+    sum += event.as<collision_t>().a;
+  });
+
+  double start = now();
+  for(size_t i = 0; i < n; i++)
+  {
+    collision_t collision = { (uint32_t)i, 0, 1.0f, 2.0f };
+    events::publish(BENCH_EVENT, collision);
+    // Keep within the queue, as a frame's worth of events would
+    if((i % 1024) == 1023)
+      events::dispatch();
+  }
+  events::dispatch();
+  report("publish + dispatch, one thread", n, now() - start);
+  if(sum != (uint64_t)n*(n - 1)/2)
+    printf("ERROR: lost events (sum %llu)\n", (unsigned long long)sum);
+
+  // ------------------------------------------------------------------------
+  // PRODUCERS AND A CONSUMER
+  // ------------------------------------------------------------------------
+
+  // A consumer of its own so that MAIN's handler isn't called again
+  events::consumer_t consumer = events::add_consumer("bench", 1 << 16);
+  size_t received = 0;              // consumer's thread only
+  atomic<size_t> retries(0);
+  events::subscribe(BENCH_EVENT + 1, [&](const events::event_t& event)
+  {
+    received++;
+  }, consumer);
+
+  start = now();
+  {
+    vector<thread> threads;
+    for(unsigned int p = 0; p < producers; p++)
+      threads.push_back(thread([&, p]()
+      {
+        for(size_t i = 0; i < n; i++)
+        {
+          collision_t collision = { p, (uint32_t)i, 0.0f, 0.0f };
+          // The consumer is running flat out: wait for it rather than drop
+          while(!events::publish(BENCH_EVENT + 1, collision))
+            retries.fetch_add(1, memory_order_relaxed);
+        }
+      }));
+
+    size_t total = n*producers;
+    while(received < total)
+      if(!events::dispatch(consumer))
+        this_thread::yield();
+
+    for(size_t i = 0; i < threads.size(); i++)
+      threads[i].join();
+  }
+  report("lock-free, producers + consumer", n*producers, now() - start);
+  printf("%llu event(s) received, %llu retries on a full queue\n",
+         (unsigned long long)received, (unsigned long long)retries.load());
+
+  // ------------------------------------------------------------------------
+  // BASELINE: A QUEUE BEHIND A MUTEX
+  // ------------------------------------------------------------------------
+
+  {
+    mutex queue_mutex;
+    deque<events::event_t> queue;
+    size_t popped = 0;
+
+    start = now();
+    vector<thread> threads;
+    for(unsigned int p = 0; p < producers; p++)
+      threads.push_back(thread([&, p]()
+      {
+        for(size_t i = 0; i < n; i++)
+        {
+          events::event_t event;
+          event.type = BENCH_EVENT + 1;
+          event.size = sizeof(collision_t);
+          collision_t collision = { p, (uint32_t)i, 0.0f, 0.0f };
+          memcpy(event.payload, &collision, sizeof(collision));
+          lock_guard<mutex> lock(queue_mutex);
+          queue.push_back(event);
+        }
+      }));
+
+    size_t total = n*producers;
+    while(popped < total)
+    {
+      deque<events::event_t> batch;
+      {
+        lock_guard<mutex> lock(queue_mutex);
+        batch.swap(queue);
+      }
+      if(batch.empty())
+        this_thread::yield();
+      popped += batch.size();
+    }
+
+    for(size_t i = 0; i < threads.size(); i++)
+      threads[i].join();
+    report("mutex + deque, producers + consumer", total, now() - start);
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,202 @@
+//! --------------------------------------------------------------------------
+//! -------------------------- INCLUDES
+//! --------------------------------------------------------------------------
+
+#include <cstdlib>
+#include <cstdio>
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include "SDL.h"
+#include "SDL_image.h"
+
+#include "../src/io/fileio.h"
+#include "../src/io/filesystem.h"
+#include "../src/io/MappedFile.hpp"
+
+using namespace std;
+
+// Benchmark for asynchronous file reads: thousands of small images (copies
+// of the assets) loaded one IMG_Load at a time, then read through fileio
+// with io_uring and with worker threads, decoded from memory as each read
+// completes. The same again reading only, to separate I/O from decoding.
+// Files are read once beforehand, so these are warm-cache numbers.
+//
+//    iobench [files] [directory]
+
+//! --------------------------------------------------------------------------
+//! -------------------------- WORKSPACE
+//! --------------------------------------------------------------------------
+
+// big enough for any of the assets
+#define SLOT_SIZE (16 << 10)
+
+static const char* sources[] =
+{
+  "assets/eye_of_draining.png",
+  "assets/font.png",
+  "assets/ice0.png",
+  "assets/lava0.png"
+};
+#define N_SOURCES (sizeof(sources)/sizeof(sources[0]))
+
+static vector<string> paths;
+static vector<unsigned char> buffers;
+
+static double now()
+{
+  return chrono::duration<double, milli>(
+    chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static void report(const char* name, size_t n, size_t bytes, double ms)
+{
+  printf("%-36s %8.2f ms   %8.0f files/s   %7.1f MB/s\n", name, ms,
+         n/ms*1000.0, bytes/ms/1000.0);
+}
+
+static int create_files(size_t n, const char* directory)
+{
+  if(filesystem::make_directory(directory) != EXIT_SUCCESS)
+    return EXIT_FAILURE;
+
+  for(size_t i = 0; i < n; i++)
+  {
+    MappedFile source;
+    if(source.open(sources[i % N_SOURCES]) != EXIT_SUCCESS
+    || source.getSize() > SLOT_SIZE)
+      return EXIT_FAILURE;
+
+    char name[32];
+    snprintf(name, sizeof(name), "/%06llu.png", (unsigned long long)i);
+    paths.push_back(string(directory) + name);
+    FILE* file = fopen(paths.back().c_str(), "wb");
+    if(!file)
+      return EXIT_FAILURE;
+    fwrite(source.getData(), 1, source.getSize(), file);
+    fclose(file);
+  }
+  return EXIT_SUCCESS;
+}
+
+// Queue everything, wait for everything: as a loading screen would
+static size_t read_all(bool decode, size_t& failed)
+{
+  size_t bytes = 0;
+  for(size_t i = 0; i < paths.size(); i++)
+  {
+    unsigned char* slot = &buffers[i*SLOT_SIZE];
+    fileio::read(paths[i].c_str(), slot, SLOT_SIZE, [&, slot](long n)
+    {
+      if(n < 0)
+      {
+        failed++;
+        return;
+      }
+      bytes += n;
+      if(!decode)
+        return;
+      SDL_Surface* surface =
+        IMG_Load_RW(SDL_RWFromConstMem(slot, (int)n), 1);
+      if(surface)
+        SDL_FreeSurface(surface);
+      else
+        failed++;
+    });
+  }
+  fileio::wait();
+  return bytes;
+}
+
+static void bench_fileio(fileio::backend_t backend, const char* read_name,
+                         const char* decode_name)
+{
+  fileio::start(backend);
+  if(fileio::backend() != backend)
+  {
+    printf("%-36s unavailable\n", read_name);
+    fileio::stop();
+    return;
+  }
+
+  size_t failed = 0;
+  double start = now();
+  size_t bytes = read_all(false, failed);
+  report(read_name, paths.size(), bytes, now() - start);
+
+  start = now();
+  bytes = read_all(true, failed);
+  report(decode_name, paths.size(), bytes, now() - start);
+
+  fileio::stop();
+  if(failed)
+    printf("ERROR: %llu file(s) failed\n", (unsigned long long)failed);
+}
+
+//! --------------------------------------------------------------------------
+//! -------------------------- BENCHMARKS
+//! --------------------------------------------------------------------------
+
+int main(int argc, char *argv[])
+{
+  size_t n = (argc > 1) ? strtoul(argv[1], nullptr, 10) : 4000;
+  const char* directory = (argc > 2) ? argv[2] : "iobench.tmp";
+  printf("%llu files in %s\n", (unsigned long long)n, directory);
+
+  if(create_files(n, directory) != EXIT_SUCCESS)
+  {
+    fprintf(stderr, "Could not create the files (run from the root)\n");
+    return EXIT_FAILURE;
+  }
+  buffers.resize(n*SLOT_SIZE);
+
+  // Warm the page cache so every run starts equal
+  size_t failed = 0;
+  fileio::start(fileio::THREADS);
+  read_all(false, failed);
+  fileio::stop();
+
+  // ------------------------------------------------------------------------
+  // ONE FILE AT A TIME
+  // ------------------------------------------------------------------------
+
+  size_t bytes = 0;
+  double start = now();
+  for(size_t i = 0; i < n; i++)
+  {
+    FILE* file = fopen(paths[i].c_str(), "rb");
+    if(!file)
+      continue;
+    bytes += fread(&buffers[i*SLOT_SIZE], 1, SLOT_SIZE, file);
+    fclose(file);
+  }
+  report("fopen + fread per file", n, bytes, now() - start);
+
+  start = now();
+  for(size_t i = 0; i < n; i++)
+  {
+    SDL_Surface* surface = IMG_Load(paths[i].c_str());
+    if(surface)
+      SDL_FreeSurface(surface);
+    else
+      failed++;
+  }
+  report("IMG_Load per file", n, bytes, now() - start);
+
+  // ------------------------------------------------------------------------
+  // ASYNCHRONOUS
+  // ------------------------------------------------------------------------
+
+  bench_fileio(fileio::URING, "fileio, io_uring",
+               "fileio, io_uring + IMG_Load_RW");
+  bench_fileio(fileio::THREADS, "fileio, threads",
+               "fileio, threads + IMG_Load_RW");
+
+  for(size_t i = 0; i < n; i++)
+    remove(paths[i].c_str());
+  remove(directory);
+  if(failed)
+    printf("ERROR: %llu file(s) failed\n", (unsigned long long)failed);
+  return EXIT_SUCCESS;
+}
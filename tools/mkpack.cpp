@@ -0,0 +1,277 @@
+//! --------------------------------------------------------------------------
+//! -------------------------- INCLUDES
+//! --------------------------------------------------------------------------
+
+#include <cstdlib>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+#ifdef WIN32
+  #include <direct.h>       // for _chdir
+  #define chdir _chdir
+#else
+  #include <unistd.h>       // for chdir
+#endif // WIN32
+
+#include "zlib.h"
+
+#include "../src/hashid.h"
+#include "../src/io/pack.h"
+#include "../src/io/MappedFile.hpp"
+#include "../src/io/filesystem.h"
+
+using namespace std;
+
+// Offline packer: loose files to a ".pak" archive read by the io/pack module.
+//
+//    mkpack [-C directory] [-s] output.pak input [more inputs ...]
+//
+// Inputs are files or directories (packed recursively); each entry keeps the
+// path it was given, so run from the directory the game runs from, or use -C
+// to move there first. Entries are deflated when that saves at least an
+// eighth of their size (so PNGs usually aren't), unless -s says to store all.
+
+//! --------------------------------------------------------------------------
+//! -------------------------- CONSTANTS
+//! --------------------------------------------------------------------------
+
+// deflate only if the result is at most 7/8 of the original
+#define DEFLATE_NUMERATOR 7
+#define DEFLATE_DENOMINATOR 8
+
+//! --------------------------------------------------------------------------
+//! -------------------------- ENTRIES
+//! --------------------------------------------------------------------------
+
+struct source_t
+{
+  string name;
+  pack::entry_t entry;
+  vector<unsigned char> deflated;   // empty if stored
+};
+
+static bool by_id(const source_t& a, const source_t& b)
+{
+  return (a.entry.id < b.entry.id
+          || (a.entry.id == b.entry.id && a.name < b.name));
+}
+
+// Same path whatever the platform and however it was typed
+static string normalise(string name)
+{
+  replace(name.begin(), name.end(), '\\', '/');
+  while(name.compare(0, 2, "./") == 0)
+    name.erase(0, 2);
+  return name;
+}
+
+static int deflate_source(const MappedFile& file, source_t& source)
+{
+  uLongf size = compressBound((uLong)file.getSize());
+  source.deflated.resize(size);
+  if(compress2(source.deflated.data(), &size, file.getData(),
+               (uLong)file.getSize(), Z_BEST_COMPRESSION) != Z_OK)
+    return EXIT_FAILURE;
+
+  if(size*DEFLATE_DENOMINATOR > file.getSize()*DEFLATE_NUMERATOR)
+    source.deflated.clear();
+  else
+    source.deflated.resize(size);
+  return EXIT_SUCCESS;
+}
+
+//! --------------------------------------------------------------------------
+//! -------------------------- OUTPUT
+//! --------------------------------------------------------------------------
+
+static bool pad(FILE* file, uint64_t& offset)
+{
+  static const char padding[PACK_ALIGN] = { 0 };
+  size_t n = (size_t)((PACK_ALIGN - offset % PACK_ALIGN) % PACK_ALIGN);
+  offset += n;
+  return (fwrite(padding, 1, n, file) == n);
+}
+
+static int write_pack(const char* output, vector<source_t>& sources)
+{
+  // Write to a temporary file and swap it in: the game may have the old one
+  // mapped, and a failed run shouldn't leave half a pack behind
+  string temporary = string(output) + ".tmp";
+  FILE* file = fopen(temporary.c_str(), "wb");
+  if(!file)
+  {
+    fprintf(stderr, "%s: could not open\n", temporary.c_str());
+    return EXIT_FAILURE;
+  }
+
+  pack::header_t header;
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, PACK_MAGIC, 4);
+  header.version = PACK_VERSION;
+  header.count = sources.size();
+  bool valid = (fwrite(&header, sizeof(header), 1, file) == 1);
+  uint64_t offset = sizeof(header);
+
+  // Data, each entry on its own page
+  string names;
+  for(size_t i = 0; valid && i < sources.size(); i++)
+  {
+    source_t& source = sources[i];
+    valid = pad(file, offset);
+    source.entry.offset = offset;
+    source.entry.name = names.size();
+    names.append(source.name.c_str(), source.name.size() + 1);
+
+    if(!source.deflated.empty())
+      valid = valid && (fwrite(source.deflated.data(), 1,
+                               source.deflated.size(), file)
+                        == source.deflated.size());
+    else
+    {
+      MappedFile input;
+      valid = valid && (source.entry.size == 0
+                        || (input.open(source.name.c_str()) == EXIT_SUCCESS
+                            && input.getSize() == source.entry.size
+                            && fwrite(input.getData(), 1, input.getSize(),
+                                      file) == input.getSize()));
+    }
+    offset += source.entry.size;
+  }
+
+  // Index and names at the end, where they can be found from the header
+  valid = valid && pad(file, offset);
+  header.index = offset;
+  for(size_t i = 0; valid && i < sources.size(); i++)
+    valid = (fwrite(&sources[i].entry, sizeof(pack::entry_t), 1, file) == 1);
+  header.names = header.index + sources.size()*sizeof(pack::entry_t);
+  valid = valid
+    && (fwrite(names.data(), 1, names.size(), file) == names.size())
+    && fseek(file, 0, SEEK_SET) == 0
+    && (fwrite(&header, sizeof(header), 1, file) == 1);
+  valid = (fclose(file) == 0) && valid;
+
+  if(!valid || filesystem::replace(temporary.c_str(), output) != EXIT_SUCCESS)
+  {
+    remove(temporary.c_str());
+    fprintf(stderr, "%s: could not write\n", output);
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
+
+//! --------------------------------------------------------------------------
+//! -------------------------- ENTRY POINT
+//! --------------------------------------------------------------------------
+
+int main(int argc, char* argv[])
+{
+  bool store_only = false;
+  int i = 1;
+  for(; i < argc && argv[i][0] == '-'; i++)
+  {
+    if(!strcmp(argv[i], "-s"))
+      store_only = true;
+    else if(!strcmp(argv[i], "-C") && i + 1 < argc)
+    {
+      if(chdir(argv[++i]) != 0)
+      {
+        fprintf(stderr, "%s: no such directory\n", argv[i]);
+        return EXIT_FAILURE;
+      }
+    }
+    else
+      break;
+  }
+  if(argc - i < 2)
+  {
+    fprintf(stderr, "usage: %s [-C directory] [-s] output.pak input ...\n",
+            argv[0]);
+    return EXIT_FAILURE;
+  }
+  const char* output = argv[i++];
+
+  // Gather every file to be packed
+  vector<string> files;
+  for(; i < argc; i++)
+  {
+    int64_t mtime;
+    uint64_t size;
+    if(filesystem::list(argv[i], files) != EXIT_SUCCESS)
+    {
+      if(filesystem::status(argv[i], mtime, size) != EXIT_SUCCESS)
+      {
+        fprintf(stderr, "%s: no such file or directory\n", argv[i]);
+        return EXIT_FAILURE;
+      }
+      files.push_back(argv[i]);
+    }
+  }
+
+  vector<source_t> sources(files.size());
+  for(size_t f = 0; f < files.size(); f++)
+  {
+    source_t& source = sources[f];
+    source.name = normalise(files[f]);
+    memset(&source.entry, 0, sizeof(source.entry));
+    source.entry.id = hashid::hash(source.name.c_str());
+
+    // Empty files can't be mapped, but they can be packed
+    MappedFile input;
+    int64_t mtime;
+    uint64_t size;
+    if(filesystem::status(source.name.c_str(), mtime, size) != EXIT_SUCCESS
+    || (size && input.open(source.name.c_str()) != EXIT_SUCCESS))
+    {
+      fprintf(stderr, "%s: could not read\n", source.name.c_str());
+      return EXIT_FAILURE;
+    }
+    source.entry.original_size = size;
+    // So that the game can tell whether a cached decode is still good
+    // without reading the entry again
+    source.entry.content_hash = size ? hashid::hash(input.getData(), size)
+                                     : hashid::hash("", 0);
+    if(!store_only && size && deflate_source(input, source) != EXIT_SUCCESS)
+    {
+      fprintf(stderr, "%s: could not deflate\n", source.name.c_str());
+      return EXIT_FAILURE;
+    }
+    source.entry.flags = source.deflated.empty() ? 0 : pack::DEFLATED;
+    source.entry.size = source.deflated.empty() ?
+      size : source.deflated.size();
+  }
+
+  // Sorted by id for the binary search, which only compares ids
+  sort(sources.begin(), sources.end(), by_id);
+  for(size_t s = 1; s < sources.size(); s++)
+    if(sources[s].entry.id == sources[s - 1].entry.id)
+    {
+      if(sources[s].name == sources[s - 1].name)
+        fprintf(stderr, "%s: packed twice\n", sources[s].name.c_str());
+      else
+        fprintf(stderr, "%s: same id as %s, rename one\n",
+                sources[s].name.c_str(), sources[s - 1].name.c_str());
+      return EXIT_FAILURE;
+    }
+
+  if(write_pack(output, sources) != EXIT_SUCCESS)
+    return EXIT_FAILURE;
+
+  uint64_t original = 0, stored = 0;
+  for(size_t s = 0; s < sources.size(); s++)
+  {
+    const pack::entry_t& entry = sources[s].entry;
+    printf("%-40s %10llu -> %10llu %s\n", sources[s].name.c_str(),
+           (unsigned long long)entry.original_size,
+           (unsigned long long)entry.size,
+           (entry.flags & pack::DEFLATED) ? "deflated" : "stored");
+    original += entry.original_size;
+    stored += entry.size;
+  }
+  printf("%s: %u entries, %llu bytes of data in %llu\n", output,
+         (unsigned)sources.size(), (unsigned long long)original,
+         (unsigned long long)stored);
+  return EXIT_SUCCESS;
+}
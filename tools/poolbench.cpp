@@ -0,0 +1,219 @@
+//! --------------------------------------------------------------------------
+//! -------------------------- INCLUDES
+//! --------------------------------------------------------------------------
+
+#include <cstdlib>
+#include <cstdio>
+#include <list>
+#include <vector>
+#include <chrono>
+
+#include "../src/memory/Pool.hpp"
+#include "../src/memory/SlotMap.hpp"
+
+using namespace std;
+
+// Benchmark for object pools and slot maps: creating, iterating over and
+// destroying a lot of small objects, compared with allocating each one with
+// new and keeping pointers in a std::list (what babysitter used to do).
+//
+//    poolbench [objects]
+
+//! --------------------------------------------------------------------------
+//! -------------------------- WORKSPACE
+//! --------------------------------------------------------------------------
+
+// About the size of a sprite or a tween
+struct object_t
+{
+  float x, y, dx, dy;
+  float progress, speed;
+  uint32_t texture, flags;
+
+  object_t(float _x = 0) :
+  x(_x), y(0), dx(1), dy(1), progress(0), speed(1), texture(0), flags(0)
+  {
+  }
+
+  void step()
+  {
+    x += dx;
+    y += dy;
+    progress += speed;
+  }
+};
+
+static double now()
+{
+  return chrono::duration<double, milli>(
+    chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+struct timings_t
+{
+  double create, iterate, erase, churn, destroy;
+};
+
+static void report(const char* name, const timings_t& t)
+{
+  printf("%-26s %9.2f %9.2f %9.2f %9.2f %9.2f\n", name, t.create, t.iterate,
+         t.erase, t.churn, t.destroy);
+}
+
+//! --------------------------------------------------------------------------
+//! -------------------------- CONTENDERS
+//! --------------------------------------------------------------------------
+
+// Every test: create n, step them all, destroy every other one, create n/2
+// again, step them all, then destroy everything
+
+static timings_t with_list(size_t n)
+{
+  timings_t t;
+  list<object_t*> objects;
+
+  double start = now();
+  for(size_t i = 0; i < n; i++)
+    objects.push_back(new object_t(i));
+  t.create = now() - start;
+
+  start = now();
+  for(auto i = objects.begin(); i != objects.end(); i++)
+    (*i)->step();
+  t.iterate = now() - start;
+
+  start = now();
+  bool odd = false;
+  for(auto i = objects.begin(); i != objects.end(); odd = !odd)
+    if(odd)
+    {
+      delete *i;
+      i = objects.erase(i);
+    }
+    else
+      i++;
+  t.erase = now() - start;
+
+  start = now();
+  for(size_t i = 0; i < n/2; i++)
+    objects.push_back(new object_t(i));
+  for(auto i = objects.begin(); i != objects.end(); i++)
+    (*i)->step();
+  t.churn = now() - start;
+
+  start = now();
+  for(auto i = objects.begin(); i != objects.end(); i++)
+    delete *i;
+  objects.clear();
+  t.destroy = now() - start;
+  return t;
+}
+
+static timings_t with_pool(size_t n)
+{
+  timings_t t;
+  Pool<object_t> pool;
+  vector<object_t*> objects;
+  objects.reserve(n);
+
+  double start = now();
+  for(size_t i = 0; i < n; i++)
+    objects.push_back(pool.create(i));
+  t.create = now() - start;
+
+  start = now();
+  for(size_t i = 0; i < objects.size(); i++)
+    objects[i]->step();
+  t.iterate = now() - start;
+
+  // Order doesn't matter: swap with the last one
+  start = now();
+  for(size_t i = 0; i < objects.size(); i++)
+  {
+    pool.destroy(objects[i]);
+    objects[i] = objects.back();
+    objects.pop_back();
+  }
+  t.erase = now() - start;
+
+  start = now();
+  for(size_t i = 0; i < n/2; i++)
+    objects.push_back(pool.create(i));
+  for(size_t i = 0; i < objects.size(); i++)
+    objects[i]->step();
+  t.churn = now() - start;
+
+  start = now();
+  for(size_t i = 0; i < objects.size(); i++)
+    pool.destroy(objects[i]);
+  objects.clear();
+  t.destroy = now() - start;
+  return t;
+}
+
+static timings_t with_slot_map(size_t n, size_t& stale)
+{
+  timings_t t;
+  SlotMap<object_t> objects;
+  vector<handle_t> handles;       // what the owners would keep
+  handles.reserve(n);
+
+  double start = now();
+  for(size_t i = 0; i < n; i++)
+    handles.push_back(objects.emplace(i));
+  t.create = now() - start;
+
+  start = now();
+  for(auto i = objects.begin(); i != objects.end(); i++)
+    i->step();
+  t.iterate = now() - start;
+
+  start = now();
+  for(size_t i = 1; i < n; i += 2)
+    objects.erase(handles[i]);
+  t.erase = now() - start;
+
+  start = now();
+  for(size_t i = 0; i < n/2; i++)
+    objects.emplace(i);
+  for(auto i = objects.begin(); i != objects.end(); i++)
+    i->step();
+  t.churn = now() - start;
+
+  // Handles to erased objects must not find the ones that replaced them
+  stale = 0;
+  for(size_t i = 1; i < n; i += 2)
+    if(!objects.get(handles[i]))
+      stale++;
+
+  start = now();
+  objects.clear();
+  t.destroy = now() - start;
+  return t;
+}
+
+//! --------------------------------------------------------------------------
+//! -------------------------- BENCHMARKS
+//! --------------------------------------------------------------------------
+
+int main(int argc, char *argv[])
+{
+  size_t n = (argc > 1) ? strtoul(argv[1], nullptr, 10) : 1000000;
+  printf("%llu objects of %llu bytes, times in ms\n", (unsigned long long)n,
+         (unsigned long long)sizeof(object_t));
+  printf("%-26s %9s %9s %9s %9s %9s\n", "", "create", "iterate", "erase",
+         "churn", "destroy");
+
+  // Twice each: the first run also pays for the pages the heap gets
+  size_t stale;
+  for(int run = 0; run < 2; run++)
+  {
+    report("new + std::list", with_list(n));
+    report("Pool + std::vector", with_pool(n));
+    report("SlotMap", with_slot_map(n, stale));
+  }
+  printf("%llu of %llu erased handle(s) detected as stale\n",
+         (unsigned long long)stale, (unsigned long long)(n/2));
+
+  return EXIT_SUCCESS;
+}
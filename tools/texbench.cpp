@@ -0,0 +1,249 @@
+//! --------------------------------------------------------------------------
+//! -------------------------- INCLUDES
+//! --------------------------------------------------------------------------
+
+#include <cstdlib>
+#include <cstdio>
+#include <cstring>
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include "SDL.h"
+#include "SDL_image.h"
+
+#include "../src/graphics/opengl.h"
+#include "../src/graphics/extensions.h"
+#include "../src/graphics/compressed.h"
+#include "../src/io/filesystem.h"
+#include "../src/math/wjd_math.h"
+
+using namespace std;
+
+// Benchmark for block-compressed textures: the same image saved hundreds of
+// times as a PNG and as a ".ctex", then every copy loaded and uploaded the
+// way Texture does it, IMG_Load then glTexImage2D against compressed::read
+// then glCompressedTexImage2D. Video memory is what each upload asks the
+// driver for (RGBA for the PNGs, as drivers store RGB).
+//
+//    texbench [textures] [image] [directory]
+
+//! --------------------------------------------------------------------------
+//! -------------------------- WORKSPACE
+//! --------------------------------------------------------------------------
+
+static vector<string> pngs, ctexs;
+static vector<GLuint> handles;
+
+static double now()
+{
+  return chrono::duration<double, milli>(
+    chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static void report(const char* name, size_t n, double ms,
+                   unsigned long long bytes)
+{
+  printf("%-32s %8.2f ms   %7.3f ms/texture   %8llu kB of VRAM\n", name, ms,
+         ms/n, bytes/1024);
+}
+
+// Both files for each copy, the .ctex encoded as texconv would
+static int create_files(size_t n, const char* source, const char* directory)
+{
+  if(filesystem::make_directory(directory) != EXIT_SUCCESS)
+    return EXIT_FAILURE;
+
+  SDL_Surface* loaded = IMG_Load(source);
+  if(!loaded)
+    return EXIT_FAILURE;
+  bool has_alpha = (loaded->format->Amask != 0);
+  SDL_Surface* surface = SDL_ConvertSurfaceFormat(loaded,
+                                                  SDL_PIXELFORMAT_RGBA32, 0);
+  SDL_FreeSurface(loaded);
+  if(!surface)
+    return EXIT_FAILURE;
+
+  int w = MAX(nextpwr2(surface->w), 4), h = MAX(nextpwr2(surface->h), 4);
+  vector<unsigned char> rgba(w*h*4, 0);
+  for(int y = 0; y < surface->h; y++)
+    memcpy(&rgba[y*w*4], (unsigned char*)surface->pixels + y*surface->pitch,
+           surface->w*4);
+  SDL_FreeSurface(surface);
+
+  compressed::image_t image;
+  if(compressed::encode(has_alpha ? compressed::BC3 : compressed::BC1,
+                        &rgba[0], w, h, image) != EXIT_SUCCESS)
+    return EXIT_FAILURE;
+
+  FILE* file = fopen(source, "rb");
+  if(!file)
+    return EXIT_FAILURE;
+  vector<unsigned char> png;
+  unsigned char buffer[4096];
+  size_t read;
+  while((read = fread(buffer, 1, sizeof(buffer), file)) > 0)
+    png.insert(png.end(), buffer, buffer + read);
+  fclose(file);
+
+  for(size_t i = 0; i < n; i++)
+  {
+    char name[32];
+    snprintf(name, sizeof(name), "/%06llu", (unsigned long long)i);
+    pngs.push_back(string(directory) + name + ".png");
+    ctexs.push_back(string(directory) + name + CTEX_EXTENSION);
+
+    file = fopen(pngs.back().c_str(), "wb");
+    if(!file)
+      return EXIT_FAILURE;
+    fwrite(&png[0], 1, png.size(), file);
+    fclose(file);
+    if(compressed::write(ctexs.back().c_str(), image) != EXIT_SUCCESS)
+      return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
+
+static GLuint create_texture()
+{
+  GLuint handle;
+  glGenTextures(1, &handle);
+  glBindTexture(GL_TEXTURE_2D, handle);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+  handles.push_back(handle);
+  return handle;
+}
+
+// Wait for the driver to really have everything, then start over
+static void finish()
+{
+  glFinish();
+  glBindTexture(GL_TEXTURE_2D, 0);
+  glDeleteTextures((GLsizei)handles.size(), &handles[0]);
+  handles.clear();
+  glFinish();
+}
+
+//! --------------------------------------------------------------------------
+//! -------------------------- BENCHMARKS
+//! --------------------------------------------------------------------------
+
+static unsigned long long load_pngs(size_t& failed)
+{
+  unsigned long long bytes = 0;
+  for(size_t i = 0; i < pngs.size(); i++)
+  {
+    SDL_Surface* loaded = IMG_Load(pngs[i].c_str());
+    SDL_Surface* surface = loaded ?
+      SDL_ConvertSurfaceFormat(loaded, SDL_PIXELFORMAT_RGBA32, 0) : nullptr;
+    if(loaded)
+      SDL_FreeSurface(loaded);
+    if(!surface)
+    {
+      failed++;
+      continue;
+    }
+
+    // Padded to powers of 2, like Texture::load
+    int w = nextpwr2(surface->w), h = nextpwr2(surface->h);
+    create_texture();
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, w, h, 0, GL_RGBA,
+                 GL_UNSIGNED_BYTE, nullptr);
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, surface->pitch/4);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, surface->w, surface->h, GL_RGBA,
+                    GL_UNSIGNED_BYTE, surface->pixels);
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+    bytes += (unsigned long long)w*h*4;
+    SDL_FreeSurface(surface);
+  }
+  return bytes;
+}
+
+static unsigned long long load_ctexs(size_t& failed)
+{
+  unsigned long long bytes = 0;
+  for(size_t i = 0; i < ctexs.size(); i++)
+  {
+    compressed::image_t image;
+    if(compressed::read(ctexs[i].c_str(), image) != EXIT_SUCCESS)
+    {
+      failed++;
+      continue;
+    }
+    GLenum format = (image.format == compressed::BC3)
+                    ? GL_COMPRESSED_RGBA_S3TC_DXT5_EXT
+                    : GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+    create_texture();
+    extensions::CompressedTexImage2D(GL_TEXTURE_2D, 0, format, image.w,
+                                     image.h, 0, image.data.size(),
+                                     &image.data[0]);
+    bytes += image.data.size();
+  }
+  return bytes;
+}
+
+int main(int argc, char *argv[])
+{
+  size_t n = (argc > 1) ? strtoul(argv[1], nullptr, 10) : 500;
+  const char* source = (argc > 2) ? argv[2] : "assets/eye_of_draining.png";
+  const char* directory = (argc > 3) ? argv[3] : "texbench.tmp";
+  printf("%llu copies of %s in %s\n", (unsigned long long)n, source,
+         directory);
+
+  // A hidden window, only for its context
+  SDL_Window* window = nullptr;
+  SDL_GLContext context = nullptr;
+  if(SDL_Init(SDL_INIT_VIDEO) != 0
+  || !(window = SDL_CreateWindow("texbench", 0, 0, 64, 64,
+                                 SDL_WINDOW_OPENGL|SDL_WINDOW_HIDDEN))
+  || !(context = SDL_GL_CreateContext(window))
+  || extensions::load() != EXIT_SUCCESS)
+  {
+    fprintf(stderr, "Could not create an OpenGL context: %s\n",
+            SDL_GetError());
+    return EXIT_FAILURE;
+  }
+  if(!extensions::s3tc)
+  {
+    fprintf(stderr, "This driver can't take BC1/BC3 textures\n");
+    return EXIT_FAILURE;
+  }
+
+  if(create_files(n, source, directory) != EXIT_SUCCESS)
+  {
+    fprintf(stderr, "Could not create the files (run from the root)\n");
+    return EXIT_FAILURE;
+  }
+
+  // Once each beforehand, so both start from a warm page cache
+  size_t failed = 0;
+  load_pngs(failed);
+  load_ctexs(failed);
+  finish();
+
+  double start = now();
+  unsigned long long bytes = load_pngs(failed);
+  finish();
+  report("IMG_Load + glTexImage2D", n, now() - start, bytes);
+
+  start = now();
+  bytes = load_ctexs(failed);
+  finish();
+  report(".ctex + glCompressedTexImage2D", n, now() - start, bytes);
+
+  for(size_t i = 0; i < n; i++)
+  {
+    remove(pngs[i].c_str());
+    remove(ctexs[i].c_str());
+  }
+  remove(directory);
+
+  SDL_GL_DeleteContext(context);
+  SDL_DestroyWindow(window);
+  SDL_Quit();
+
+  if(failed)
+    printf("ERROR: %llu texture(s) failed\n", (unsigned long long)failed);
+  return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
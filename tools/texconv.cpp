@@ -0,0 +1,118 @@
+//! --------------------------------------------------------------------------
+//! -------------------------- INCLUDES
+//! --------------------------------------------------------------------------
+
+#include <cstdlib>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "SDL.h"
+#include "SDL_image.h"
+
+#include "../src/graphics/compressed.h"
+#include "../src/math/wjd_math.h"
+
+using namespace std;
+
+// Offline converter: PNG (or anything SDL_image reads) to ".ctex".
+//
+//    texconv [-f bc1|bc3|etc1] input.png [more.png ...]
+//
+// Each output is written next to its input with the extension replaced.
+// Without -f, images with an alpha channel become BC3 and others BC1.
+
+//! --------------------------------------------------------------------------
+//! -------------------------- CONVERSION
+//! --------------------------------------------------------------------------
+
+static int convert(const char* input, int forced_format)
+{
+  SDL_Surface* loaded = IMG_Load(input);
+  if(!loaded)
+  {
+    fprintf(stderr, "%s: %s\n", input, SDL_GetError());
+    return EXIT_FAILURE;
+  }
+  bool has_alpha = (loaded->format->Amask != 0);
+
+  // Get a tightly-packed RGBA copy whatever the source format
+  SDL_Surface* surface = SDL_ConvertSurfaceFormat(loaded,
+                                                  SDL_PIXELFORMAT_RGBA32, 0);
+  SDL_FreeSurface(loaded);
+  if(!surface)
+  {
+    fprintf(stderr, "%s: %s\n", input, SDL_GetError());
+    return EXIT_FAILURE;
+  }
+
+  // Pad to powers of 2 (at least one block) exactly like Texture does
+  int w = MAX(nextpwr2(surface->w), 4), h = MAX(nextpwr2(surface->h), 4);
+  vector<unsigned char> rgba(w*h*4, 0);
+  SDL_LockSurface(surface);
+  for(int y = 0; y < surface->h; y++)
+    memcpy(&rgba[y*w*4], (unsigned char*)surface->pixels + y*surface->pitch,
+           surface->w*4);
+  SDL_UnlockSurface(surface);
+  SDL_FreeSurface(surface);
+
+  compressed::format_t format = forced_format ?
+    (compressed::format_t)forced_format :
+    (has_alpha ? compressed::BC3 : compressed::BC1);
+  compressed::image_t image;
+  compressed::encode(format, &rgba[0], w, h, image);
+
+  string output(input);
+  size_t dot = output.find_last_of('.');
+  if(dot != string::npos && output.find_first_of("/\\", dot) == string::npos)
+    output.erase(dot);
+  output += CTEX_EXTENSION;
+
+  if(compressed::write(output.c_str(), image) != EXIT_SUCCESS)
+  {
+    fprintf(stderr, "%s: could not write\n", output.c_str());
+    return EXIT_FAILURE;
+  }
+
+  printf("%s -> %s (%dx%d, %d kB instead of %d kB)\n", input, output.c_str(),
+         w, h, (int)image.data.size()/1024, w*h*4/1024);
+  return EXIT_SUCCESS;
+}
+
+//! --------------------------------------------------------------------------
+//! -------------------------- STARTUP
+//! --------------------------------------------------------------------------
+
+int main(int argc, char *argv[])
+{
+  int format = 0, failures = 0, first = 1;
+
+  if(argc > 2 && !strcmp(argv[1], "-f"))
+  {
+    if(!strcmp(argv[2], "bc1"))
+      format = compressed::BC1;
+    else if(!strcmp(argv[2], "bc3"))
+      format = compressed::BC3;
+    else if(!strcmp(argv[2], "etc1"))
+      format = compressed::ETC1;
+    else
+    {
+      fprintf(stderr, "Unknown format '%s'\n", argv[2]);
+      return EXIT_FAILURE;
+    }
+    first = 3;
+  }
+
+  if(first >= argc)
+  {
+    fprintf(stderr, "Usage: %s [-f bc1|bc3|etc1] input.png ...\n", argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  for(int i = first; i < argc; i++)
+    if(convert(argv[i], format) != EXIT_SUCCESS)
+      failures++;
+
+  return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}